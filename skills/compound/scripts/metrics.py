@@ -1,12 +1,12 @@
 import sqlite3
-import pandas as pd
-import numpy as np
 
 class PerformanceTracker:
     def __init__(self, db_path="data/trading_history.db"):
         self.db_path = db_path
         
     def get_raw_trades(self):
+        # pandas/numpy are only needed for reporting; keep them off the daemon's import path
+        import pandas as pd
         try:
             with sqlite3.connect(self.db_path) as conn:
                 df = pd.read_sql_query("SELECT * FROM trades", conn)
@@ -21,6 +21,7 @@ class PerformanceTracker:
         markets resolved to 1 (YES) or 0 (NO), and attach it to the dataframe 
         as `resolution_value`.
         """
+        import numpy as np
         df = self.get_raw_trades()
         if df.empty:
             return "No trades logged yet. Let the bot run forward in paper-mode first!"
@@ -1,15 +1,11 @@
 import os
 import json
 import asyncio
-from groq import Groq
 from src.utils import logger
+from src.startup import lazy_component
 
 class PredictorAgent:
     def __init__(self):
-        # We will simulate an ensemble by calling multiple different models on Groq
-        # as a stand-in for OpenAI/Anthropic/Deepseek due to key availability
-        self.client = Groq(api_key=os.getenv("GROQ_API_KEY"))
-        
         # We'll use an ensemble of smaller models and roles to create a Mixture of Experts
         self.ensemble = [
             {
@@ -44,6 +40,13 @@ class PredictorAgent:
             }
         ]
 
+    @lazy_component
+    def client(self):
+        # We will simulate an ensemble by calling multiple different models on Groq
+        # as a stand-in for OpenAI/Anthropic/Deepseek due to key availability
+        from groq import Groq
+        return Groq(api_key=os.getenv("GROQ_API_KEY"))
+
     async def _predict_single(self, agent_config, market_title, current_price, research_json):
         """Fetches a prediction from a single agent based on their specific role."""
         model_name = agent_config["model"]
@@ -71,9 +74,10 @@ class PredictorAgent:
         """
         
         try:
-            # We use synchronous calls here wrapped in to_thread, or run them sequentially 
-            # for the sake of simplicity in this script. Groq is fast.
-            response = self.client.chat.completions.create(
+            # The Groq SDK call is synchronous; run it off the loop so the ensemble is
+            # actually concurrent and the task stays cancellable by the kill switch.
+            response = await asyncio.to_thread(
+                self.client.chat.completions.create,
                 model=model_name,
                 max_tokens=500,
                 response_format={"type": "json_object"},
@@ -89,12 +93,12 @@ class PredictorAgent:
             elif "```" in text:
                 text = text.split("```\n")[1].split("\n```")[0]
                 
-            return json.loads(text)
+            parsed = json.loads(text)
         except Exception as e:
             logger.error(f"[{role} - {model_name}] Prediction failed: {e}")
             return {"p_model": current_price, "reasoning": "Failed to predict.", "weight": agent_config["weight"], "role": role}
             
-        return {"p_model": json.loads(text).get("p_model", current_price), "weight": agent_config["weight"], "role": role}
+        return {"p_model": parsed.get("p_model", current_price), "reasoning": parsed.get("reasoning", ""), "weight": agent_config["weight"], "role": role}
 
     async def evaluate_edge(self, market_title, current_price, research_json):
         """Runs the ensemble evaluation to calculate the edge."""
@@ -107,6 +111,7 @@ class PredictorAgent:
         # Calculate Weighted Consensus
         weighted_sum = 0.0
         total_weight_used = 0.0
+        valid_probs = []
         
         for res in results:
             p_model = res.get("p_model")
@@ -115,6 +120,7 @@ class PredictorAgent:
             if isinstance(p_model, (int, float)):
                 weighted_sum += p_model * weight
                 total_weight_used += weight
+                valid_probs.append(p_model)
                 
         if total_weight_used == 0:
             consensus_p = current_price
@@ -1,6 +1,7 @@
 import unittest
 from kelly_size import calculate_kelly
 from validate_risk import RiskValidator
+from src.execution.fill_model import FillEstimator
 
 class TestKellySize(unittest.TestCase):
     def test_basic_kelly(self):
@@ -89,5 +90,42 @@ class TestRiskValidator(unittest.TestCase):
         self.assertIn("API cost", msg)
         self.assertEqual(sz, 0.0)
 
+    def test_locked_arbitrage_takes_a_capped_slot(self):
+        # No edge or Kelly for a locked payout: the single-position cap is the size
+        self.assertEqual(self.validator.validate_locked(10000, 0.0, 0.0, 0, 0.0), (True, "APPROVED", 500.0))
+        self.assertEqual(self.validator.validate_locked(2000, 0.10, 0.05, 14, 49.0)[2], 100.0)
+
+    def test_locked_arbitrage_still_obeys_portfolio_limits(self):
+        for args, reason in [((0.15, 0.0, 0, 0.0), "Daily loss"), ((0.0, 0.08, 0, 0.0), "drawdown"),
+                             ((0.0, 0.0, 15, 0.0), "positions"), ((0.0, 0.0, 0, 50.0), "API spend")]:
+            status, msg, sz = self.validator.validate_locked(10000, *args)
+            self.assertFalse(status)
+            self.assertIn(reason, msg)
+            self.assertEqual(sz, 0.0)
+
+    def test_var_must_fit_inside_the_daily_loss_limit(self):
+        self.assertEqual(self.validator.validate_var(1500.0, 10000), (True, "APPROVED"))
+        status, msg = self.validator.validate_var(1500.01, 10000)
+        self.assertFalse(status)
+        self.assertIn("$1500.00", msg)
+        # The limit scales with the bankroll the caller passes in
+        self.assertFalse(self.validator.validate_var(800.0, 5000)[0])
+
+    def test_fill_shrinks_to_the_book_within_slippage(self):
+        book = {"bids": [(0.49, 100)], "asks": [(0.50, 80), (0.51, 200), (0.52, 400)]}
+        # 0.52 is past the 2% slippage bound: only the first two levels count
+        status, msg, sz = self.validator.validate_fill(0.60, 0.50, 500.0, book, FillEstimator())
+        self.assertTrue(status)
+        self.assertIn("slippage 1.43%", msg)
+        self.assertAlmostEqual(sz, 80 * 0.50 + 200 * 0.51)
+        self.assertAlmostEqual(self.validator.validate_fill(0.60, 0.50, 20.0, book, FillEstimator())[2], 20.0)
+        self.assertFalse(self.validator.validate_fill(0.60, 0.50, 500.0, {"bids": [], "asks": []}, FillEstimator())[0])
+
+    def test_inventory_caps_scale_with_the_bankroll(self):
+        self.assertEqual(self.validator.inventory_limits(10000), (500.0, 2000.0))
+        self.assertEqual(self.validator.inventory_limits(2500), (125.0, 500.0))
+        self.assertEqual(self.validator.inventory_limits(0), (0.0, 0.0))
+        self.assertEqual(self.validator.inventory_limits(-50), (0.0, 0.0))
+
 if __name__ == '__main__':
     unittest.main()
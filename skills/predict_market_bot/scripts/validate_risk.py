@@ -9,6 +9,9 @@ class RiskValidator:
         self.MAX_DAILY_LOSS_PCT = 0.15
         self.MAX_DRAWDOWN_PCT = 0.08
         self.MAX_API_SPEND_DAY = 50.0
+        self.VAR_CONFIDENCE = 0.95     # 95% VaR must stay within the daily loss limit
+        self.MAX_SLIPPAGE = 0.02       # Abort if slippage > 2%
+        self.MAX_MM_INVENTORY_PCT = 0.20  # Market making: net inventory across all quoted markets
 
     def validate(self, p_model: float, p_market: float, bankroll: float,
                  current_daily_loss_pct: float, current_drawdown_pct: float,
@@ -24,21 +27,10 @@ class RiskValidator:
         if edge < self.MIN_EDGE:
             return False, f"Edge ({edge:.4f}) is below minimum {self.MIN_EDGE}", 0.0
         
-        # 2. Daily Loss Filter
-        if current_daily_loss_pct >= self.MAX_DAILY_LOSS_PCT:
-            return False, f"Daily loss limit reached ({current_daily_loss_pct:.2%})", 0.0
-            
-        # 3. Absolute Drawdown Filter
-        if current_drawdown_pct >= self.MAX_DRAWDOWN_PCT:
-            return False, f"Maximum drawdown limit reached ({current_drawdown_pct:.2%})", 0.0
-            
-        # 4. Concurrency Filter
-        if concurrent_positions >= self.MAX_CONCURRENT_POS: # Using existing constant name
-            return False, f"Max limit of {self.MAX_CONCURRENT_POS} positions reached", 0.0
-            
-        # 5. API Spend Filter
-        if daily_api_spend >= self.MAX_API_SPEND_DAY: # Using existing constant name
-            return False, f"Daily API spend limit reached (${daily_api_spend:.2f})", 0.0
+        # 2-5. Daily loss, drawdown, concurrency and API spend
+        breach = self._portfolio_limits(current_daily_loss_pct, current_drawdown_pct, concurrent_positions, daily_api_spend)
+        if breach:
+            return False, breach, 0.0
             
         # 6. Concentration Filter (Bulletproof Update)
         if category_exposure_pct >= 0.15:
@@ -56,6 +48,77 @@ class RiskValidator:
 
         return True, "APPROVED", final_size
 
+    def _portfolio_limits(self, current_daily_loss_pct, current_drawdown_pct, concurrent_positions, daily_api_spend):
+        """The reason the first portfolio-wide limit is breached, or None."""
+        # 2. Daily Loss Filter
+        if current_daily_loss_pct >= self.MAX_DAILY_LOSS_PCT:
+            return f"Daily loss limit reached ({current_daily_loss_pct:.2%})"
+        # 3. Absolute Drawdown Filter
+        if current_drawdown_pct >= self.MAX_DRAWDOWN_PCT:
+            return f"Maximum drawdown limit reached ({current_drawdown_pct:.2%})"
+        # 4. Concurrency Filter
+        if concurrent_positions >= self.MAX_CONCURRENT_POS: # Using existing constant name
+            return f"Max limit of {self.MAX_CONCURRENT_POS} positions reached"
+        # 5. API Spend Filter
+        if daily_api_spend >= self.MAX_API_SPEND_DAY: # Using existing constant name
+            return f"Daily API spend limit reached (${daily_api_spend:.2f})"
+        return None
+
+    def validate_locked(self, bankroll: float, current_daily_loss_pct: float, current_drawdown_pct: float,
+                        concurrent_positions: int, daily_api_spend: float) -> tuple[bool, str, float]:
+        """
+        Arbitrage Check: a set with a locked payout has no model edge to filter or
+        Kelly-size, but it still takes a position slot under the portfolio limits.
+        Returns:
+            (is_allowed: bool, reason: str, position_size_usd: float)
+        """
+        breach = self._portfolio_limits(current_daily_loss_pct, current_drawdown_pct, concurrent_positions, daily_api_spend)
+        if breach:
+            return False, breach, 0.0
+        return True, "APPROVED", bankroll * self.MAX_POS_PCT
+
+    def validate_var(self, portfolio_var_usd: float, bankroll: float) -> tuple[bool, str]:
+        """
+        VaR Check: portfolio Value at Risk (including the proposed trade) must fit
+        inside the daily loss limit. The VaR itself is simulated by the caller.
+        """
+        limit = bankroll * self.MAX_DAILY_LOSS_PCT
+        if portfolio_var_usd > limit:
+            return False, f"{self.VAR_CONFIDENCE:.0%} VaR (${portfolio_var_usd:.2f}) exceeds daily loss limit (${limit:.2f})"
+        return True, "APPROVED"
+
+    def validate_fill(self, p_model: float, p_market: float, size_usd: float, book: dict, estimator,
+                      market_id: str = None) -> tuple[bool, str, float]:
+        """
+        Liquidity Check: shrinks an approved position to what the order book can
+        absorb within the slippage limit and without paying away the minimum edge,
+        then prices it with the fill estimator (src.execution.fill_model).
+        Returns:
+            (is_allowed: bool, reason: str, position_size_usd: float)
+        """
+        _, cap_usd = estimator.max_size(book, reference=p_market, max_slippage=self.MAX_SLIPPAGE,
+                                        worst_price=p_model - self.MIN_EDGE)
+        if cap_usd <= 0:
+            return False, f"No liquidity within {self.MAX_SLIPPAGE:.0%} slippage at an edge of {self.MIN_EDGE}", 0.0
+        size_usd = min(size_usd, cap_usd)
+        est = estimator.estimate(book, estimator.contracts_for(book, size_usd), reference=p_market, market_id=market_id)
+        if est.limit_slippage > self.MAX_SLIPPAGE + 1e-9:
+            return False, f"Expected slippage {est.limit_slippage:.2%} exceeds {self.MAX_SLIPPAGE:.0%}", 0.0
+        if est.vwap is None or p_model - est.vwap < self.MIN_EDGE:
+            return False, f"Edge at the expected fill price is below minimum {self.MIN_EDGE}", 0.0
+        return True, f"APPROVED (expected VWAP {est.vwap:.4f}, slippage {est.slippage:.2%})", est.expected_fill * est.vwap
+
+    def inventory_limits(self, bankroll: float) -> tuple[float, float]:
+        """
+        Market-Making Limits: net inventory (USD at fair value) allowed in one
+        market, which is the single-position cap, and across all quoted markets.
+        Returns:
+            (per_market_usd: float, total_usd: float)
+        """
+        if bankroll <= 0:
+            return 0.0, 0.0
+        return bankroll * self.MAX_POS_PCT, bankroll * self.MAX_MM_INVENTORY_PCT
+
 if __name__ == "__main__":
     validator = RiskValidator()
     # Mock pass
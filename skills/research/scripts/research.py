@@ -1,13 +1,17 @@
 import os
 import json
-from groq import Groq
 from src.utils import logger
+from src.startup import lazy_component
 
 class ResearcherAgent:
     def __init__(self):
-        self.client = Groq(api_key=os.getenv("GROQ_API_KEY"))
         self.model = "llama-3.1-8b-instant"
 
+    @lazy_component
+    def client(self):
+        from groq import Groq
+        return Groq(api_key=os.getenv("GROQ_API_KEY"))
+
     def analyze(self, market_title, news_data, twitter_data):
         logger.info(f"Starting NLP Research on: {market_title}")
         
@@ -1,5 +1,4 @@
 import urllib.parse
-import feedparser
 from src.utils import logger
 
 class NewsScraper:
@@ -14,6 +13,7 @@ class NewsScraper:
         logger.info(f"Fetching news for: {search_term}")
         
         try:
+            import feedparser
             feed = feedparser.parse(url)
             results = []
             
@@ -6,12 +6,19 @@ class MarketAggregator:
         self.kalshi = KalshiClient()
         self.poly = PolymarketClient()
         
-    def fetch_all_markets(self):
+    def fetch_all_markets(self, market_filter=None):
         """Fetch active markets from all supported platforms."""
-        kalshi_markets = self.kalshi.get_markets()
-        poly_markets = self.poly.get_markets()
+        kalshi_markets = self.kalshi.get_markets(market_filter=market_filter)
+        poly_markets = self.poly.get_markets(market_filter=market_filter)
         
         return {
             "kalshi": kalshi_markets,
             "polymarket": poly_markets
         }
+
+    def reset_stats(self):
+        self.kalshi.stats.reset()
+        self.poly.stats.reset()
+
+    def transfer_report(self):
+        return f"Kalshi: {self.kalshi.stats} | Polymarket: {self.poly.stats}"
@@ -0,0 +1,199 @@
+import json
+from typing import List, Optional, Union
+
+try:
+    import msgspec
+except ImportError:  # Plain json fallback: same results, full-size intermediate dicts
+    msgspec = None
+
+try:
+    import brotli  # noqa: F401  (urllib3 decodes br transparently when this is importable)
+    ACCEPT_ENCODING = "br, gzip"
+except ImportError:
+    ACCEPT_ENCODING = "gzip"
+
+# Only the fields the normalizers read. Everything else in the payload (descriptions,
+# images, tags, rewards config...) is skipped by the decoder instead of materialized.
+KALSHI_MARKET_FIELDS = ("ticker", "title", "volume", "close_time", "yes_ask", "yes_bid",
+                        "event_ticker", "strike_type", "floor_strike", "cap_strike")
+GAMMA_EVENT_FIELDS = ("id", "title", "volume", "endDate", "negRisk", "negRiskAugmented", "markets")
+GAMMA_MARKET_FIELDS = ("id", "question", "groupItemTitle", "outcomes", "outcomePrices", "clobTokenIds",
+                       "bestBid", "bestAsk", "volume", "endDate", "negRisk", "active", "closed")
+
+if msgspec:
+    class _Row(msgspec.Struct, gc=False):
+        """Typed row that still answers dict-style .get() so normalizers work on either representation."""
+        def get(self, key, default=None):
+            value = getattr(self, key, None)
+            return default if value is None else value
+
+    # Every field is optional: the venues send null for missing titles, volumes and flags,
+    # and one null must not fail the page. .get() maps None back to the caller's default.
+    class KalshiMarket(_Row):
+        ticker: Optional[str] = None
+        title: Optional[str] = None
+        volume: Optional[float] = None
+        close_time: Optional[str] = None
+        yes_ask: Optional[float] = None
+        yes_bid: Optional[float] = None
+        # Strike ladder structure ("greater" / "less" / "between" + bounds)
+        event_ticker: Optional[str] = None
+        strike_type: Optional[str] = None
+        floor_strike: Optional[float] = None
+        cap_strike: Optional[float] = None
+
+    class KalshiMarketsPage(msgspec.Struct, gc=False):
+        markets: Optional[List[KalshiMarket]] = None
+        cursor: Optional[str] = None
+
+    class _RawKalshiMarketsPage(msgspec.Struct, gc=False):
+        markets: Optional[List[msgspec.Raw]] = None
+        cursor: Optional[str] = None
+
+    class GammaMarket(_Row):
+        id: Optional[str] = None
+        question: Optional[str] = None
+        groupItemTitle: Optional[str] = None
+        # JSON-encoded arrays on the wire; OutcomeTable parses them in bulk
+        outcomes: Union[str, List[str], None] = None
+        outcomePrices: Union[str, List[str], None] = None
+        clobTokenIds: Union[str, List[str], None] = None
+        bestBid: Optional[float] = None
+        bestAsk: Optional[float] = None
+        volume: Optional[float] = None
+        endDate: Optional[str] = None
+        negRisk: Optional[bool] = None
+        # Member status, for baskets that must hold every live outcome
+        active: Optional[bool] = None
+        closed: Optional[bool] = None
+
+    class GammaEvent(_Row):
+        id: Optional[str] = None
+        title: Optional[str] = None
+        volume: Optional[float] = None
+        endDate: Optional[str] = None
+        negRisk: Optional[bool] = None
+        # Augmented negRisk events can still add outcomes ("Other" and placeholder members)
+        negRiskAugmented: Optional[bool] = None
+        markets: Optional[List[GammaMarket]] = None
+
+    # strict=False lets Gamma's stringly-typed numbers ("1234.5") coerce into float fields
+    _kalshi_decoder = msgspec.json.Decoder(KalshiMarketsPage, strict=False)
+    _gamma_decoder = msgspec.json.Decoder(List[GammaEvent], strict=False)
+    # Slow path for a page that fails as a whole: rows stay Raw and are decoded one by one,
+    # so a malformed row is dropped on its own
+    _kalshi_raw_decoder = msgspec.json.Decoder(_RawKalshiMarketsPage)
+    _kalshi_market_decoder = msgspec.json.Decoder(KalshiMarket, strict=False)
+    _gamma_raw_decoder = msgspec.json.Decoder(List[msgspec.Raw])
+    _gamma_event_decoder = msgspec.json.Decoder(GammaEvent, strict=False)
+
+    def _decode_rows(decoder, raws):
+        rows = []
+        for raw in raws or ():
+            try:
+                rows.append(decoder.decode(raw))
+            except msgspec.ValidationError:
+                continue
+        return rows
+
+    def _decode_gamma_event(raw):
+        """One event; if a market inside it is malformed, only that market is dropped."""
+        try:
+            return _gamma_event_decoder.decode(raw)
+        except msgspec.ValidationError:
+            pass
+        try:
+            obj = msgspec.json.decode(raw)
+        except msgspec.DecodeError:
+            return None
+        if not isinstance(obj, dict):
+            return None
+        markets = obj.pop("markets", None)
+        try:
+            event = msgspec.convert(obj, GammaEvent, strict=False)
+        except msgspec.ValidationError:
+            return None
+        event.markets = []
+        for m in markets if isinstance(markets, list) else ():
+            try:
+                event.markets.append(msgspec.convert(m, GammaMarket, strict=False))
+            except msgspec.ValidationError:
+                continue
+        return event
+
+def _project(obj, fields):
+    # Nulls are dropped so .get(key, default) behaves as it does on the typed rows
+    return {k: obj[k] for k in fields if obj.get(k) is not None}
+
+def decode_kalshi_markets(content):
+    """Decodes a Kalshi GET /markets body. Returns (markets, cursor); rows that fail to decode are skipped."""
+    if msgspec:
+        try:
+            page = _kalshi_decoder.decode(content)
+            return page.markets or [], page.cursor
+        except msgspec.ValidationError:
+            page = _kalshi_raw_decoder.decode(content)
+            return _decode_rows(_kalshi_market_decoder, page.markets), page.cursor
+    data = json.loads(content)
+    return [_project(m, KALSHI_MARKET_FIELDS) for m in data.get("markets") or [] if isinstance(m, dict)], data.get("cursor")
+
+def decode_gamma_events(content):
+    """Decodes a Gamma GET /events body into events carrying only normalizer fields; bad rows are skipped."""
+    if msgspec:
+        try:
+            return _gamma_decoder.decode(content)
+        except msgspec.ValidationError:
+            events = (_decode_gamma_event(raw) for raw in _gamma_raw_decoder.decode(content))
+            return [e for e in events if e is not None]
+    events = []
+    for e in json.loads(content):
+        if not isinstance(e, dict):
+            continue
+        row = _project(e, GAMMA_EVENT_FIELDS)
+        row["markets"] = [_project(m, GAMMA_MARKET_FIELDS) for m in e.get("markets") or [] if isinstance(m, dict)]
+        events.append(row)
+    return events
+
+def to_builtins(obj):
+    """JSON-safe form of a decoded row (used when snapshots are checkpointed)."""
+    if msgspec and isinstance(obj, msgspec.Struct):
+        return msgspec.to_builtins(obj)
+    return obj
+
+if __name__ == "__main__":
+    # Peak memory and decode time per Gamma page: resp.json() vs. the typed decoder.
+    import time
+    import random
+    import tracemalloc
+
+    def synthetic_page(n_events=500, n_markets=20):
+        rnd = random.Random(7)
+        def market(i):
+            return {
+                "id": str(i), "question": f"Will outcome {i} happen?" * 3, "conditionId": "0x" + "ab" * 32,
+                "slug": f"outcome-{i}", "description": "Resolution rules. " * 40, "image": "https://x/y.png",
+                "outcomes": '["Yes", "No"]', "outcomePrices": f'["{rnd.random():.3f}", "{rnd.random():.3f}"]',
+                "volume": f"{rnd.uniform(0, 1e6):.2f}", "clobTokenIds": '["%d", "%d"]' % (rnd.getrandbits(64), rnd.getrandbits(64)),
+                "rewardsMinSize": 50, "rewardsMaxSpread": 3.5, "tags": [{"id": "1", "label": "Politics"}],
+            }
+        return json.dumps([{
+            "id": str(e), "title": f"Event {e}", "volume": rnd.uniform(0, 1e7), "endDate": "2026-12-31T00:00:00Z",
+            "description": "Event rules. " * 60, "markets": [market(e * 100 + m) for m in range(n_markets)],
+            "tags": [{"id": "2", "label": "Elections"}], "series": [{"id": "3", "title": "Series"}],
+        } for e in range(n_events)]).encode()
+
+    body = synthetic_page()
+    print(f"page size: {len(body) / 1e6:.1f} MB")
+
+    def measure(label, fn):
+        tracemalloc.start()
+        start = time.perf_counter()
+        result = fn(body)
+        elapsed = time.perf_counter() - start
+        _, peak = tracemalloc.get_traced_memory()
+        tracemalloc.stop()
+        print(f"{label:<14} {elapsed * 1000:8.1f} ms   peak {peak / 1e6:7.1f} MB   events {len(result)}")
+        return result
+
+    measure("json.loads", json.loads)
+    measure("typed decode", decode_gamma_events)
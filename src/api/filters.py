@@ -0,0 +1,78 @@
+from dataclasses import dataclass
+from datetime import datetime
+from typing import Optional
+
+@dataclass
+class MarketFilter:
+    """
+    Venue-neutral description of the markets a sweep wants. Each client pushes the
+    predicates its API can evaluate into query parameters; `matches` re-applies the
+    full predicate locally so whatever a venue can't filter is still enforced.
+    """
+    status: str = "open"
+    min_close: Optional[datetime] = None
+    max_close: Optional[datetime] = None
+    min_volume: Optional[float] = None
+    event_ticker: Optional[str] = None     # Kalshi only
+    series_ticker: Optional[str] = None    # Kalshi only
+    page_size: int = 100
+    max_pages: int = 5
+
+    def kalshi_params(self):
+        # GET /markets supports status, close-time bounds and event/series tickers, but not volume
+        params = {"limit": self.page_size, "status": self.status}
+        if self.min_close:
+            params["min_close_ts"] = int(self.min_close.timestamp())
+        if self.max_close:
+            params["max_close_ts"] = int(self.max_close.timestamp())
+        if self.event_ticker:
+            params["event_ticker"] = self.event_ticker
+        if self.series_ticker:
+            params["series_ticker"] = self.series_ticker
+        return params
+
+    def gamma_params(self):
+        # Gamma /events supports end-date bounds and an event-level volume floor
+        params = {
+            "active": "true" if self.status == "open" else "false",
+            "closed": "false" if self.status == "open" else "true",
+            "limit": self.page_size,
+        }
+        if self.min_close:
+            params["end_date_min"] = self.min_close.isoformat()
+        if self.max_close:
+            params["end_date_max"] = self.max_close.isoformat()
+        if self.min_volume is not None:
+            params["volume_min"] = self.min_volume
+        return params
+
+    def matches(self, market):
+        """Local predicate over a normalized market row."""
+        if self.min_volume is not None and market["volume"] < self.min_volume:
+            return False
+        close = market.get("close_date")
+        if (self.min_close or self.max_close) and not close:
+            return False
+        if self.min_close and close < self.min_close:
+            return False
+        if self.max_close and close > self.max_close:
+            return False
+        return True
+
+@dataclass
+class TransferStats:
+    """Per-sweep network accounting for one venue client."""
+    pages: int = 0
+    wire_bytes: int = 0       # As sent by the server (compressed if it honoured Accept-Encoding)
+    decoded_bytes: int = 0    # After content decoding
+
+    def record(self, resp):
+        self.pages += 1
+        self.decoded_bytes += len(resp.content)
+        self.wire_bytes += int(resp.headers.get("Content-Length") or len(resp.content))
+
+    def reset(self):
+        self.pages = self.wire_bytes = self.decoded_bytes = 0
+
+    def __str__(self):
+        return f"{self.pages} page(s), {self.wire_bytes / 1024:.1f} KiB on the wire, {self.decoded_bytes / 1024:.1f} KiB decoded"
@@ -1,71 +1,289 @@
 import os
 import time
 import requests
-import base64
-from cryptography.hazmat.primitives import hashes
-from cryptography.hazmat.primitives.asymmetric import padding
-from cryptography.hazmat.primitives import serialization
+from urllib.parse import urlparse
 from src.utils import logger
+from src.startup import lazy_component
+from src.api.filters import MarketFilter, TransferStats
+from src.api.decoding import ACCEPT_ENCODING, decode_kalshi_markets
+from src.api.ratelimit import rate_limiter, CANCEL, ORDER, DISCOVERY
 
 class KalshiClient:
     def __init__(self):
         # Demo API as specified in PRD for Week 1
-        self.base_url = "https://api.elections.kalshi.com/trade-api/v2"
+        self.base_url = os.getenv("KALSHI_BASE_URL", "https://api.elections.kalshi.com/trade-api/v2")
         self.key_id = os.getenv("KALSHI_API_KEY_ID")
         self.key_path = os.getenv("KALSHI_PRIVATE_KEY_PATH", "kalshi-key.pem")
         self.key_raw = os.getenv("KALSHI_PRIVATE_KEY_RAW")
-        
+        self.stats = TransferStats()
+        self.BATCH_LIMIT = 20     # Orders per batched create/cancel request
+        self.limiter = rate_limiter
+        self.MAX_RETRIES = 2      # Re-sends after a 429, once the limiter lets us
+
+    @lazy_component
+    def private_key(self):
+        # Parsed on first signed request: cryptography import + PEM parse is the bulk of client start-up
+        from cryptography.hazmat.primitives import serialization
         try:
             if self.key_raw:
                 # Direct string injection via Cloud Environment Variable (easier than Secret Files)
                 # Replace explicit "\n" strings with actual newlines if configured that way in .env
                 raw_key_bytes = self.key_raw.replace("\\n", "\n").encode('utf-8')
-                self.private_key = serialization.load_pem_private_key(
+                return serialization.load_pem_private_key(
                     raw_key_bytes,
                     password=None,
                 )
             else:
                 # Fallback to local file lookup
                 with open(self.key_path, "rb") as key_file:
-                    self.private_key = serialization.load_pem_private_key(
+                    return serialization.load_pem_private_key(
                         key_file.read(),
                         password=None,
                     )
         except Exception as e:
             logger.error(f"Failed to load Kalshi RSA key: {e}")
-            self.private_key = None
+            return None
             
+    @lazy_component
+    def signer(self):
+        # Key parsed once; the hash/padding objects and per-path message prefixes are reused
+        from src.api.signing import KalshiSigner
+        return KalshiSigner(self.key_id, self.private_key) if self.key_id and self.private_key else None
+
     def _generate_signature(self, method, path):
-        if not self.private_key or not self.key_id:
-            return {}
-            
-        timestamp = str(int(time.time() * 1000))
-        msg_string = timestamp + method + path
-        msg_bytes = msg_string.encode('utf-8')
-        
-        signature = self.private_key.sign(
-            msg_bytes,
-            padding.PKCS1v15(),
-            hashes.SHA256()
-        )
-        signature_b64 = base64.b64encode(signature).decode('utf-8')
-        
-        return {
-            "KALSHI-ACCESS-KEY": self.key_id,
-            "KALSHI-ACCESS-SIGNATURE": signature_b64,
-            "KALSHI-ACCESS-TIMESTAMP": timestamp
-        }
+        return self.signer.sign(method, path) if self.signer else {}
+
+    def _send(self, method, url, priority, cost=1.0, signed_path=None, headers=None, **kwargs):
+        """
+        Rate-limited request (reads and writes are separate Kalshi quotas), retrying 429s.
+        Signed after the limiter wait, so the timestamp is fresh.
+        """
+        endpoint = "read" if method == "GET" else "write"
+        for _ in range(self.MAX_RETRIES + 1):
+            self.limiter.acquire("kalshi", endpoint, priority, cost)
+            send_headers = dict(headers or {})
+            if signed_path:
+                send_headers.update(self._generate_signature(method, signed_path))
+            resp = requests.request(method, url, headers=send_headers, **kwargs)
+            self.limiter.observe("kalshi", endpoint, resp)
+            if resp.status_code != 429:
+                break
+        return resp
 
-    def get_markets(self, limit=100):
-        """Fetch active markets from Kalshi."""
-        path = f"/markets?limit={limit}"
-        headers = self._generate_signature("GET", path)
+    def get_markets(self, limit=100, market_filter=None):
+        """Fetch active markets from Kalshi, pushing the filter down into query params and following the cursor."""
+        market_filter = market_filter or MarketFilter(page_size=limit, max_pages=1)
+        params = market_filter.kalshi_params()
+        markets = []
         try:
-            resp = requests.get(f"{self.base_url}{path}", headers=headers)
-            resp.raise_for_status()
-            return resp.json().get("markets", [])
+            for _ in range(market_filter.max_pages):
+                resp = self._send("GET", f"{self.base_url}/markets", DISCOVERY, params=params,
+                                  signed_path=urlparse(self.base_url).path + "/markets",
+                                  headers={"Accept-Encoding": ACCEPT_ENCODING})
+                resp.raise_for_status()
+                self.stats.record(resp)
+                page, cursor = decode_kalshi_markets(resp.content)
+                markets.extend(page)
+                if not cursor:
+                    break
+                params["cursor"] = cursor
+            return markets
         except Exception as e:
             logger.error(f"Error fetching Kalshi markets: {e}")
             if 'resp' in locals():
                 logger.error(resp.text)
+            return markets
+
+    def get_orderbook(self, ticker, depth=10, priority=DISCOVERY):
+        """Resting bids for one market: {"yes": [[price, qty], ...], "no": [...]}, best price last."""
+        try:
+            resp = self._send("GET", f"{self.base_url}/markets/{ticker}/orderbook", priority, params={"depth": depth},
+                              headers={"Accept-Encoding": ACCEPT_ENCODING})
+            resp.raise_for_status()
+            self.stats.record(resp)
+            return resp.json().get("orderbook") or {}
+        except Exception as e:
+            logger.error(f"Error fetching Kalshi orderbook for {ticker}: {e}")
+            return None
+
+    def get_trades(self, ticker, limit=100, min_ts=None, priority=DISCOVERY):
+        """Recent public prints on one market, newest first (yes_price / no_price in cents, taker_side)."""
+        params = {"ticker": ticker, "limit": limit}
+        if min_ts:
+            params["min_ts"] = int(min_ts)
+        try:
+            resp = self._send("GET", f"{self.base_url}/markets/trades", priority, params=params)
+            resp.raise_for_status()
+            self.stats.record(resp)
+            return resp.json().get("trades") or []
+        except Exception as e:
+            logger.error(f"Error fetching Kalshi trades for {ticker}: {e}")
             return []
+
+    def get_market(self, ticker, priority=DISCOVERY):
+        """One market's listing, including `status` and `result` ("yes"/"no" once determined)."""
+        try:
+            resp = self._send("GET", f"{self.base_url}/markets/{ticker}", priority)
+            resp.raise_for_status()
+            self.stats.record(resp)
+            return resp.json().get("market")
+        except Exception as e:
+            logger.error(f"Error fetching Kalshi market {ticker}: {e}")
+            return None
+
+    def _request(self, method, path, params=None, json_body=None, priority=None, cost=1.0):
+        """
+        Signed request against an authenticated endpoint. Kalshi signs the full path without the query string.
+        Unless told otherwise, deletes are cancels and everything else on /portfolio is order traffic.
+        """
+        if priority is None:
+            priority = CANCEL if method == "DELETE" else ORDER
+        resp = self._send(method, f"{self.base_url}{path}", priority, cost, params=params, json=json_body,
+                          signed_path=urlparse(self.base_url).path + path)
+        resp.raise_for_status()
+        return resp.json() if resp.content else {}
+
+    def get_orders(self, status="resting", ticker=None, min_ts=None):
+        """Fetch our own orders (any status when `status` is None), following the cursor until exhausted."""
+        orders, cursor = [], None
+        while True:
+            params = {"limit": 200}
+            if status:
+                params["status"] = status
+            if ticker:
+                params["ticker"] = ticker
+            if min_ts:
+                params["min_ts"] = int(min_ts)
+            if cursor:
+                params["cursor"] = cursor
+            data = self._request("GET", "/portfolio/orders", params=params)
+            orders.extend(data.get("orders", []))
+            cursor = data.get("cursor")
+            if not cursor:
+                return orders
+
+    @staticmethod
+    def _order_body(ticker, side, action, count, price_cents, client_order_id=None):
+        body = {
+            "ticker": ticker,
+            "side": side,
+            "action": action,
+            "count": int(count),
+            "type": "limit",
+            f"{side}_price": int(price_cents),
+        }
+        if client_order_id:
+            body["client_order_id"] = client_order_id
+        return body
+
+    @staticmethod
+    def _maybe_placed(error):
+        """Timeouts, dropped connections and 5xx leave an order's fate unknown; a 4xx is a definite rejection."""
+        response = getattr(error, "response", None)
+        return response is None or response.status_code >= 500
+
+    def reconcile(self, specs, since):
+        """
+        Looks up orders whose placement request failed ambiguously, by client_order_id.
+        Returns {client_order_id: order} for those the venue did accept.
+        """
+        wanted = {s["client_order_id"]: s["ticker"] for s in specs if s.get("client_order_id")}
+        found = {}
+        for ticker in set(wanted.values()):
+            try:
+                orders = self.get_orders(status=None, ticker=ticker, min_ts=since - 5)
+            except Exception as e:
+                logger.error(f"Kalshi order reconciliation failed for {ticker}: {e}")
+                continue
+            found.update((o["client_order_id"], o) for o in orders if o.get("client_order_id") in wanted)
+        if found:
+            logger.warning(f"Reconciled {len(found)}/{len(wanted)} Kalshi order(s) the venue accepted despite the error.")
+        return found
+
+    def place_order(self, ticker, side, action, count, price_cents, client_order_id=None, priority=ORDER):
+        """
+        Limit order. Price is quoted on the side being traded (yes_price or no_price), in cents.
+        If the request fails without a definite answer, the order is looked up by client_order_id before giving up.
+        """
+        body = self._order_body(ticker, side, action, count, price_cents, client_order_id)
+        since = time.time()
+        try:
+            return self._request("POST", "/portfolio/orders", json_body=body, priority=priority).get("order", {})
+        except Exception as e:
+            if client_order_id and self._maybe_placed(e):
+                order = self.reconcile([body], since).get(client_order_id)
+                if order:
+                    return order
+            raise
+
+    def place_orders(self, specs, priority=ORDER):
+        """
+        Batch of limit orders (dicts of place_order's arguments), BATCH_LIMIT per request.
+        Returns (order, error) per spec, in order. A failed request fails its whole chunk,
+        except orders that reconciliation by client_order_id finds live at the venue.
+        """
+        results = []
+        for i in range(0, len(specs), self.BATCH_LIMIT):
+            chunk = specs[i:i + self.BATCH_LIMIT]
+            since = time.time()
+            try:
+                # Each order in a batch counts against the write quota
+                data = self._request("POST", "/portfolio/orders/batched", priority=priority, cost=len(chunk),
+                                     json_body={"orders": [self._order_body(**spec) for spec in chunk]})
+                entries = data.get("orders", [])
+                results.extend((e.get("order") or {}, self._batch_error(e)) for e in entries)
+                results.extend(({}, "missing from batch response") for _ in chunk[len(entries):])
+            except Exception as e:
+                logger.error(f"Kalshi batch order request failed: {e}")
+                found = self.reconcile(chunk, since) if self._maybe_placed(e) else {}
+                results.extend((found[s["client_order_id"]], None) if s.get("client_order_id") in found else ({}, str(e))
+                               for s in chunk)
+        return results
+
+    @staticmethod
+    def _batch_error(entry):
+        error = entry.get("error")
+        if not error:
+            return None
+        return error.get("message") or error.get("code") or str(error) if isinstance(error, dict) else str(error)
+
+    def get_order(self, order_id, priority=ORDER):
+        return self._request("GET", f"/portfolio/orders/{order_id}", priority=priority).get("order", {})
+
+    def cancel_order(self, order_id):
+        return self._request("DELETE", f"/portfolio/orders/{order_id}")
+
+    def cancel_orders(self, order_ids):
+        """Batch cancel, BATCH_LIMIT ids per request. Returns (order, error) per id, in order."""
+        results = []
+        for i in range(0, len(order_ids), self.BATCH_LIMIT):
+            chunk = order_ids[i:i + self.BATCH_LIMIT]
+            try:
+                # Batched cancels are billed at a fraction of a write each
+                data = self._request("DELETE", "/portfolio/orders/batched", json_body={"ids": chunk}, cost=0.2 * len(chunk))
+                entries = {e.get("order_id") or (e.get("order") or {}).get("order_id"): e for e in data.get("orders", [])}
+                for order_id in chunk:
+                    entry = entries.get(order_id)
+                    results.append((entry.get("order") or {}, self._batch_error(entry)) if entry
+                                   else ({}, "missing from batch response"))
+            except Exception as e:
+                logger.error(f"Kalshi batch cancel request failed: {e}")
+                results.extend(({}, str(e)) for _ in chunk)
+        return results
+
+    def cancel_all_orders(self, ticker=None):
+        """Mass-cancel every resting order (on one market if `ticker` is given). Returns the number cancelled."""
+        try:
+            resting = self.get_orders(status="resting", ticker=ticker)
+        except Exception as e:
+            logger.error(f"Error listing resting Kalshi orders: {e}")
+            return 0
+
+        cancelled = 0
+        results = self.cancel_orders([order["order_id"] for order in resting])
+        for order, (_, error) in zip(resting, results):
+            if error:
+                logger.error(f"Failed to cancel Kalshi order {order.get('order_id')}: {error}")
+            else:
+                cancelled += 1
+        return cancelled
@@ -1,24 +1,117 @@
+import os
+import json
 import requests
 from src.utils import logger
+from src.startup import lazy_component
+from src.api.filters import MarketFilter, TransferStats
+from src.api.decoding import ACCEPT_ENCODING, decode_gamma_events
+from src.api.ratelimit import rate_limiter, DISCOVERY
 
 class PolymarketClient:
     def __init__(self):
         # Polymarket Gamma API for discovery
-        self.base_url = "https://gamma-api.polymarket.com"
-        
-    def get_markets(self, limit=100):
-        """Fetch active markets from Polymarket via Gamma API."""
+        self.base_url = os.getenv("POLYMARKET_GAMMA_URL", "https://gamma-api.polymarket.com")
+        # CLOB for order books (public, unauthenticated reads)
+        self.clob_url = os.getenv("POLYMARKET_CLOB_URL", "https://clob.polymarket.com")
+        self.stats = TransferStats()
+        self.private_key = os.getenv("POLYMARKET_PRIVATE_KEY")
+        self.funder = os.getenv("POLYMARKET_FUNDER_ADDRESS")
+        # 0 = EOA, 1 = email/Magic proxy, 2 = browser wallet proxy (Gnosis Safe)
+        self.signature_type = int(os.getenv("POLYMARKET_SIGNATURE_TYPE", "0"))
+        self.limiter = rate_limiter
+        self.MAX_RETRIES = 2      # Re-sends after a 429, once the limiter lets us
+
+    @lazy_component
+    def order_signer(self):
+        # EIP-712 domains and signer-static ABI words are computed once here
+        if not self.private_key:
+            return None
+        from src.api.signing import PolymarketOrderSigner
+        return PolymarketOrderSigner(self.private_key, funder=self.funder, signature_type=self.signature_type)
+
+    def sign_orders(self, specs):
+        """Signs CLOB order payloads (dicts of PolymarketOrderSigner.sign's arguments) on the shared signing pool."""
+        from src.api.signing import signing_service
+        if not self.order_signer:
+            raise RuntimeError("POLYMARKET_PRIVATE_KEY is not set")
+        return signing_service.map(lambda spec: self.order_signer.sign(**spec), [(s,) for s in specs])
+
+    def _send(self, endpoint, priority, method, url, **kwargs):
+        """Rate-limited request against one Polymarket quota ("gamma", "clob_read", "clob_write"), retrying 429s."""
+        for _ in range(self.MAX_RETRIES + 1):
+            self.limiter.acquire("polymarket", endpoint, priority)
+            resp = requests.request(method, url, **kwargs)
+            self.limiter.observe("polymarket", endpoint, resp)
+            if resp.status_code != 429:
+                break
+        return resp
+
+    def get_markets(self, limit=100, market_filter=None):
+        """Fetch active markets from Polymarket via Gamma API, pushing the filter down and paging by offset."""
+        market_filter = market_filter or MarketFilter(page_size=limit, max_pages=1)
+        params = market_filter.gamma_params()
+        events = []
         try:
-            params = {
-                "active": "true",
-                "closed": "false",
-                "limit": limit
-            }
-            resp = requests.get(f"{self.base_url}/events", params=params)
-            resp.raise_for_status()
-            return resp.json()
+            for page in range(market_filter.max_pages):
+                params["offset"] = page * market_filter.page_size
+                resp = self._send("gamma", DISCOVERY, "GET", f"{self.base_url}/events", params=params,
+                                  headers={"Accept-Encoding": ACCEPT_ENCODING})
+                resp.raise_for_status()
+                self.stats.record(resp)
+                batch = decode_gamma_events(resp.content)
+                events.extend(batch)
+                if len(batch) < market_filter.page_size:
+                    break
+            return events
         except Exception as e:
             logger.error(f"Error fetching Polymarket markets: {e}")
             if 'resp' in locals():
                 logger.error(resp.text)
-            return []
+            return events
+
+    def get_resolution(self, token_id, priority=DISCOVERY):
+        """Final price (1.0 or 0.0) of an outcome token once its market has resolved, else None."""
+        try:
+            resp = self._send("gamma", priority, "GET", f"{self.base_url}/markets", params={"clob_token_ids": token_id})
+            resp.raise_for_status()
+            self.stats.record(resp)
+            for market in resp.json():
+                tokens = json.loads(market.get("clobTokenIds") or "[]")
+                prices = json.loads(market.get("outcomePrices") or "[]")
+                if not market.get("closed") or token_id not in tokens or len(prices) != len(tokens):
+                    continue
+                price = float(prices[tokens.index(token_id)])
+                return price if price in (0.0, 1.0) else None
+            return None
+        except Exception as e:
+            logger.error(f"Error fetching Polymarket resolution for {token_id}: {e}")
+            return None
+
+    def get_book(self, token_id, priority=DISCOVERY):
+        """Order book for one outcome token: {"asset_id", "bids", "asks", "hash", ...}; levels are price/size strings."""
+        try:
+            resp = self._send("clob_read", priority, "GET", f"{self.clob_url}/book", params={"token_id": token_id},
+                              headers={"Accept-Encoding": ACCEPT_ENCODING})
+            resp.raise_for_status()
+            self.stats.record(resp)
+            return resp.json()
+        except Exception as e:
+            logger.error(f"Error fetching Polymarket book for {token_id}: {e}")
+            return None
+
+    def get_books(self, token_ids, chunk=100, priority=DISCOVERY):
+        """Order books for many tokens via POST /books, `chunk` tokens per request."""
+        token_ids = list(token_ids)
+        books = []
+        try:
+            for i in range(0, len(token_ids), chunk):
+                body = [{"token_id": t} for t in token_ids[i:i + chunk]]
+                resp = self._send("clob_read", priority, "POST", f"{self.clob_url}/books", json=body,
+                                  headers={"Accept-Encoding": ACCEPT_ENCODING})
+                resp.raise_for_status()
+                self.stats.record(resp)
+                books.extend(resp.json())
+            return books
+        except Exception as e:
+            logger.error(f"Error fetching Polymarket books: {e}")
+            return books
@@ -0,0 +1,219 @@
+import os
+import json
+import time
+import sqlite3
+import threading
+from src.utils import logger
+
+# Traffic classes, most important first
+CANCEL = 0          # Pulling orders (kill switch, timeouts, replaces)
+ARBITRAGE = 1       # Arbitrage legs and their hedges
+ORDER = 2           # Directional orders and order-status polls
+DISCOVERY = 3       # Market listings, books for scanning
+
+PRIORITY_NAMES = {CANCEL: "cancel", ARBITRAGE: "arbitrage", ORDER: "order", DISCOVERY: "discovery"}
+
+class MemoryBucketStore:
+    """Bucket state for a single process."""
+    def __init__(self):
+        self._state = {}
+        self._lock = threading.Lock()
+
+    def update(self, key, fn):
+        with self._lock:
+            state = self._state.get(key)
+            state, result = fn(dict(state) if state else None)
+            self._state[key] = state
+            return result
+
+class SQLiteBucketStore:
+    """
+    Bucket state shared by every process on the host. Each update is one
+    exclusive transaction, so sharded workers draw from one account quota.
+    """
+    def __init__(self, db_path="data/coordination.db"):
+        self.db_path = db_path
+        os.makedirs(os.path.dirname(self.db_path) or ".", exist_ok=True)
+        self._local = threading.local()
+        with self._connect() as conn:
+            conn.execute("PRAGMA journal_mode=WAL")
+            conn.execute('''
+                CREATE TABLE IF NOT EXISTS rate_buckets (
+                    key TEXT PRIMARY KEY,
+                    state TEXT NOT NULL
+                )
+            ''')
+
+    def _connect(self):
+        # One connection per thread: clients call in from asyncio.to_thread workers
+        conn = getattr(self._local, "conn", None)
+        if conn is None:
+            conn = self._local.conn = sqlite3.connect(self.db_path, timeout=10.0, isolation_level=None)
+        return conn
+
+    def update(self, key, fn):
+        conn = self._connect()
+        conn.execute("BEGIN IMMEDIATE")
+        try:
+            row = conn.execute("SELECT state FROM rate_buckets WHERE key = ?", (key,)).fetchone()
+            state, result = fn(json.loads(row[0]) if row else None)
+            conn.execute("INSERT INTO rate_buckets (key, state) VALUES (?, ?) "
+                         "ON CONFLICT(key) DO UPDATE SET state = excluded.state", (key, json.dumps(state)))
+            conn.execute("COMMIT")
+        except Exception:
+            conn.execute("ROLLBACK")
+            raise
+        return result
+
+class RateLimiter:
+    """
+    Token buckets per (venue, endpoint class). Lower-priority traffic may not
+    draw a bucket below its RESERVE share of the burst, so when the quota runs
+    short discovery reads wait first and cancels never do. Each bucket adapts
+    to the venue: 429s (and Retry-After) block it and halve its rate, which then
+    recovers linearly; X-RateLimit-Remaining caps the local token count.
+    """
+    def __init__(self, store=None, limits=None):
+        self.store = store or MemoryBucketStore()
+        # (venue, endpoint class) -> (requests/sec, burst); published tiers for a basic account
+        self.LIMITS = {
+            ("kalshi", "read"): (20.0, 20.0),
+            ("kalshi", "write"): (10.0, 10.0),
+            ("polymarket", "gamma"): (10.0, 20.0),
+            ("polymarket", "clob_read"): (15.0, 30.0),
+            ("polymarket", "clob_write"): (50.0, 100.0),
+        }
+        self.LIMITS.update(limits or {})
+        self.DEFAULT_LIMIT = (5.0, 5.0)
+        self.RESERVE = {CANCEL: 0.0, ARBITRAGE: 0.0, ORDER: 0.2, DISCOVERY: 0.5}
+        self.BACKOFF = 1.0             # Block after a 429 without Retry-After
+        self.MIN_RATE_SHARE = 0.1      # Adaptive rate never drops below this share of the configured rate
+        self.RECOVERY = 0.02           # Share of the configured rate regained per second after a cut
+        self.MAX_WAIT_SLICE = 0.25     # Re-check the bucket at least this often while waiting
+
+        self.waited = {}               # priority name -> seconds spent waiting, this process
+        self.throttled = 0             # 429s seen by this process
+
+    def share(self, db_path="data/coordination.db"):
+        """Moves bucket state into SQLite so every worker process shares the quota."""
+        self.store = SQLiteBucketStore(db_path)
+        return self
+
+    def _limit(self, venue, endpoint):
+        return self.LIMITS.get((venue, endpoint), self.DEFAULT_LIMIT)
+
+    def _refill(self, state, base_rate, burst, now):
+        if state is None:
+            return {"tokens": burst, "updated": now, "rate": base_rate, "blocked_until": 0.0}
+        elapsed = max(now - state["updated"], 0.0)
+        state["tokens"] = min(burst, state["tokens"] + elapsed * state["rate"])
+        state["rate"] = min(base_rate, state["rate"] + elapsed * base_rate * self.RECOVERY)
+        state["updated"] = now
+        return state
+
+    def try_acquire(self, venue, endpoint, priority=DISCOVERY, cost=1.0):
+        """Takes `cost` tokens if this priority may; otherwise returns the seconds to wait (0.0 means taken)."""
+        base_rate, burst = self._limit(venue, endpoint)
+        floor = burst * self.RESERVE.get(priority, 0.0)
+
+        def take(state):
+            now = time.time()
+            state = self._refill(state, base_rate, burst, now)
+            if state["blocked_until"] > now:
+                return state, state["blocked_until"] - now
+            # A batch costlier than the burst goes through from a full bucket and leaves it in debt
+            need = min(cost, burst - floor)
+            if state["tokens"] - need >= floor - 1e-9:
+                state["tokens"] -= cost
+                return state, 0.0
+            return state, (floor + need - state["tokens"]) / state["rate"]
+
+        return self.store.update(f"{venue}:{endpoint}", take)
+
+    def acquire(self, venue, endpoint, priority=DISCOVERY, cost=1.0):
+        """Blocks the calling thread until the request may go out. Returns the seconds waited."""
+        waited = 0.0
+        while True:
+            wait = self.try_acquire(venue, endpoint, priority, cost)
+            if wait <= 0:
+                break
+            wait = min(wait, self.MAX_WAIT_SLICE)
+            time.sleep(wait)
+            waited += wait
+        if waited:
+            name = PRIORITY_NAMES.get(priority, str(priority))
+            self.waited[name] = self.waited.get(name, 0.0) + waited
+        return waited
+
+    def observe(self, venue, endpoint, resp):
+        """Feeds a response back: 429s block and slow the bucket, rate-limit headers correct it."""
+        status = getattr(resp, "status_code", None)
+        headers = getattr(resp, "headers", None) or {}
+        remaining = headers.get("X-RateLimit-Remaining") or headers.get("RateLimit-Remaining")
+        reset = headers.get("X-RateLimit-Reset") or headers.get("RateLimit-Reset")
+        retry_after = headers.get("Retry-After")
+        if status != 429 and remaining is None:
+            return
+        base_rate, burst = self._limit(venue, endpoint)
+
+        def adjust(state):
+            now = time.time()
+            state = self._refill(state, base_rate, burst, now)
+            if remaining is not None:
+                try:
+                    state["tokens"] = min(state["tokens"], float(remaining))
+                    if float(remaining) <= 0 and reset is not None:
+                        # Reset is seconds-until on most venues; treat large values as an epoch
+                        r = float(reset)
+                        state["blocked_until"] = max(state["blocked_until"], r if r > 1e9 else now + r)
+                except ValueError:
+                    pass
+            if status == 429:
+                try:
+                    delay = float(retry_after) if retry_after is not None else self.BACKOFF
+                except ValueError:
+                    delay = self.BACKOFF
+                state["blocked_until"] = max(state["blocked_until"], now + delay)
+                state["rate"] = max(base_rate * self.MIN_RATE_SHARE, state["rate"] / 2)
+                state["tokens"] = min(state["tokens"], 0.0)
+            return state, None
+
+        self.store.update(f"{venue}:{endpoint}", adjust)
+        if status == 429:
+            self.throttled += 1
+            logger.warning(f"[RATELIMIT] 429 from {venue}/{endpoint}; backing off "
+                           f"{retry_after or self.BACKOFF}s and halving the rate.")
+
+    def report(self):
+        waits = ", ".join(f"{k} {v:.1f}s" for k, v in sorted(self.waited.items())) or "none"
+        return f"[RATELIMIT] 429s: {self.throttled}; time spent waiting by priority: {waits}"
+
+# One limiter per process. With RATE_LIMIT_DB set (sharded workers and their stage
+# processes inherit it) every process draws from the same SQLite-backed buckets.
+rate_limiter = RateLimiter()
+if os.getenv("RATE_LIMIT_DB"):
+    rate_limiter.share(os.getenv("RATE_LIMIT_DB"))
+
+if __name__ == "__main__":
+    # Mixed load on a 10 req/s bucket: discovery floods, orders trickle, then a burst of cancels
+    limiter = RateLimiter(limits={("demo", "write"): (10.0, 10.0)})
+    done = {}
+
+    def client(priority, n, gap):
+        latencies = []
+        for _ in range(n):
+            latencies.append(limiter.acquire("demo", "write", priority))
+            time.sleep(gap)
+        done[PRIORITY_NAMES[priority]] = latencies
+
+    threads = [threading.Thread(target=client, args=(DISCOVERY, 40, 0.0)),
+               threading.Thread(target=client, args=(ORDER, 10, 0.1))]
+    for t in threads:
+        t.start()
+    time.sleep(1.0)
+    cancels = threading.Thread(target=client, args=(CANCEL, 5, 0.0))
+    cancels.start()
+    for t in threads + [cancels]:
+        t.join()
+    for name, lat in done.items():
+        print(f"{name:>10}: {len(lat)} requests, mean wait {sum(lat) / len(lat) * 1000:6.1f} ms, max {max(lat) * 1000:6.1f} ms")
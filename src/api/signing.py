@@ -0,0 +1,323 @@
+import os
+import time
+import base64
+import asyncio
+import secrets
+import threading
+from functools import lru_cache
+from concurrent.futures import ThreadPoolExecutor
+from src.utils import logger
+
+# Fast keccak when one of the usual Ethereum packages is installed; pure Python otherwise
+try:
+    from Crypto.Hash import keccak as _pycryptodome_keccak
+
+    def keccak256(data):
+        return _pycryptodome_keccak.new(data=data, digest_bits=256).digest()
+except ImportError:
+    try:
+        from eth_hash.auto import keccak as keccak256
+    except ImportError:
+        keccak256 = None
+
+_MASK = (1 << 64) - 1
+_ROT = [0, 1, 62, 28, 27, 36, 44, 6, 55, 20, 3, 10, 43, 25, 39, 41, 45, 15, 21, 8, 18, 2, 61, 56, 14]
+
+def _round_constants():
+    def bit(t):
+        r = 1
+        for _ in range(t % 255):
+            r <<= 1
+            if r & 0x100:
+                r ^= 0x171
+        return r & 1
+    return [sum(bit(j + 7 * i) << ((1 << j) - 1) for j in range(7)) for i in range(24)]
+
+_RC = _round_constants()
+
+def _keccak_f(a):
+    for rc in _RC:
+        c = [a[x] ^ a[x + 5] ^ a[x + 10] ^ a[x + 15] ^ a[x + 20] for x in range(5)]
+        d = [c[(x - 1) % 5] ^ (((c[(x + 1) % 5] << 1) | (c[(x + 1) % 5] >> 63)) & _MASK) for x in range(5)]
+        b = [0] * 25
+        for i in range(25):
+            x, y = i % 5, i // 5
+            v, r = a[i] ^ d[x], _ROT[i]
+            b[y + 5 * ((2 * x + 3 * y) % 5)] = ((v << r) | (v >> (64 - r))) & _MASK if r else v
+        a = [b[i] ^ (~b[(i + 1) % 5 + i - i % 5] & b[(i + 2) % 5 + i - i % 5]) for i in range(25)]
+        a[0] ^= rc
+    return a
+
+def _keccak256_py(data):
+    """Keccak-256 as Ethereum uses it (original padding, not SHA3-256). Slow; a fallback only."""
+    rate = 136
+    data = bytearray(data) + b"\x01" + b"\x00" * ((-len(data) - 1) % rate)
+    data[-1] |= 0x80
+    state = [0] * 25
+    for off in range(0, len(data), rate):
+        block = data[off:off + rate]
+        for i in range(rate // 8):
+            state[i] ^= int.from_bytes(block[8 * i:8 * i + 8], "little")
+        state = _keccak_f(state)
+    return b"".join(state[i].to_bytes(8, "little") for i in range(4))
+
+if keccak256 is None:
+    keccak256 = _keccak256_py
+
+# secp256k1, for the recovery id cryptography's ECDSA does not return
+_P = 2**256 - 2**32 - 977
+_N = 0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141
+_G = (0x79BE667EF9DCBBAC55A06295CE870B07029BFCDB2DCE28D959F2815B16F81798,
+      0x483ADA7726A3C4655DA4FBFC0E1108A8FD17B448A68554199C47D08FFB10D4B8)
+
+def _jadd(p, q):
+    """Jacobian + affine point addition (q affine); None is the point at infinity."""
+    if p is None:
+        return (q[0], q[1], 1)
+    x1, y1, z1 = p
+    z1z1 = z1 * z1 % _P
+    u2 = q[0] * z1z1 % _P
+    s2 = q[1] * z1 * z1z1 % _P
+    h, r = (u2 - x1) % _P, (s2 - y1) % _P
+    if h == 0:
+        return _jdouble(p) if r == 0 else None
+    hh = h * h % _P
+    hhh = h * hh % _P
+    v = x1 * hh % _P
+    x3 = (r * r - hhh - 2 * v) % _P
+    return (x3, (r * (v - x3) - y1 * hhh) % _P, z1 * h % _P)
+
+def _jdouble(p):
+    x, y, z = p
+    if y == 0:
+        return None
+    yy = y * y % _P
+    s = 4 * x * yy % _P
+    m = 3 * x * x % _P
+    x3 = (m * m - 2 * s) % _P
+    return (x3, (m * (s - x3) - 8 * yy * yy) % _P, 2 * y * z % _P)
+
+def _affine(p):
+    zi = pow(p[2], -1, _P)
+    return (p[0] * zi * zi % _P, p[1] * zi * zi * zi % _P)
+
+@lru_cache(maxsize=8)
+def _doublings(point):
+    """2^i * point for i < 256: fixed points (G, our own public key) multiply with additions only."""
+    table, p = [], (point[0], point[1], 1)
+    for _ in range(256):
+        table.append(_affine(p))
+        p = _jdouble(p)
+    return table
+
+def _fixed_mul(point, k):
+    table, acc, i = _doublings(point), None, 0
+    while k:
+        if k & 1:
+            acc = _jadd(acc, table[i])
+        k >>= 1
+        i += 1
+    return acc
+
+class KalshiSigner:
+    """
+    Kalshi request signatures (RSA-PKCS1v15 over timestamp + method + path). The key
+    is parsed once and the padding/hash objects and encoded method+path prefixes are
+    reused, so each request pays for the RSA operation and nothing else.
+    """
+    def __init__(self, key_id, private_key):
+        from cryptography.hazmat.primitives import hashes
+        from cryptography.hazmat.primitives.asymmetric import padding
+        self.key_id = key_id
+        self.private_key = private_key
+        self._padding = padding.PKCS1v15()
+        self._hash = hashes.SHA256()
+
+    @staticmethod
+    @lru_cache(maxsize=4096)
+    def _suffix(method, path):
+        return (method + path).encode()
+
+    def sign(self, method, path, timestamp_ms=None):
+        timestamp = str(timestamp_ms if timestamp_ms is not None else int(time.time() * 1000))
+        signature = self.private_key.sign(timestamp.encode() + self._suffix(method, path), self._padding, self._hash)
+        return {
+            "KALSHI-ACCESS-KEY": self.key_id,
+            "KALSHI-ACCESS-SIGNATURE": base64.b64encode(signature).decode(),
+            "KALSHI-ACCESS-TIMESTAMP": timestamp,
+        }
+
+class PolymarketOrderSigner:
+    """
+    EIP-712 signatures for Polymarket CTF Exchange orders. The type hash, both
+    exchange domain separators and the ABI words that only depend on the signer
+    (maker, signer, taker, signature type) are computed once; an order then costs
+    two keccaks over its variable fields plus one secp256k1 signature.
+    """
+    ORDER_TYPE = (b"Order(uint256 salt,address maker,address signer,address taker,uint256 tokenId,"
+                  b"uint256 makerAmount,uint256 takerAmount,uint256 expiration,uint256 nonce,"
+                  b"uint256 feeRateBps,uint8 side,uint8 signatureType)")
+    EXCHANGES = {
+        False: "0x4bFb41d5B3570DeFd03C39a9A4D8dE6Bd8B8982E",   # CTF Exchange
+        True: "0xC5d563A36AE78145C45a50134d48A1215220f80a",    # NegRisk CTF Exchange
+    }
+    BUY, SELL = 0, 1
+
+    def __init__(self, private_key, funder=None, signature_type=0, chain_id=137):
+        from cryptography.hazmat.primitives.asymmetric import ec
+        secret = int(private_key[2:] if private_key.startswith("0x") else private_key, 16)
+        self._key = ec.derive_private_key(secret, ec.SECP256K1())
+        pub = self._key.public_key().public_numbers()
+        self._pub = (pub.x, pub.y)
+        self.address = "0x" + keccak256(pub.x.to_bytes(32, "big") + pub.y.to_bytes(32, "big"))[-20:].hex()
+        self.maker = funder or self.address
+        self.signature_type = signature_type
+        self._sign_digest = self._fast_backend(secret) or self._cryptography_sign
+
+        word = lambda v: int(v, 16).to_bytes(32, "big") if isinstance(v, str) else int(v).to_bytes(32, "big")
+        self._word = word
+        self._typehash = keccak256(self.ORDER_TYPE)
+        domain_type = keccak256(b"EIP712Domain(string name,string version,uint256 chainId,address verifyingContract)")
+        name, version = keccak256(b"Polymarket CTF Exchange"), keccak256(b"1")
+        self._domains = {
+            neg: b"\x19\x01" + keccak256(domain_type + name + version + word(chain_id) + word(contract))
+            for neg, contract in self.EXCHANGES.items()
+        }
+        self._signer_words = (word(self.maker), word(self.address), word(0))
+        self._sig_type_word = word(signature_type)
+
+    @staticmethod
+    def _fast_backend(secret):
+        """Native secp256k1 signing when coincurve or eth_keys is installed."""
+        try:
+            import coincurve
+            key = coincurve.PrivateKey(secret.to_bytes(32, "big"))
+            return lambda digest: key.sign_recoverable(digest, hasher=None)
+        except ImportError:
+            pass
+        try:
+            from eth_keys import keys
+            key = keys.PrivateKey(secret.to_bytes(32, "big"))
+            return lambda digest: key.sign_msg_hash(digest).to_bytes()
+        except ImportError:
+            return None
+
+    def _cryptography_sign(self, digest):
+        from cryptography.hazmat.primitives import hashes
+        from cryptography.hazmat.primitives.asymmetric import ec, utils
+        r, s = utils.decode_dss_signature(self._key.sign(digest, ec.ECDSA(utils.Prehashed(hashes.SHA256()))))
+        # Recovery id is the parity of R.y; R = (e/s)G + (r/s)Q with both points fixed
+        e, s_inv = int.from_bytes(digest, "big") % _N, pow(s, -1, _N)
+        point = _fixed_mul(_G, e * s_inv % _N)
+        q = _fixed_mul(self._pub, r * s_inv % _N)
+        point = _jadd(point, _affine(q)) if point else q
+        v = _affine(point)[1] & 1
+        if s > _N // 2:         # Ethereum only accepts low-s; negating s flips R
+            s, v = _N - s, v ^ 1
+        return r.to_bytes(32, "big") + s.to_bytes(32, "big") + bytes([v])
+
+    def digest(self, token_id, maker_amount, taker_amount, side, salt, expiration=0, nonce=0, fee_rate_bps=0, neg_risk=False):
+        word = self._word
+        maker, signer, taker = self._signer_words
+        struct = keccak256(self._typehash + word(salt) + maker + signer + taker + word(token_id)
+                           + word(maker_amount) + word(taker_amount) + word(expiration) + word(nonce)
+                           + word(fee_rate_bps) + word(side) + self._sig_type_word)
+        return keccak256(self._domains[neg_risk] + struct)
+
+    def sign(self, token_id, price, size, side, expiration=0, nonce=0, fee_rate_bps=0, neg_risk=False):
+        """Signed CLOB order payload for `size` shares at `price` (USDC and shares have 6 decimals)."""
+        shares, usdc = round(size * 1e6), round(size * price * 1e6)
+        maker_amount, taker_amount = (usdc, shares) if side == self.BUY else (shares, usdc)
+        salt = secrets.randbits(62)
+        digest = self.digest(token_id, maker_amount, taker_amount, side, salt, expiration, nonce, fee_rate_bps, neg_risk)
+        sig = bytearray(self._sign_digest(digest))
+        sig[64] = sig[64] % 27 + 27          # Ethereum v is 27/28
+        return {
+            "salt": salt,
+            "maker": self.maker,
+            "signer": self.address,
+            "taker": "0x0000000000000000000000000000000000000000",
+            "tokenId": str(token_id),
+            "makerAmount": str(maker_amount),
+            "takerAmount": str(taker_amount),
+            "expiration": str(expiration),
+            "nonce": str(nonce),
+            "feeRateBps": str(fee_rate_bps),
+            "side": "BUY" if side == self.BUY else "SELL",
+            "signatureType": self.signature_type,
+            "signature": "0x" + bytes(sig).hex(),
+        }
+
+class SigningService:
+    """
+    Shared thread pool for signatures. OpenSSL releases the GIL during RSA and
+    ECDSA operations, so signatures run in parallel across cores while the event
+    loop stays free. Bursts (batch orders, mass polls) are signed together with `map`.
+    """
+    def __init__(self, workers=None):
+        self.WORKERS = workers or int(os.getenv("SIGNING_WORKERS", 0)) or os.cpu_count() or 1
+        self._pool = None
+        self._lock = threading.Lock()
+
+    @property
+    def pool(self):
+        if self._pool is None:
+            with self._lock:
+                if self._pool is None:
+                    self._pool = ThreadPoolExecutor(max_workers=self.WORKERS, thread_name_prefix="signer")
+        return self._pool
+
+    async def run(self, fn, *args):
+        return await asyncio.get_running_loop().run_in_executor(self.pool, fn, *args)
+
+    def map(self, fn, items):
+        items = list(items)
+        if len(items) <= 1:
+            return [fn(*args) for args in items]
+        return list(self.pool.map(lambda args: fn(*args), items))
+
+    def shutdown(self):
+        if self._pool is not None:
+            self._pool.shutdown(wait=False)
+            self._pool = None
+
+signing_service = SigningService()
+
+if __name__ == "__main__":
+    # Signatures/sec per core: naive per-request setup vs the pre-parsed signer, then across the pool
+    from cryptography.hazmat.primitives import hashes, serialization
+    from cryptography.hazmat.primitives.asymmetric import rsa, padding
+
+    def rate(fn, n):
+        start = time.perf_counter()
+        for _ in range(n):
+            fn()
+        return n / (time.perf_counter() - start)
+
+    rsa_key = rsa.generate_private_key(public_exponent=65537, key_size=2048)
+    pem = rsa_key.private_bytes(serialization.Encoding.PEM, serialization.PrivateFormat.PKCS8, serialization.NoEncryption())
+
+    def naive():
+        # What a client that re-parses its PEM per request pays
+        key = serialization.load_pem_private_key(pem, password=None)
+        msg = (str(int(time.time() * 1000)) + "GET" + "/trade-api/v2/portfolio/orders").encode()
+        base64.b64encode(key.sign(msg, padding.PKCS1v15(), hashes.SHA256()))
+
+    kalshi = KalshiSigner("key", rsa_key)
+    print(f"Kalshi RSA-2048, PEM parsed per request: {rate(naive, 50):8.0f} sigs/s")
+    print(f"Kalshi RSA-2048, pre-parsed signer:      {rate(lambda: kalshi.sign('GET', '/trade-api/v2/portfolio/orders'), 500):8.0f} sigs/s")
+
+    service = SigningService()
+    n = 2000
+    start = time.perf_counter()
+    service.map(kalshi.sign, [("GET", f"/trade-api/v2/portfolio/orders/{i}") for i in range(n)])
+    elapsed = time.perf_counter() - start
+    print(f"Kalshi RSA-2048, pool of {service.WORKERS}:            {n / elapsed:8.0f} sigs/s "
+          f"({n / elapsed / service.WORKERS:.0f} per core)")
+
+    poly = PolymarketOrderSigner("0x" + "11" * 32)
+    backend = "native" if poly._sign_digest != poly._cryptography_sign else "cryptography + recovery"
+    hasher = "native" if keccak256 is not _keccak256_py else "pure Python"
+    print(f"Polymarket EIP-712 digest ({hasher} keccak): {rate(lambda: poly.digest(123, 500000, 1000000, 0, 42), 200):8.0f} /s")
+    print(f"Polymarket EIP-712 order ({backend}): {rate(lambda: poly.sign(123, 0.5, 10, 0), 50):8.0f} sigs/s")
+    service.shutdown()
@@ -0,0 +1,55 @@
+import json
+import unittest
+from unittest import mock
+from src.api import decoding
+
+class DecodingTest(unittest.TestCase):
+    """Nulls and malformed rows cost one row, never the page, with or without msgspec."""
+    def both(self, fn, *args):
+        yield fn(*args)
+        with mock.patch.object(decoding, "msgspec", None):
+            yield fn(*args)
+
+    def test_kalshi_nulls_decode_to_defaults(self):
+        body = json.dumps({"markets": [
+            {"ticker": "A", "title": None, "volume": None, "yes_ask": 40, "yes_bid": None, "strike_type": None},
+            {"ticker": "B", "title": "ok", "volume": 12, "yes_ask": 55, "yes_bid": 50},
+        ], "cursor": None}).encode()
+        for markets, cursor in self.both(decoding.decode_kalshi_markets, body):
+            self.assertEqual([m.get("ticker") for m in markets], ["A", "B"])
+            self.assertEqual(markets[0].get("title", ""), "")
+            self.assertEqual(markets[0].get("volume", 0), 0)
+            self.assertIsNone(cursor)
+
+    def test_kalshi_bad_row_is_skipped(self):
+        body = json.dumps({"markets": [{"ticker": "A", "volume": "lots"}, {"ticker": "B", "volume": 3}],
+                           "cursor": "next"}).encode()
+        markets, cursor = decoding.decode_kalshi_markets(body)
+        self.assertEqual([m.get("ticker") for m in markets], ["B"])
+        self.assertEqual(cursor, "next")
+
+    def test_gamma_nulls_decode_to_defaults(self):
+        body = json.dumps([
+            {"id": "1", "title": None, "volume": None, "negRisk": None, "markets": [
+                {"id": "m1", "question": None, "outcomePrices": '["0.4", "0.6"]', "volume": None, "negRisk": None},
+            ]},
+            {"id": "2", "title": "ok", "volume": "10.5", "negRisk": True, "markets": None},
+        ]).encode()
+        for events in self.both(decoding.decode_gamma_events, body):
+            self.assertEqual([e.get("id") for e in events], ["1", "2"])
+            self.assertFalse(events[0].get("negRisk", False))
+            self.assertEqual(events[0].get("markets")[0].get("volume", 0), 0)
+            self.assertEqual(events[1].get("markets", []), [])
+
+    def test_gamma_bad_market_drops_only_that_market(self):
+        body = json.dumps([
+            {"id": "1", "title": "a", "markets": [{"id": "m1", "volume": "n/a"}, {"id": "m2", "volume": 5}]},
+            {"id": "2", "title": "b", "volume": {"oops": 1}, "markets": []},
+            {"id": "3", "title": "c", "markets": [{"id": "m3"}]},
+        ]).encode()
+        events = decoding.decode_gamma_events(body)
+        self.assertEqual([e.get("id") for e in events], ["1", "3"])
+        self.assertEqual([m.get("id") for m in events[0].get("markets")], ["m2"])
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,37 @@
+import unittest
+from datetime import datetime, timezone
+from src.api.filters import MarketFilter
+
+MIN = datetime(2026, 3, 1, tzinfo=timezone.utc)
+MAX = datetime(2026, 3, 31, tzinfo=timezone.utc)
+
+class MarketFilterTest(unittest.TestCase):
+    def test_kalshi_params_push_down_close_bounds_and_tickers_but_not_volume(self):
+        f = MarketFilter(min_close=MIN, max_close=MAX, min_volume=500, event_ticker="KXFED-26MAR",
+                         series_ticker="KXFED", page_size=200)
+        self.assertEqual(f.kalshi_params(), {
+            "limit": 200, "status": "open", "min_close_ts": int(MIN.timestamp()), "max_close_ts": int(MAX.timestamp()),
+            "event_ticker": "KXFED-26MAR", "series_ticker": "KXFED",
+        })
+        self.assertEqual(MarketFilter().kalshi_params(), {"limit": 100, "status": "open"})
+
+    def test_gamma_params_push_down_end_dates_and_volume(self):
+        f = MarketFilter(min_close=MIN, max_close=MAX, min_volume=0, event_ticker="ignored")
+        self.assertEqual(f.gamma_params(), {
+            "active": "true", "closed": "false", "limit": 100,
+            "end_date_min": MIN.isoformat(), "end_date_max": MAX.isoformat(), "volume_min": 0,
+        })
+        self.assertEqual(MarketFilter(status="closed").gamma_params(), {"active": "false", "closed": "true", "limit": 100})
+
+    def test_matches_enforces_what_the_venue_could_not(self):
+        f = MarketFilter(min_close=MIN, max_close=MAX, min_volume=500)
+        row = {"volume": 800, "close_date": datetime(2026, 3, 15, tzinfo=timezone.utc)}
+        self.assertTrue(f.matches(row))
+        self.assertFalse(f.matches(dict(row, volume=499)))
+        self.assertFalse(f.matches(dict(row, close_date=None)))
+        self.assertFalse(f.matches(dict(row, close_date=datetime(2026, 4, 1, tzinfo=timezone.utc))))
+        self.assertFalse(f.matches(dict(row, close_date=datetime(2026, 2, 28, tzinfo=timezone.utc))))
+        self.assertTrue(MarketFilter().matches({"volume": 0}))
+
+if __name__ == "__main__":
+    unittest.main()
@@ -1,41 +1,119 @@
 import time
 import os
+import json
 import asyncio
 from src.utils import logger
-from pmxt import Polymarket, Kalshi
+from src.scanner import MarketScanner
+from src.outcomes import OutcomeTable
+from src.basket_arb import BasketArbEngine
+from src.strike_ladder import StrikeLadderScanner
+from src.compute import match_titles
 
 class ArbitrageScanner:
-    def __init__(self):
-        self.poly = Polymarket()
-        self.kalshi = Kalshi()
+    def __init__(self, market_data=None):
         self.max_cost = 0.98  # To guarantee a profit after fees, we need to buy both sides for < $0.98
+        # Matched (poly id, kalshi ticker) pairs, persisted across restarts by the orchestrator
+        self.pairs = {}
+        # A title match says nothing about resolution source, deadline or wording: only pairs an
+        # operator has checked resolve on the same event are traded as locked arbitrage
+        self.verified_pairs = set()
+        # Reads the sweep's shared, normalized markets instead of fetching both venues itself
+        self.market_data = market_data or MarketScanner().market_data
+        # Intra-venue: mutually exclusive Polymarket events whose full basket trades below payout
+        self.basket_engine = BasketArbEngine()
+        # Intra-venue: Kalshi strike ladders that violate monotonicity or range/above consistency
+        self.ladder_scanner = StrikeLadderScanner()
+
+    def load_verified(self, path):
+        """Reads a JSON list of "poly_id|kalshi_ticker" keys checked to resolve on the same event."""
+        try:
+            with open(path) as f:
+                self.verified_pairs = set(json.load(f))
+        except FileNotFoundError:
+            self.verified_pairs = set()
+        except (OSError, ValueError, TypeError) as e:
+            logger.error(f"[ARBITRAGE] Could not read verified pairs from {path}: {e}")
+            self.verified_pairs = set()
+        return len(self.verified_pairs)
+
+    def _check_pair(self, p, k):
+        # Normalized prices are YES cents; the Polymarket DOWN leg is the complement of its YES price
+        kalshi_yes = k["price"] / 100
+        poly_down = 1 - p["price"] / 100
+        
+        if (poly_down + kalshi_yes) < self.max_cost:
+            if f"{p['id']}|{k['id']}" not in self.verified_pairs:
+                # Not locked until the resolution criteria are checked; both markets stay in the
+                # prediction sweep, where they are sized and booked on their model probability
+                logger.info(f"[ARBITRAGE] Unverified match: {p['title']} ({p['id']}|{k['id']}) combined cost: "
+                            f"${(poly_down + kalshi_yes):.2f}; not traded as arbitrage.")
+                return None
+            logger.info(f"[ARBITRAGE] Found Match: {p['title']} combined cost: ${(poly_down + kalshi_yes):.2f}")
+            return {
+                "poly_leg": p["id"],
+                "kalshi_leg": k["id"],
+                "title": p["title"],
+                "legs": [
+                    {"venue": "kalshi", "market_id": k["id"], "side": "yes", "price": kalshi_yes},
+                    # DOWN is the "no" side of the first outcome token
+                    {"venue": "polymarket", "market_id": p.get("token_id") or p["id"], "side": "no", "price": poly_down},
+                ],
+            }
+        return None
+
+    @staticmethod
+    def execution_legs(arb):
+        """
+        Uniform {"venue", "market_id", "side", "price"} legs (probabilities) for the
+        paired executor, from a cross-venue pair, a Polymarket basket or a Kalshi ladder trade.
+        """
+        if "legs" not in arb:
+            return []
+        if "event_ticker" in arb:
+            return [{"venue": "kalshi", "market_id": l["ticker"], "side": l["side"], "price": l["price"] / 100}
+                    for l in arb["legs"]]
+        if "event_id" in arb:
+            return [{"venue": "polymarket", "market_id": l["token_id"], "side": "yes", "price": l["limit_price"]}
+                    for l in arb["legs"]]
+        return [dict(l) for l in arb["legs"]]
 
     async def scan_overlapping_strikes(self):
         """
         Scans Polymarket and Kalshi for overlapping strike prices matching our Arbitrage Thesis.
-        If we buy Kalshi 'YES' and Polymarket 'DOWN' and the total cost < $1.00, it's risk-free.
+        If we buy Kalshi 'YES' and Polymarket 'DOWN' and the total cost < $1.00, it's risk-free,
+        provided both resolve on the same event: only verified pairs are returned.
         """
         logger.info("[ARBITRAGE] Starting cross-platform options overlap scan...")
         
-        # We fetch active markets on both platforms to search for overlapping "Yes" and "Down" options.
+        # We read active markets on both platforms to search for overlapping "Yes" and "Down" options.
         try:
-            poly_markets = self.poly.fetch_markets(limit=20)
-            kalshi_markets = self.kalshi.fetch_markets(limit=20)
+            poly_markets, kalshi_markets = await asyncio.gather(
+                self.market_data.anormalized("polymarket"), self.market_data.anormalized("kalshi")
+            )
+            # Polymarket rows are per outcome; the first outcome is the YES side the DOWN leg is priced from
+            poly_markets = [p for p in poly_markets if p.get("outcome_index", 0) == 0]
             
-            # Simple matching logic on string similarity
-            for p in poly_markets:
-                for k in kalshi_markets:
-                    p_title = getattr(p, "title", "")
-                    k_title = getattr(k, "title", "")
-                    
-                    if p_title and k_title and p_title.lower()[:15] == k_title.lower()[:15]:
-                        # Handle UnifiedMarket price attributes
-                        poly_price = getattr(p, "price", 0.50)
-                        kalshi_price = getattr(k, "yes_ask", 0.50)
-                        
-                        if (poly_price + kalshi_price) < self.max_cost:
-                            logger.info(f"[ARBITRAGE] Found Match: {p_title} combined cost: ${(poly_price + kalshi_price):.2f}")
-                            return {"poly_leg": getattr(p, "id", ""), "kalshi_leg": getattr(k, "ticker", "")}
+            # Pairs matched in earlier sweeps (or before a restart) are priced first, without the O(n*m) title scan
+            poly_by_id = {p["id"]: p for p in poly_markets}
+            kalshi_by_ticker = {k["id"]: k for k in kalshi_markets}
+            for pair_key in list(self.pairs):
+                p_id, _, k_ticker = pair_key.partition("|")
+                if p_id in poly_by_id and k_ticker in kalshi_by_ticker:
+                    arb = self._check_pair(poly_by_id[p_id], kalshi_by_ticker[k_ticker])
+                    if arb:
+                        return arb
+            
+            # Title matching is an index join over both sweeps; it runs in the compute pool when there is one
+            left = [(p["id"], p["title"]) for p in poly_markets]
+            right = [(k["id"], k["title"]) for k in kalshi_markets]
+            compute = self.market_data.compute
+            matches = await compute.run(match_titles, left, right) if compute else match_titles(left, right)
+            for p_id, k_ticker in matches:
+                p = poly_by_id[p_id]
+                self.pairs[f"{p_id}|{k_ticker}"] = p["title"]
+                arb = self._check_pair(p, kalshi_by_ticker[k_ticker])
+                if arb:
+                    return arb
                             
         except Exception as e:
             logger.error(f"[ARBITRAGE] API Error fetching overlapping orders: {e}")
@@ -43,8 +121,56 @@ class ArbitrageScanner:
         logger.info("[ARBITRAGE] No $1.00 Arbitrage overlaps detected in current sweep.")
         return None
 
+    async def scan_baskets(self):
+        """
+        Prices every multi-outcome Polymarket event as a YES basket and a NO basket
+        from live CLOB asks. Books whose hash didn't change since the last sweep
+        don't mark their event dirty, so unchanged events are not re-evaluated.
+        """
+        logger.info("[ARBITRAGE] Starting Polymarket basket scan...")
+        try:
+            # The sweep payload; load_universe keeps only events whose member set is complete
+            events = await self.market_data.araw("polymarket")
+            n_events = self.basket_engine.load_universe(OutcomeTable.from_events(events))
+            if not n_events:
+                return []
+            client = self.market_data.scanner.aggregator.poly
+            books = await asyncio.to_thread(client.get_books, list(self.basket_engine.token_event))
+            changed = self.basket_engine.on_clob_books(books)
+            logger.info(f"[ARBITRAGE] {n_events} negRisk events, {changed} changed book(s).")
+            return self.basket_engine.evaluate()
+        except Exception as e:
+            logger.error(f"[ARBITRAGE] Basket scan failed: {e}")
+            return []
+
+    async def scan_strike_ladders(self):
+        """
+        Checks every Kalshi strike ladder in the sweep from snapshot quotes, then
+        pulls the orderbooks of the legs involved so the trades come back sized
+        from real depth (or disappear if the snapshot was stale).
+        """
+        logger.info("[ARBITRAGE] Starting Kalshi strike-ladder scan...")
+        try:
+            markets = await self.market_data.araw("kalshi")
+            ladders, ranges = self.ladder_scanner.load_markets(markets)
+            if not ladders:
+                return []
+            suspects = {leg["ticker"] for t in self.ladder_scanner.check() for leg in t["legs"]}
+            if not suspects:
+                return []
+            client = self.market_data.scanner.aggregator.kalshi
+            books = await asyncio.gather(*(asyncio.to_thread(client.get_orderbook, t) for t in suspects))
+            for ticker, book in zip(suspects, books):
+                self.ladder_scanner.on_orderbook(ticker, book)
+            logger.info(f"[ARBITRAGE] {ladders} ladders / {ranges} ranges, {len(suspects)} leg(s) re-checked against orderbooks.")
+            return [t for t in self.ladder_scanner.scan() if t["confirmed"]]
+        except Exception as e:
+            logger.error(f"[ARBITRAGE] Strike-ladder scan failed: {e}")
+            return []
+
 if __name__ == "__main__":
     from dotenv import load_dotenv
     load_dotenv()
     scanner = ArbitrageScanner()
+    scanner.market_data.new_sweep()
     asyncio.run(scanner.scan_overlapping_strikes())
@@ -0,0 +1,235 @@
+import re
+import math
+import numpy as np
+from src.utils import logger
+
+class BasketArbEngine:
+    """
+    Intra-venue arbitrage on Polymarket mutually exclusive (negRisk) events.
+
+    Exactly one market of such an event resolves YES, so:
+      YES basket: one YES share of every market pays $1
+      NO basket:  one NO share of every market pays $(n - 1)
+    Either basket is free money when it can be bought from the asks for less than
+    its payout after fees. Books are pushed in with `on_book`; only events with
+    a changed book are re-evaluated. The top-of-book screen runs vectorized over
+    every dirty event, and only the survivors get the full depth walk.
+    """
+    def __init__(self, fee_rate_bps=0.0, min_edge=0.005, max_basket_usd=500.0):
+        # Polymarket taker fee: rate * min(p, 1 - p) per share (most markets are currently 0 bps)
+        self.FEE_RATE = fee_rate_bps / 10000.0
+        self.MIN_EDGE = min_edge              # Required profit per basket unit, covers gas + slippage
+        self.MAX_BASKET_USD = max_basket_usd  # Cost cap per emitted trade
+        self.MIN_PRICE_SUM = 0.95             # Member YES prices below this total suggest a missing outcome
+
+        self.events = {}       # event_id -> {"title", "yes": [token...], "no": [token...], "markets": [market_id...]}
+        self.token_event = {}  # token_id -> event_id
+        self.asks = {}         # token_id -> (prices asc, sizes) numpy arrays
+        self.hashes = {}       # token_id -> CLOB book hash, to drop unchanged snapshots
+        self.dirty = set()
+
+    # Members whose outcome isn't a fixed, named result: an event holding one isn't a closed set
+    PLACEHOLDER = re.compile(r"^(other|person|candidate|player|team|option|company)(\s+[a-z0-9]{1,2})?$", re.I)
+
+    def load_universe(self, table):
+        """
+        Registers negRisk events whose member markets are known to be exhaustive. The
+        table comes from the sweep, which Gamma filters by event volume and end date,
+        so an event is only trusted when every member it lists can be accounted for:
+          - augmented negRisk events, and events with an "Other" or placeholder member,
+            can still gain outcomes and are skipped
+          - a closed member that resolved NO is dropped; any other closed member means
+            the event is decided, and an inactive one can't be bought, so both skip it
+          - every remaining member needs both tokens, and their YES prices must sum to
+            roughly 1; a shortfall means a member is missing from the payload
+        """
+        members, tokens, yes_price, neg_risk = {}, {}, {}, set()
+        for m, e in enumerate(table.market_event.tolist()):
+            members.setdefault(e, []).append(m)
+        for i in range(len(table)):
+            e, m, k = int(table.event_idx[i]), int(table.market_idx[i]), int(table.outcome_index[i])
+            if table.neg_risk[i]:
+                neg_risk.add(e)
+            tokens.setdefault(m, {})[k] = table.token_id[i]
+            if k == 0:
+                yes_price[m] = float(table.price[i])
+
+        events = {}
+        for e in sorted(neg_risk):
+            if table.event_augmented[e]:
+                continue
+            live = []
+            for m in members[e]:
+                label = table.market_label[m] or table.question[m]
+                if self.PLACEHOLDER.match(label.strip()):
+                    break
+                if table.market_closed[m]:
+                    if yes_price.get(m) == 0.0:
+                        continue
+                    break
+                if not table.market_active[m] or not tokens.get(m, {}).get(0) or not tokens[m].get(1):
+                    break
+                live.append(m)
+            else:
+                if len(live) >= 2 and sum(yes_price[m] for m in live) >= self.MIN_PRICE_SUM:
+                    events[table.event_id[e]] = {
+                        "title": table.event_title[e],
+                        "markets": [table.market_id[m] for m in live],
+                        "yes": [tokens[m][0] for m in live],
+                        "no": [tokens[m][1] for m in live],
+                    }
+
+        for event_id, event in events.items():
+            if self.events.get(event_id) != event:
+                self.dirty.add(event_id)
+        self.events = events
+        self.token_event = {t: eid for eid, ev in events.items() for t in ev["yes"] + ev["no"]}
+        return len(events)
+
+    def on_book(self, token_id, asks, book_hash=None):
+        """Replaces one token's ask ladder. `asks` is an iterable of (price, size) or CLOB {"price", "size"} levels."""
+        event_id = self.token_event.get(token_id)
+        if event_id is None or (book_hash is not None and self.hashes.get(token_id) == book_hash):
+            return False
+        levels = [(float(l["price"]), float(l["size"])) if isinstance(l, dict) else (float(l[0]), float(l[1])) for l in asks]
+        levels = sorted(l for l in levels if l[1] > 0)
+        self.asks[token_id] = (np.array([p for p, _ in levels]), np.array([s for _, s in levels]))
+        self.hashes[token_id] = book_hash
+        self.dirty.add(event_id)
+        return True
+
+    def on_clob_books(self, books):
+        """Feeds a PolymarketClient.get_books() response. Returns how many books actually changed."""
+        return sum(self.on_book(b.get("asset_id"), b.get("asks", []), b.get("hash")) for b in books if b)
+
+    def _fee(self, price):
+        return self.FEE_RATE * np.minimum(price, 1.0 - price)
+
+    def _screen(self, event_ids):
+        """Top-of-book basket costs for many events at once; returns the (event_id, side) pairs worth a depth walk."""
+        baskets, tokens = [], []
+        for eid in event_ids:
+            ev = self.events[eid]
+            n = len(ev["yes"])
+            baskets += [(eid, "YES", 1.0), (eid, "NO", float(n - 1))]
+            tokens += [ev["yes"], ev["no"]]
+        if not baskets:
+            return []
+
+        lengths = np.array([len(t) for t in tokens])
+        best = np.array([self.asks[t][0][0] if t in self.asks and len(self.asks[t][0]) else np.inf
+                         for leg in tokens for t in leg])
+        unit = best + self._fee(np.where(np.isfinite(best), best, 0.0))
+        cost = np.add.reduceat(unit, np.concatenate([[0], np.cumsum(lengths)[:-1]]))
+        payout = np.array([b[2] for b in baskets])
+        hits = np.flatnonzero(cost + self.MIN_EDGE < payout)
+        return [baskets[i] for i in hits]
+
+    def _walk(self, event_id, side, payout):
+        """Largest profitable basket size given full depth on every leg, capped at MAX_BASKET_USD."""
+        ev = self.events[event_id]
+        legs = ev["yes"] if side == "YES" else ev["no"]
+        ladders = [self.asks[t] for t in legs]
+        cums = [np.cumsum(sizes) for _, sizes in ladders]
+
+        # Basket cost is piecewise constant in quantity; breakpoints are where any leg exhausts a level
+        depth = min(c[-1] for c in cums)
+        breaks = np.unique(np.concatenate(cums))
+        breaks = breaks[breaks <= depth]
+        starts = np.concatenate([[0.0], breaks[:-1]])
+        level = [np.searchsorted(c, starts, side="right") for c in cums]
+        leg_price = np.stack([prices[lv] for (prices, _), lv in zip(ladders, level)])   # legs x segments
+        unit_cost = (leg_price + self._fee(leg_price)).sum(axis=0)
+
+        # Marginal cost only rises with depth, so the profitable segments are a prefix
+        ok = unit_cost + self.MIN_EDGE < payout
+        n_seg = int(np.argmin(ok)) if not ok.all() else len(ok)
+        if n_seg == 0:
+            return None
+        widths = (breaks - starts)[:n_seg]
+        seg_cost = unit_cost[:n_seg] * widths
+        spent = np.cumsum(seg_cost)
+
+        if spent[-1] > self.MAX_BASKET_USD:
+            j = int(np.searchsorted(spent, self.MAX_BASKET_USD))
+            before = spent[j - 1] if j else 0.0
+            size = starts[j] + (self.MAX_BASKET_USD - before) / unit_cost[j]
+            n_seg = j + 1
+        else:
+            size = breaks[n_seg - 1]
+        size = math.floor(size * 100) / 100   # CLOB sizes have two decimals
+        if size <= 0:
+            return None
+
+        fills = [min(size, b) - s for s, b in zip(starts[:n_seg], breaks[:n_seg]) if min(size, b) > s]
+        last = len(fills) - 1
+        cost = float(np.dot(unit_cost[:len(fills)], fills))
+        fees = float(np.dot(self._fee(leg_price[:, :len(fills)]).sum(axis=0), fills))
+        return {
+            "event_id": event_id,
+            "title": ev["title"],
+            "side": side,
+            "size": size,
+            "cost": round(cost, 4),
+            "fees": round(fees, 4),
+            "payout": round(payout * size, 4),
+            "profit": round(payout * size - cost, 4),
+            # Worst level each leg trades through; a limit there fills the whole basket size
+            "legs": [{"token_id": t, "market_id": m, "limit_price": float(leg_price[i, last]), "size": size}
+                     for i, (t, m) in enumerate(zip(legs, ev["markets"]))],
+        }
+
+    def evaluate(self, full=False):
+        """Re-checks dirty events (or every event) and returns sized basket trades, most profitable first."""
+        targets = list(self.events) if full else [e for e in self.dirty if e in self.events]
+        self.dirty.clear()
+        trades = []
+        for event_id, side, payout in self._screen(targets):
+            trade = self._walk(event_id, side, payout)
+            if trade:
+                trades.append(trade)
+        trades.sort(key=lambda t: t["profit"], reverse=True)
+        for t in trades:
+            logger.info(f"[ARBITRAGE] {t['side']} basket on '{t['title']}': {t['size']} x {len(t['legs'])} legs, "
+                        f"cost ${t['cost']:.2f} -> payout ${t['payout']:.2f}")
+        return trades
+
+if __name__ == "__main__":
+    # Full evaluation vs. the incremental path after a handful of book updates.
+    import time
+    import random
+    from src.outcomes import OutcomeTable
+
+    rnd = random.Random(5)
+    n_events, n_markets = 2000, 12
+    events = []
+    for e in range(n_events):
+        markets = [{"id": f"{e}-{m}", "question": f"Q{m}", "outcomes": '["Yes", "No"]', "outcomePrices": '["0.08", "0.92"]',
+                    "clobTokenIds": f'["y{e}-{m}", "n{e}-{m}"]', "volume": 1000, "endDate": "2026-11-01T00:00:00Z"}
+                   for m in range(n_markets)]
+        events.append({"id": str(e), "title": f"Event {e}", "negRisk": True, "markets": markets})
+
+    engine = BasketArbEngine(fee_rate_bps=0, max_basket_usd=1000)
+    print(f"{engine.load_universe(OutcomeTable.from_events(events))} negRisk events loaded")
+
+    def ladder(fair):
+        return [(round(min(fair + 0.01 * (k + 1), 0.99), 2), rnd.randint(50, 500)) for k in range(10)]
+
+    for e in range(n_events):
+        fair = [rnd.random() for _ in range(n_markets)]
+        total = sum(fair)
+        skew = 0.82 if e % 500 == 0 else 1.03   # a few mispriced events
+        for m in range(n_markets):
+            p = fair[m] / total * skew
+            engine.on_book(f"y{e}-{m}", ladder(p))
+            engine.on_book(f"n{e}-{m}", ladder(1 - p))
+
+    start = time.perf_counter()
+    trades = engine.evaluate(full=True)
+    print(f"full pass: {(time.perf_counter() - start) * 1000:.1f} ms, {len(trades)} basket(s)")
+
+    for e in rnd.sample(range(n_events), 20):
+        engine.on_book(f"y{e}-0", ladder(rnd.random() * 0.1))
+    start = time.perf_counter()
+    trades = engine.evaluate()
+    print(f"incremental pass (20 dirty events): {(time.perf_counter() - start) * 1000:.2f} ms, {len(trades)} basket(s)")
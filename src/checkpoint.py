@@ -0,0 +1,83 @@
+import os
+import json
+import time
+import sqlite3
+from datetime import datetime
+from src.utils import logger
+from src.api.decoding import to_builtins
+
+def _encode(obj):
+    if isinstance(obj, datetime):
+        return {"__dt__": obj.isoformat()}
+    builtin = to_builtins(obj)   # Typed market rows from the API decoders
+    return str(obj) if builtin is obj else builtin
+
+def _decode(d):
+    if "__dt__" in d and len(d) == 1:
+        return datetime.fromisoformat(d["__dt__"])
+    return d
+
+class CheckpointStore:
+    """
+    Durable key/value store for everything the worker would otherwise rebuild from
+    scratch after a restart: market snapshots, arbitrage pairs, LLM results,
+    portfolio state and the progress of the sweep in flight. Values are JSON in a
+    single SQLite file under data/, namespaced and timestamped so callers can apply
+    their own freshness rules on load.
+    """
+    def __init__(self, db_path="data/checkpoint.db"):
+        self.db_path = db_path
+        os.makedirs(os.path.dirname(self.db_path) or ".", exist_ok=True)
+        self._conn = sqlite3.connect(self.db_path, timeout=10.0, check_same_thread=False)
+        try:
+            self._conn.execute("PRAGMA journal_mode=WAL")
+            self._conn.execute("PRAGMA synchronous=NORMAL")
+            self._conn.execute('''
+                CREATE TABLE IF NOT EXISTS kv (
+                    namespace TEXT NOT NULL,
+                    key TEXT NOT NULL,
+                    value TEXT NOT NULL,
+                    updated_at REAL NOT NULL,
+                    PRIMARY KEY (namespace, key)
+                )
+            ''')
+            self._conn.commit()
+        except Exception as e:
+            logger.error(f"Failed to initialize checkpoint store: {e}")
+
+    def put(self, namespace, key, value):
+        self.put_many(namespace, {key: value})
+
+    def put_many(self, namespace, items):
+        now = time.time()
+        rows = [(namespace, str(k), json.dumps(v, default=_encode), now) for k, v in items.items()]
+        try:
+            with self._conn:
+                self._conn.executemany(
+                    "INSERT OR REPLACE INTO kv (namespace, key, value, updated_at) VALUES (?, ?, ?, ?)", rows
+                )
+        except Exception as e:
+            logger.error(f"Checkpoint write to {namespace} failed: {e}")
+
+    def get(self, namespace, key, max_age=None, default=None):
+        row = self._conn.execute(
+            "SELECT value, updated_at FROM kv WHERE namespace = ? AND key = ?", (namespace, str(key))
+        ).fetchone()
+        if not row or (max_age is not None and time.time() - row[1] > max_age):
+            return default
+        return json.loads(row[0], object_hook=_decode)
+
+    def items(self, namespace, max_age=None):
+        cutoff = time.time() - max_age if max_age is not None else 0
+        rows = self._conn.execute(
+            "SELECT key, value FROM kv WHERE namespace = ? AND updated_at >= ?", (namespace, cutoff)
+        )
+        return {k: json.loads(v, object_hook=_decode) for k, v in rows}
+
+    def delete(self, namespace, key):
+        with self._conn:
+            self._conn.execute("DELETE FROM kv WHERE namespace = ? AND key = ?", (namespace, str(key)))
+
+    def prune(self, namespace, max_age):
+        with self._conn:
+            self._conn.execute("DELETE FROM kv WHERE namespace = ? AND updated_at < ?", (namespace, time.time() - max_age))
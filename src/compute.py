@@ -0,0 +1,212 @@
+import os
+import time
+import asyncio
+import multiprocessing as mp
+from collections import deque
+from concurrent.futures import ProcessPoolExecutor
+from src.utils import logger
+
+class SharedArray:
+    """
+    A numpy array living in multiprocessing.shared_memory. Jobs receive only the
+    small `descriptor` tuple and attach to the same pages, so large inputs (price
+    grids, position vectors) cross the process boundary without being pickled.
+    """
+    def __init__(self, shape, dtype="float64"):
+        import numpy as np
+        from multiprocessing import shared_memory
+        dtype = np.dtype(dtype)
+        nbytes = max(int(np.prod(shape)) * dtype.itemsize, 1)
+        self.shm = shared_memory.SharedMemory(create=True, size=nbytes)
+        self.array = np.ndarray(shape, dtype=dtype, buffer=self.shm.buf)
+        self.descriptor = (self.shm.name, tuple(shape), dtype.str)
+
+    @classmethod
+    def from_array(cls, values, dtype="float64"):
+        import numpy as np
+        values = np.asarray(values, dtype=dtype)
+        shared = cls(values.shape, values.dtype)
+        shared.array[...] = values
+        return shared
+
+    @staticmethod
+    def attach(descriptor):
+        """Worker side: returns (shm, array). Close the shm when done; never unlink it."""
+        import numpy as np
+        from multiprocessing import shared_memory
+        name, shape, dtype = descriptor
+        shm = shared_memory.SharedMemory(name=name)
+        return shm, np.ndarray(shape, dtype=np.dtype(dtype), buffer=shm.buf)
+
+    def close(self):
+        del self.array
+        self.shm.close()
+        self.shm.unlink()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+class ComputeExecutor:
+    """
+    Shared process pool for CPU-bound kernels called from the asyncio pipeline.
+    At most `max_workers` jobs are handed to the pool at once; the rest wait on a
+    semaphore in the event loop, which keeps them cancellable (a job already
+    running in a worker cannot be interrupted, only abandoned) and makes queue
+    depth observable.
+    """
+    def __init__(self, max_workers=None, history=1024):
+        self.max_workers = max_workers or os.cpu_count() or 1
+        self._pool = None
+        self._slots = None
+        self._run_times = deque(maxlen=history)
+
+        self.queued = 0
+        self.running = 0
+        self.completed = 0
+        self.failed = 0
+        self.cancelled = 0
+
+    def _ensure_started(self):
+        if self._pool is None:
+            self._pool = ProcessPoolExecutor(max_workers=self.max_workers, mp_context=mp.get_context("spawn"))
+            self._slots = asyncio.Semaphore(self.max_workers)
+
+    async def run(self, fn, *args):
+        """Runs fn(*args) in the pool. fn must be a picklable module-level function."""
+        self._ensure_started()
+        self.queued += 1
+        try:
+            await self._slots.acquire()
+        except asyncio.CancelledError:
+            self.cancelled += 1
+            raise
+        finally:
+            self.queued -= 1
+
+        self.running += 1
+        start = time.perf_counter()
+        future = self._pool.submit(fn, *args)
+        try:
+            result = await asyncio.wrap_future(future)
+            self.completed += 1
+            return result
+        except asyncio.CancelledError:
+            future.cancel()
+            self.cancelled += 1
+            raise
+        except Exception:
+            self.failed += 1
+            raise
+        finally:
+            self._run_times.append(time.perf_counter() - start)
+            self.running -= 1
+            self._slots.release()
+
+    def submit(self, fn, *args):
+        """Fire-and-track variant: returns an asyncio.Task that can be cancelled."""
+        return asyncio.ensure_future(self.run(fn, *args))
+
+    def metrics(self):
+        times = sorted(self._run_times)
+
+        def pct(q):
+            return times[min(int(q * len(times)), len(times) - 1)] * 1000 if times else 0.0
+
+        return {
+            "workers": self.max_workers,
+            "queue_depth": self.queued,
+            "running": self.running,
+            "completed": self.completed,
+            "failed": self.failed,
+            "cancelled": self.cancelled,
+            "p50_ms": round(pct(0.50), 2),
+            "p95_ms": round(pct(0.95), 2),
+            "max_ms": round(times[-1] * 1000, 2) if times else 0.0,
+        }
+
+    def shutdown(self):
+        if self._pool:
+            self._pool.shutdown(wait=False, cancel_futures=True)
+            self._pool = None
+            logger.info(f"Compute executor shut down: {self.metrics()}")
+
+# --- CPU-bound kernels (module-level so the spawned workers can import them) ---
+
+def normalize_batch(platform, raw_items, min_volume, max_expiry_days):
+    """Normalize + filter one venue's raw markets off the event loop."""
+    from src.scanner import MarketScanner
+    scanner = MarketScanner()
+    scanner.MIN_VOLUME = min_volume
+    scanner.MAX_EXPIRY_DAYS = max_expiry_days
+    candidates = scanner.filter_candidates(platform, raw_items)
+    for c in candidates:
+        c.pop("raw_data", None)   # Already held by the parent; don't pickle it back
+    return candidates
+
+def match_titles(left, right, prefix=15):
+    """Pairs (id, title) rows whose lower-cased titles share the first `prefix` characters."""
+    index = {}
+    for rid, title in right:
+        if title:
+            index.setdefault(title.lower()[:prefix], []).append(rid)
+    return [(lid, rid) for lid, title in left if title for rid in index.get(title.lower()[:prefix], ())]
+
+def monte_carlo_var(positions_desc, n_sims=100_000, confidence=0.95, seed=None):
+    """
+    Portfolio VaR for binary positions. positions_desc is a SharedArray descriptor
+    of an (n, 3) array of [stake_usd, entry_price, win_probability]. Each position
+    wins stake * (1 - p) / p or loses its stake; outcomes are drawn independently.
+    Returns the loss (positive USD) not exceeded with the given confidence.
+    """
+    import numpy as np
+    shm, positions = SharedArray.attach(positions_desc)
+    try:
+        if len(positions) == 0:
+            return 0.0
+        stake, price, prob = positions[:, 0], positions[:, 1], positions[:, 2]
+        rng = np.random.default_rng(seed)
+        wins = rng.random((n_sims, len(positions))) < prob
+        pnl = np.where(wins, stake * (1.0 - price) / price, -stake).sum(axis=1)
+        return float(max(-np.quantile(pnl, 1.0 - confidence), 0.0))
+    finally:
+        del positions
+        shm.close()
+
+if __name__ == "__main__":
+    # Event-loop responsiveness with VaR jobs offloaded vs. run inline.
+    import numpy as np
+
+    async def heartbeat_lag(duration):
+        worst, end = 0.0, time.perf_counter() + duration
+        while time.perf_counter() < end:
+            t = time.perf_counter()
+            await asyncio.sleep(0.01)
+            worst = max(worst, time.perf_counter() - t - 0.01)
+        return worst * 1000
+
+    async def main():
+        rng = np.random.default_rng(1)
+        book = np.column_stack([rng.uniform(50, 500, 15), rng.uniform(0.2, 0.8, 15), rng.uniform(0.2, 0.9, 15)])
+        executor = ComputeExecutor()
+        with SharedArray.from_array(book) as shared:
+            await executor.run(monte_carlo_var, shared.descriptor, 1000)   # warm the pool
+
+            lag = asyncio.ensure_future(heartbeat_lag(1.5))
+            start = time.perf_counter()
+            results = await asyncio.gather(*[executor.run(monte_carlo_var, shared.descriptor, 200_000, 0.95, i) for i in range(16)])
+            offloaded = time.perf_counter() - start
+            print(f"offloaded: 16 VaR jobs in {offloaded:.2f}s, worst loop lag {await lag:.1f}ms, VaR95 ~${np.mean(results):.0f}")
+
+            lag = asyncio.ensure_future(heartbeat_lag(0.1))
+            await asyncio.sleep(0)
+            start = time.perf_counter()
+            for i in range(4):
+                monte_carlo_var(shared.descriptor, 200_000, 0.95, i)
+            print(f"inline:    4 VaR jobs in {time.perf_counter() - start:.2f}s, worst loop lag {await lag:.1f}ms")
+            print(executor.metrics())
+        executor.shutdown()
+
+    asyncio.run(main())
@@ -0,0 +1,8 @@
+from src.execution.orders import Order, InvalidTransition, PENDING, OPEN, PARTIAL, FILLED, CANCELLED, REJECTED
+from src.execution.venues import VenueAdapter, VenueError, KalshiVenue, PolymarketVenue, LocalVenue
+from src.execution.engine import ExecutionEngine
+from src.execution.paired import PairedExecutor
+from src.execution.fill_model import FillEstimator, FillEstimate, TradeFlow
+from src.execution.slicing import SliceScheduler, ParentOrder, TWAP, ICEBERG
+from src.execution.pegging import PegManager, PeggedOrder
+from src.execution.market_maker import MarketMaker
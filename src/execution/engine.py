@@ -0,0 +1,325 @@
+import math
+import time
+import asyncio
+from collections import deque
+from src.utils import logger
+from src.execution.orders import Order, REJECTED, CANCELLED, FILLED
+from src.api.ratelimit import ORDER
+
+class ExecutionEngine:
+    """
+    Turns an approved trade into a limit order and sees it through. The limit is
+    the worst ask level needed to fill the requested size; if that is more than
+    MAX_SLIPPAGE above the reference price the order is rejected before it is
+    sent (PRD: abort if slippage > 2%). Sent orders are polled until filled or
+    FILL_TIMEOUT, then the remainder is cancelled.
+    """
+    def __init__(self, venues, max_slippage=0.02, fill_timeout=30.0, poll_interval=0.5, history=1024):
+        self.venues = {v.name: v for v in venues}
+        self.MAX_SLIPPAGE = max_slippage
+        self.FILL_TIMEOUT = fill_timeout
+        self.POLL_INTERVAL = poll_interval
+        # Kalshi trades whole contracts; Polymarket shares have two decimals
+        self.SIZE_STEP = {"kalshi": 1.0, "polymarket": 0.01}
+
+        self.orders = {}                 # client_order_id -> Order, for everything still working
+        self._ack_times = deque(maxlen=history)
+        self._fill_times = deque(maxlen=history)
+        self.sent = 0
+        self.filled = 0
+        self.cancelled = 0
+        self.rejected = 0
+
+    @staticmethod
+    def limit_price(book, size, action="buy"):
+        """(limit, fillable, vwap): the worst level needed for `size` (asks to buy, bids to sell), and what the book can give."""
+        left, cost, limit = size, 0.0, None
+        for price, qty in book.get("asks" if action == "buy" else "bids", []):
+            if left <= 0:
+                break
+            take = min(qty, left)
+            cost += take * price
+            left -= take
+            limit = price
+        fillable = size - max(left, 0.0)
+        return limit, fillable, (cost / fillable if fillable else None)
+
+    def _round_size(self, venue, size):
+        step = self.SIZE_STEP.get(venue, 1.0)
+        return math.floor(size / step + 1e-9) * step
+
+    def _reject(self, order, reason):
+        order.transition(REJECTED, reason)
+        self.rejected += 1
+        logger.warning(f"[EXEC] {order.venue} {order.market_id} rejected: {reason}")
+        return order
+
+    async def _prepare(self, venue, market_id, side="yes", notional_usd=None, size=None, reference_price=None,
+                       action="buy", max_slippage=None, priority=ORDER):
+        """Prices an order off the current book. Returns it PENDING and ready to send, or REJECTED."""
+        adapter = self.venues[venue]
+        order = Order(venue=venue, market_id=market_id, side=side, price=0.0, size=size or 0.0, action=action,
+                      priority=priority)
+        max_slippage = self.MAX_SLIPPAGE if max_slippage is None else max_slippage
+        try:
+            book = await adapter.get_book(market_id, side)
+        except Exception as e:
+            return self._reject(order, f"book unavailable: {e}")
+        levels = book.get("asks" if action == "buy" else "bids")
+        if not levels:
+            return self._reject(order, f"no {'asks' if action == 'buy' else 'bids'} on the book")
+
+        best = levels[0][0]
+        reference = reference_price or best
+        if size is None:
+            # Size off the best price, then re-size at the limit the walk actually needs
+            size = self._round_size(venue, notional_usd / best)
+            if size > 0:
+                limit, _, _ = self.limit_price(book, size, action)
+                size = self._round_size(venue, notional_usd / limit)
+        order.size = size
+        if size <= 0:
+            return self._reject(order, "size rounds to zero")
+
+        limit, fillable, _ = self.limit_price(book, size, action)
+        order.price = limit
+        # Adverse move relative to the reference: paying up to buy, giving in to sell
+        slippage = (limit - reference if action == "buy" else reference - limit) / reference if reference else 0.0
+        if slippage > max_slippage + 1e-9:
+            return self._reject(order, f"slippage {slippage:.2%} > {max_slippage:.0%} (ref {reference:.3f}, limit {limit:.3f})")
+        if fillable < size:
+            logger.info(f"[EXEC] {market_id}: only {fillable:g}/{size:g} visible up to {limit:.3f}; remainder will rest.")
+        return order
+
+    def _sent(self, order):
+        self.orders[order.client_order_id] = order
+        order.sent_at = time.perf_counter()
+        self.sent += 1
+
+    def _placed(self, order, report):
+        """Applies a placement result; an exception in place of the report rejects the order."""
+        if isinstance(report, Exception):
+            self.orders.pop(order.client_order_id, None)
+            self._reject(order, f"venue error: {report}")
+        else:
+            self._apply(order, report)
+
+    async def execute(self, venue, market_id, side="yes", notional_usd=None, size=None, reference_price=None,
+                      action="buy", max_slippage=None, fill_timeout=None, priority=ORDER):
+        """
+        Buys (or sells) `size` contracts, or as many as `notional_usd` affords, of
+        `side` on `market_id`. Callers working a hedge can loosen the slippage band
+        and shorten the fill timeout per order; arbitrage passes a higher rate-limit
+        priority. Returns the Order in its final state.
+        """
+        order = await self._prepare(venue, market_id, side, notional_usd, size, reference_price, action, max_slippage,
+                                    priority)
+        if order.is_done:
+            return order
+        self._sent(order)
+        try:
+            report = await self.venues[venue].place(order)
+        except Exception as e:
+            report = e
+        self._placed(order, report)
+        if order.state != REJECTED:
+            await self._await_fill(order, self.FILL_TIMEOUT if fill_timeout is None else fill_timeout)
+        return order
+
+    async def execute_many(self, requests, fill_timeout=None):
+        """
+        Same as `execute` for a list of requests (dicts of its keyword arguments), but
+        orders for one venue go out in that venue's batch call instead of one round
+        trip each. Returns the Orders in request order, in their final state.
+        """
+        orders = list(await asyncio.gather(*(self._prepare(**req) for req in requests)))
+        by_venue = {}
+        for order in orders:
+            if not order.is_done:
+                by_venue.setdefault(order.venue, []).append(order)
+
+        async def send(venue, batch):
+            for order in batch:
+                self._sent(order)
+            try:
+                reports = await self.venues[venue].place_batch(batch)
+            except Exception as e:
+                reports = [e] * len(batch)
+            for order, report in zip(batch, reports):
+                self._placed(order, report)
+
+        await asyncio.gather(*(send(v, batch) for v, batch in by_venue.items()))
+        timeout = self.FILL_TIMEOUT if fill_timeout is None else fill_timeout
+        await asyncio.gather(*(self._await_fill(o, timeout) for o in orders if o.state != REJECTED))
+        return orders
+
+    async def place(self, venue, market_id, price, size, side="yes", action="buy", priority=ORDER):
+        """
+        Rests a limit order at exactly `price`, without the slippage guard or a fill
+        timeout, and returns it once the venue has answered. The caller owns it from
+        there: `poll`, `replace` and `cancel` it.
+        """
+        order = Order(venue=venue, market_id=market_id, side=side, price=price, size=size, action=action,
+                      priority=priority)
+        self._sent(order)
+        try:
+            report = await self.venues[venue].place(order)
+        except Exception as e:
+            report = e
+        self._placed(order, report)
+        return order
+
+    async def poll(self, order):
+        if not order.is_done:
+            try:
+                self._apply(order, await self.venues[order.venue].poll(order))
+            except Exception as e:
+                logger.error(f"[EXEC] poll failed for {order.client_order_id}: {e}")
+        return order
+
+    async def replace(self, order, price, reason="replaced"):
+        """Cancel/replace: pulls `order` and rests whatever it hadn't filled at `price`. None if nothing is left."""
+        await self.cancel(order, reason)
+        if not order.is_done:
+            return order    # Cancel failed; the old order is still working
+        left = order.size - order.filled
+        if left <= 1e-9:
+            return None
+        return await self.place(order.venue, order.market_id, price, left, order.side, order.action, order.priority)
+
+    def _apply(self, order, report):
+        if not report:
+            return
+        if report.get("venue_order_id"):
+            order.acknowledge(report["venue_order_id"])
+        order.apply_fill(report.get("filled", 0.0), report.get("avg_price", order.price))
+        if report.get("status") == CANCELLED and not order.is_done:
+            order.transition(CANCELLED, order.reason or "cancelled by venue")
+        if order.is_done:
+            self._finish(order)
+
+    def _finish(self, order):
+        if self.orders.pop(order.client_order_id, None) is None:
+            return
+        if order.ack_latency is not None:
+            self._ack_times.append(order.ack_latency)
+        if order.state == FILLED:
+            self.filled += 1
+            self._fill_times.append(order.fill_latency)
+        elif order.state == CANCELLED:
+            self.cancelled += 1
+        logger.info(f"[EXEC] {order.venue} {order.market_id} {order.state}: {order.filled:g}/{order.size:g} "
+                    f"@ {order.avg_price:.3f} (limit {order.price:.3f})")
+
+    async def _await_fill(self, order, timeout):
+        adapter = self.venues[order.venue]
+        deadline = time.perf_counter() + timeout
+        while not order.is_done and time.perf_counter() < deadline:
+            await asyncio.sleep(self.POLL_INTERVAL)
+            try:
+                self._apply(order, await adapter.poll(order))
+            except Exception as e:
+                logger.error(f"[EXEC] poll failed for {order.client_order_id}: {e}")
+        if not order.is_done:
+            await self.cancel(order, "fill timeout")
+
+    async def cancel(self, order, reason="cancelled"):
+        if order.is_done:
+            return order
+        order.reason = reason
+        try:
+            self._apply(order, await self.venues[order.venue].cancel(order))
+        except Exception as e:
+            logger.error(f"[EXEC] cancel failed for {order.client_order_id}: {e}")
+            return order
+        if not order.is_done:
+            order.transition(CANCELLED, reason)
+            self._finish(order)
+        return order
+
+    async def cancel_many(self, orders, reason="cancelled"):
+        """Cancels `orders` with one batch call per venue. Returns how many were still working."""
+        live = [o for o in orders if not o.is_done]
+        by_venue = {}
+        for order in live:
+            order.reason = reason
+            by_venue.setdefault(order.venue, []).append(order)
+
+        async def pull(venue, batch):
+            try:
+                reports = await self.venues[venue].cancel_batch(batch)
+            except Exception as e:
+                reports = [e] * len(batch)
+            for order, report in zip(batch, reports):
+                if isinstance(report, Exception):
+                    logger.error(f"[EXEC] cancel failed for {order.client_order_id}: {report}")
+                    continue
+                self._apply(order, report)
+                if not order.is_done:
+                    order.transition(CANCELLED, reason)
+                    self._finish(order)
+
+        await asyncio.gather(*(pull(v, batch) for v, batch in by_venue.items()))
+        return len(live)
+
+    async def cancel_all(self, reason="kill switch", venue=None, market_id=None):
+        """Mass cancel of everything this engine has working, optionally only on one venue and/or market."""
+        live = [o for o in self.orders.values()
+                if (venue is None or o.venue == venue) and (market_id is None or o.market_id == market_id)]
+        return await self.cancel_many(live, reason)
+
+    def metrics(self):
+        def pct(samples, q):
+            times = sorted(samples)
+            return round(times[min(int(q * len(times)), len(times) - 1)] * 1000, 2) if times else 0.0
+
+        return {
+            "sent": self.sent,
+            "working": len(self.orders),
+            "filled": self.filled,
+            "cancelled": self.cancelled,
+            "rejected": self.rejected,
+            "ack_p50_ms": pct(self._ack_times, 0.50),
+            "ack_p95_ms": pct(self._ack_times, 0.95),
+            "fill_p50_ms": pct(self._fill_times, 0.50),
+            "fill_p95_ms": pct(self._fill_times, 0.95),
+        }
+
+if __name__ == "__main__":
+    # Orders/sec against the local stand-in with a 20 ms round trip: one request per order vs batched
+    from src.execution.venues import LocalVenue
+
+    async def bench(n=200, rtt=0.02):
+        for mode in ("sequential", "batched"):
+            venue = LocalVenue(ack_latency=rtt)
+            engine = ExecutionEngine([venue], fill_timeout=5.0, poll_interval=0.01)
+            for i in range(n):
+                venue.set_book(f"M{i}", asks=[(0.50, 1)])
+            requests = [{"venue": "local", "market_id": f"M{i}", "size": 10, "reference_price": 0.50} for i in range(n)]
+
+            start = time.perf_counter()
+            if mode == "sequential":
+                tasks = []
+                for req in requests:
+                    tasks.append(asyncio.ensure_future(engine.execute(**req)))
+                    await asyncio.sleep(0)
+                    while venue.placed < len(tasks):
+                        await asyncio.sleep(0.001)
+            else:
+                tasks = [asyncio.ensure_future(engine.execute_many(requests))]
+                while venue.placed < n:
+                    await asyncio.sleep(0.001)
+            placed = time.perf_counter() - start
+
+            start = time.perf_counter()
+            if mode == "sequential":
+                for order in list(engine.orders.values()):
+                    await engine.cancel(order, "bench")
+            else:
+                await engine.cancel_all("bench")
+            cancelled = time.perf_counter() - start
+            await asyncio.gather(*tasks)
+            print(f"{mode:>10}: {n} orders in {placed * 1000:6.0f} ms ({n / placed:7.0f} orders/s), "
+                  f"cancel in {cancelled * 1000:5.0f} ms ({n / cancelled:7.0f} cancels/s), {venue.requests} requests")
+
+    asyncio.run(bench())
@@ -0,0 +1,260 @@
+import time
+import asyncio
+from collections import deque
+from src.utils import logger
+from src.execution.pegging import PegManager
+
+class MarketMaker:
+    """
+    Two-sided quoting around a fair value. Bids buy YES; offers are posted as
+    NO bids at 1 - ask, which Kalshi and the simulator match against YES bids
+    and which never needs inventory to sell. Both quotes are pegs: they join
+    one tick better than the best price on their side, capped at our quote,
+    so they earn the spread without paying more than fair - HALF_SPREAD.
+
+    The reservation price is skewed against inventory: at the per-market
+    limit it has moved a full HALF_SPREAD, so a long position is offered
+    cheaper and bid lower. A side that would grow exposure past the
+    per-market or global limit from RiskValidator.inventory_limits is
+    pulled. Fair value is the ensemble's p_model when `set_fair` provides
+    one, otherwise an EWMA of the book mid. Book, fair value and fill changes
+    requote at once; PegManager debounces the resulting replaces. `on_fill`
+    hands each booked fill to the owner, which logs it and marks the
+    inventory into its loss limits.
+    """
+    def __init__(self, engine, risk_validator, bankroll, pegs=None, half_spread=0.02, quote_size=10.0,
+                 mid_alpha=0.2, refresh=0.5):
+        self.engine = engine
+        self.pegs = pegs or PegManager(engine, min_interval=0.05, poll_interval=refresh)
+        self.pegs.on_update = self._on_update
+        self.pegs.on_fill = self._on_fill
+        self.HALF_SPREAD = half_spread
+        self.QUOTE_SIZE = quote_size
+        self.MID_ALPHA = mid_alpha          # EWMA weight of each new mid when fair value comes from the book
+        self.REFRESH = refresh              # Requote pass that re-posts filled or pulled quotes
+        self.risk_validator = risk_validator
+        self.set_bankroll(bankroll)
+
+        self.markets = {}                   # (venue, market_id) -> quoting state
+        self._task = None
+        self._requote_times = deque(maxlen=1024)
+        self.fills = 0
+        self.on_fill = None                 # (state, side, qty, price) after each fill is booked
+
+    def set_bankroll(self, bankroll):
+        self.PER_MARKET_USD, self.TOTAL_USD = self.risk_validator.inventory_limits(bankroll)
+
+    # Inventory
+
+    @staticmethod
+    def _exposure(state):
+        """USD at risk at fair value: long YES or long NO, whichever way the net position leans."""
+        q, fair = state["yes"] - state["no"], state["fair"]
+        return q * fair if q >= 0 else -q * (1 - fair)
+
+    def total_exposure(self):
+        return sum(self._exposure(s) for s in self.markets.values())
+
+    def pnl(self, state):
+        """Marked to fair value: YES pays 1 with probability fair, NO with 1 - fair."""
+        return state["yes"] * state["fair"] + state["no"] * (1 - state["fair"]) - state["cost"]
+
+    def total_pnl(self):
+        return sum(self.pnl(s) for s in self.markets.values())
+
+    def positions(self):
+        """Net inventory as [stake, price, p_win] rows at fair value, the layout monte_carlo_var takes."""
+        rows = []
+        for state in self.markets.values():
+            q, fair = state["yes"] - state["no"], state["fair"]
+            if q:
+                price = fair if q > 0 else 1 - fair
+                rows.append([abs(q) * price, price, price])
+        return rows
+
+    # Quotes
+
+    def quotes(self, state):
+        """(bid, ask, bid_ok, ask_ok) for the current fair value and inventory."""
+        fair, half = state["fair"], self.HALF_SPREAD
+        q = state["yes"] - state["no"]
+        exposure = self._exposure(state)
+        lean = (exposure if q >= 0 else -exposure) / self.PER_MARKET_USD if self.PER_MARKET_USD else 0.0
+        reservation = fair - max(min(lean, 1.0), -1.0) * half
+        bid, ask = round(reservation - half, 6), round(reservation + half, 6)
+        total = self.total_exposure()
+        size = self.QUOTE_SIZE
+        # Each side may always trade the position down; growing it must fit both limits
+        bid_ok = q < 0 or (exposure + size * fair <= self.PER_MARKET_USD and total + size * fair <= self.TOTAL_USD)
+        ask_ok = q > 0 or (exposure + size * (1 - fair) <= self.PER_MARKET_USD
+                           and total + size * (1 - fair) <= self.TOTAL_USD)
+        return bid, ask, bid_ok and 0 < bid < 1, ask_ok and 0 < ask < 1
+
+    def _requote(self, state):
+        started = time.perf_counter()
+        bid, ask, bid_ok, ask_ok = self.quotes(state)
+        for side, ok, cap in (("yes", bid_ok, bid), ("no", ask_ok, round(1 - ask, 6))):
+            peg = state["pegs"].get(side)
+            if peg is not None and peg.is_done:
+                state["pegs"].pop(side)
+                peg = None
+            if not ok:
+                if peg is not None:
+                    state["pegs"].pop(side)
+                    asyncio.create_task(self.pegs.cancel(peg, "inventory limit"))
+            elif peg is not None:
+                self.pegs.set_cap(peg, cap)
+            elif side not in state["posting"] and not state["stopped"]:
+                state["posting"].add(side)
+                asyncio.create_task(self._post(state, side, cap))
+        self._requote_times.append(time.perf_counter() - started)
+
+    async def _post(self, state, side, cap):
+        try:
+            tick = self.pegs._tick(state["venue"])
+            peg = await self.pegs.peg(state["venue"], state["market_id"], self.QUOTE_SIZE, action="buy", side=side,
+                                      peg="bid", offset=tick, cap=cap)
+            if state["stopped"]:
+                await self.pegs.cancel(peg, "market maker stopped")
+            elif not peg.is_done:
+                state["pegs"][side] = peg
+        except Exception as e:
+            logger.warning(f"[MM] {state['market_id']} {side} quote failed: {e}")
+        finally:
+            state["posting"].discard(side)
+        if not state["stopped"]:
+            # Fair value or inventory may have moved while the order was in flight
+            self._requote(state)
+
+    # Events
+
+    def _on_update(self, venue, market_id, side, book):
+        state = self.markets.get((venue, market_id))
+        if state is None:
+            return
+        bids, asks = book.get("bids"), book.get("asks")
+        if not bids or not asks:
+            return
+        mid = (bids[0][0] + asks[0][0]) / 2
+        state["mid"] = mid if side == "yes" else 1 - mid
+        if state["model"] is None:
+            state["fair"] += self.MID_ALPHA * (state["mid"] - state["fair"])
+        self._requote(state)
+
+    def _on_fill(self, peg, qty):
+        state = self.markets.get((peg.venue, peg.market_id))
+        if state is None:
+            return
+        # Cost of just this fill: the peg's running cost less what was booked before
+        cost = peg.avg_price * peg.filled
+        price = (cost - state["booked"].get(peg.peg_id, 0.0)) / qty
+        state["booked"][peg.peg_id] = cost
+        state[peg.side] += qty
+        state["cost"] += qty * price
+        self.fills += 1
+        logger.info(f"[MM] {peg.market_id} bought {qty:g} {peg.side.upper()} @ {price:.3f}; "
+                    f"net {state['yes'] - state['no']:+g}, exposure ${self._exposure(state):.2f}")
+        if self.on_fill:
+            self.on_fill(state, peg.side, qty, price)
+        self._requote(state)
+
+    def set_fair(self, venue, market_id, fair):
+        """Model fair value (e.g. the ensemble's p_model); replaces the book-mid estimate."""
+        state = self.markets.get((venue, market_id))
+        if state is None:
+            return
+        state["model"] = state["fair"] = fair
+        self._requote(state)
+
+    # Lifecycle
+
+    async def quote(self, venue, market_id, fair=None):
+        """Starts quoting a market. Without a fair value the book mid is used until `set_fair`."""
+        key = (venue, market_id)
+        if key in self.markets:
+            if fair is not None:
+                self.set_fair(venue, market_id, fair)
+            return self.markets[key]
+        book = await self.engine.venues[venue].get_book(market_id, "yes")
+        if not book.get("bids") or not book.get("asks"):
+            raise ValueError(f"{market_id} has no two-sided book to quote around")
+        mid = (book["bids"][0][0] + book["asks"][0][0]) / 2
+        state = self.markets[key] = {
+            "venue": venue, "market_id": market_id, "fair": fair if fair is not None else mid, "model": fair,
+            "mid": mid, "yes": 0.0, "no": 0.0, "cost": 0.0, "booked": {}, "pegs": {}, "posting": set(), "stopped": False,
+        }
+        logger.info(f"[MM] Quoting {market_id} around {state['fair']:.3f} +/- {self.HALF_SPREAD:.3f}")
+        self._requote(state)
+        if self._task is None or self._task.done():
+            self._task = asyncio.create_task(self._run())
+        return state
+
+    async def _run(self):
+        while any(not s["stopped"] for s in self.markets.values()):
+            await asyncio.sleep(self.REFRESH)
+            for state in self.markets.values():
+                if not state["stopped"]:
+                    self._requote(state)
+
+    async def stop(self, venue=None, market_id=None, reason="market maker stopped"):
+        """Pulls the quotes on one market (or all). Inventory stays as it is."""
+        pulled = 0
+        for (v, m), state in list(self.markets.items()):
+            if (venue is None or v == venue) and (market_id is None or m == market_id) and not state["stopped"]:
+                state["stopped"] = True
+                pegs = list(state["pegs"].values())
+                state["pegs"].clear()
+                await asyncio.gather(*(self.pegs.cancel(p, reason) for p in pegs))
+                pulled += len(pegs)
+        return pulled
+
+    async def settle(self, venue, market_id, yes_payout, no_payout):
+        """
+        The market resolved: pulls its quotes and drops it, inventory included. Returns
+        the realized P&L, each contract paid its side's payout less what the book cost.
+        """
+        state = self.markets.get((venue, market_id))
+        if state is None:
+            return 0.0
+        await self.stop(venue, market_id, "market resolved")
+        del self.markets[(venue, market_id)]
+        return state["yes"] * yes_payout + state["no"] * no_payout - state["cost"]
+
+    def metrics(self):
+        times = sorted(self._requote_times)
+        return {
+            "markets": sum(1 for s in self.markets.values() if not s["stopped"]),
+            "fills": self.fills,
+            "exposure_usd": round(self.total_exposure(), 2),
+            "pnl_usd": round(self.total_pnl(), 2),
+            "requote_p50_us": round(times[len(times) // 2] * 1e6, 1) if times else 0.0,
+            **self.pegs.metrics(),
+        }
+
+if __name__ == "__main__":
+    # Quotes 10 simulated Kalshi markets for 60 simulated seconds (20x real time) of book moves and Hawkes trades
+    from src.sim import SimVenue, MatchingEngine, MicrostructureSimulator, SimConfig
+    from src.execution.engine import ExecutionEngine
+    from skills.predict_market_bot.scripts.validate_risk import RiskValidator
+
+    async def main(steps=1200):
+        sim = MicrostructureSimulator(SimConfig(markets=10, polymarket_share=0.0, trade_rate=0.5, seed=4))
+        matcher = MatchingEngine("kalshi")
+        venue = SimVenue("kalshi", matcher=matcher, clock=lambda: sim.config.start + sim.t)
+        engine = ExecutionEngine([venue])
+        mm = MarketMaker(engine, RiskValidator(), 1000.0, half_spread=0.01, quote_size=5, refresh=0.05)
+        for event in sim.step():
+            matcher.on_event(event)
+        for market in sim.names:
+            await mm.quote("kalshi", market)
+        for _ in range(steps):
+            for event in sim.step():
+                matcher.on_event(event)
+                if event["type"] in ("book", "level"):
+                    for side in ("yes", "no"):
+                        mm.pegs.on_book("kalshi", event["market"], await venue.get_book(event["market"], side), side)
+            await asyncio.sleep(0.0025)
+        print(mm.metrics())
+        await mm.stop()
+
+    asyncio.run(main())
@@ -0,0 +1,101 @@
+import time
+import uuid
+from dataclasses import dataclass, field
+from typing import Optional
+from src.api.ratelimit import ORDER
+
+PENDING = "pending"       # Built locally, not yet acknowledged by the venue
+OPEN = "open"             # Resting on the book, nothing filled
+PARTIAL = "partial"       # Some size filled, remainder still working
+FILLED = "filled"
+CANCELLED = "cancelled"   # Pulled before completing; may carry a partial fill
+REJECTED = "rejected"     # Never reached the book (slippage guard, venue error)
+
+TERMINAL = (FILLED, CANCELLED, REJECTED)
+
+TRANSITIONS = {
+    PENDING: (OPEN, PARTIAL, FILLED, CANCELLED, REJECTED),
+    OPEN: (PARTIAL, FILLED, CANCELLED),
+    PARTIAL: (PARTIAL, FILLED, CANCELLED),
+    FILLED: (),
+    CANCELLED: (),
+    REJECTED: (),
+}
+
+class InvalidTransition(Exception):
+    pass
+
+@dataclass
+class Order:
+    """
+    One limit order and its lifecycle. Prices are probabilities (0-1) and sizes
+    are contracts/shares, whatever the venue's native units; adapters convert.
+    """
+    venue: str
+    market_id: str              # Kalshi ticker / Polymarket outcome token id
+    side: str                   # "yes" or "no"
+    price: float                # Limit price
+    size: float
+    action: str = "buy"
+    client_order_id: str = field(default_factory=lambda: uuid.uuid4().hex)
+    venue_order_id: Optional[str] = None
+    state: str = PENDING
+    filled: float = 0.0
+    avg_price: float = 0.0
+    reason: str = ""
+    priority: int = ORDER       # Rate-limiter class its requests are sent with
+
+    created_at: float = field(default_factory=time.perf_counter)
+    sent_at: Optional[float] = None
+    acked_at: Optional[float] = None
+    first_fill_at: Optional[float] = None
+    done_at: Optional[float] = None
+    history: list = field(default_factory=list)
+
+    @property
+    def remaining(self):
+        return max(self.size - self.filled, 0.0)
+
+    @property
+    def is_done(self):
+        return self.state in TERMINAL
+
+    @property
+    def ack_latency(self):
+        return self.acked_at - self.sent_at if self.acked_at and self.sent_at else None
+
+    @property
+    def fill_latency(self):
+        return self.done_at - self.sent_at if self.state == FILLED and self.sent_at else None
+
+    @property
+    def notional(self):
+        return self.filled * self.avg_price
+
+    def transition(self, state, reason=""):
+        if state == self.state and state != PARTIAL:
+            return
+        if state not in TRANSITIONS[self.state]:
+            raise InvalidTransition(f"{self.client_order_id}: {self.state} -> {state}")
+        now = time.perf_counter()
+        self.history.append((now, self.state, state))
+        self.state = state
+        if reason:
+            self.reason = reason
+        if state in TERMINAL:
+            self.done_at = now
+
+    def acknowledge(self, venue_order_id):
+        self.venue_order_id = venue_order_id
+        self.acked_at = self.acked_at or time.perf_counter()
+        if self.state == PENDING:
+            self.transition(OPEN)
+
+    def apply_fill(self, total_filled, avg_price):
+        """Applies the venue's cumulative fill report (idempotent for repeated reports)."""
+        if total_filled <= self.filled:
+            return
+        self.filled = min(total_filled, self.size)
+        self.avg_price = avg_price
+        self.first_fill_at = self.first_fill_at or time.perf_counter()
+        self.transition(FILLED if self.remaining <= 1e-9 else PARTIAL)
@@ -0,0 +1,144 @@
+import math
+import time
+import asyncio
+from collections import deque
+from src.utils import logger
+from src.api.ratelimit import ARBITRAGE
+
+class PairedExecutor:
+    """
+    Executes the legs of an arbitrage (usually two, Kalshi ladders can have three)
+    concurrently at pre-computed equal sizes. Whatever a leg fails to fill leaves
+    the other legs unhedged; the executor first chases the lagging legs up to
+    CHASE_LIMIT above their planned price, and if the position still isn't
+    balanced by HEDGE_TIMEOUT it sells the excess on the leading legs back out.
+
+    A leg is {"venue", "market_id", "side", "price", "size"}; prices are probabilities.
+    """
+    def __init__(self, engine, leg_timeout=1.0, hedge_timeout=5.0, chase_limit=0.02, unwind_slippage=0.10, history=1024):
+        self.engine = engine
+        self.LEG_TIMEOUT = leg_timeout          # How long each first-round leg may rest before it is cancelled
+        self.HEDGE_TIMEOUT = hedge_timeout      # Budget for chasing before we give up and unwind
+        self.CHASE_LIMIT = chase_limit          # Absolute price concession allowed on a lagging leg
+        self.UNWIND_SLIPPAGE = unwind_slippage  # Getting flat matters more than price
+
+        self._completion = deque(maxlen=history)  # Submit -> every leg done (hedged or unwound)
+        self._unhedged = deque(maxlen=history)    # First leg filled -> position balanced again
+        self.executed = 0
+        self.hedged = 0
+        self.chased = 0
+        self.unwound = 0
+        self.broken = 0                           # Unwind failed; exposure left open
+
+    @staticmethod
+    def size_legs(legs, budget_usd, step=1.0):
+        """Same contract count on every leg: as many full sets as `budget_usd` buys at the planned prices."""
+        per_set = sum(leg["price"] for leg in legs)
+        size = math.floor(budget_usd / per_set / step) * step if per_set > 0 else 0
+        return [dict(leg, size=size) for leg in legs]
+
+    async def _leg(self, leg, size, reference, max_slippage, action="buy", timeout=None):
+        return await self.engine.execute(
+            leg["venue"], leg["market_id"], side=leg["side"], size=size, reference_price=reference,
+            action=action, max_slippage=max_slippage, fill_timeout=self.LEG_TIMEOUT if timeout is None else timeout,
+            priority=ARBITRAGE,
+        )
+
+    async def execute(self, legs):
+        """Returns {"hedged": bool, "filled": [per-leg net size], "orders": [...], "completion_ms", "unhedged_ms"}."""
+        untradeable = {leg["venue"] for leg in legs if not getattr(self.engine.venues[leg["venue"]], "tradeable", True)}
+        if untradeable:
+            logger.warning(f"[EXEC] Pair skipped: {', '.join(sorted(untradeable))} can't take orders.")
+            return {"hedged": False, "filled": [0.0] * len(legs), "orders": [], "skipped": True}
+
+        self.executed += 1
+        start = time.perf_counter()
+        # Legs on the same venue share one batch request
+        orders = await self.engine.execute_many([
+            {"venue": leg["venue"], "market_id": leg["market_id"], "side": leg["side"], "size": leg["size"],
+             "reference_price": leg["price"], "priority": ARBITRAGE} for leg in legs
+        ], fill_timeout=self.LEG_TIMEOUT)
+        filled = [o.filled for o in orders]
+        done = [o.done_at or time.perf_counter() for o in orders]
+        first_fill = min((o.first_fill_at for o in orders if o.first_fill_at), default=None)
+
+        deadline = start + self.HEDGE_TIMEOUT
+        chased = False
+        # Chase: lift the lagging legs toward the leader while the clock and price allow
+        while len(set(filled)) > 1 and time.perf_counter() < deadline:
+            target = max(filled)
+            laggards = [i for i, f in enumerate(filled) if f < target]
+            chased = True
+            chase = await asyncio.gather(*(
+                self._leg(legs[i], target - filled[i], legs[i]["price"], self.CHASE_LIMIT / legs[i]["price"],
+                          timeout=max(min(self.LEG_TIMEOUT, deadline - time.perf_counter()), 0.0))
+                for i in laggards
+            ))
+            progress = False
+            for i, order in zip(laggards, chase):
+                orders.append(order)
+                if order.filled:
+                    filled[i] += order.filled
+                    done[i] = order.done_at or time.perf_counter()
+                    progress = True
+            if not progress:
+                break   # Book moved beyond the chase limit; waiting won't help
+        if chased:
+            self.chased += 1
+
+        # Unwind: sell the excess on the leaders so every leg holds the hedged minimum
+        if len(set(filled)) > 1:
+            floor = min(filled)
+            leaders = [i for i, f in enumerate(filled) if f > floor]
+            unwind = await asyncio.gather(*(
+                self._leg(legs[i], filled[i] - floor, legs[i]["price"], self.UNWIND_SLIPPAGE, action="sell",
+                          timeout=self.LEG_TIMEOUT)
+                for i in leaders
+            ))
+            self.unwound += 1
+            for i, order in zip(leaders, unwind):
+                orders.append(order)
+                filled[i] -= order.filled
+                done[i] = order.done_at or time.perf_counter()
+
+        hedged = len(set(filled)) == 1
+        finished = time.perf_counter()
+        if not hedged:
+            self.broken += 1
+            logger.critical(f"[EXEC] Unhedged exposure left after unwind: {list(zip((l['market_id'] for l in legs), filled))}")
+        elif filled[0] > 0:
+            self.hedged += 1
+
+        completion = max(done) - start
+        self._completion.append(completion)
+        unhedged = None
+        if first_fill is not None:
+            unhedged = (max(done) if hedged else finished) - first_fill
+            self._unhedged.append(max(unhedged, 0.0))
+        logger.info(f"[EXEC] Pair {'hedged' if hedged else 'BROKEN'} at {min(filled):g} sets; legs done in "
+                    f"{completion * 1000:.0f} ms, unhedged for {(unhedged or 0) * 1000:.0f} ms.")
+        return {
+            "hedged": hedged,
+            "filled": filled,
+            "orders": orders,
+            "completion_ms": round(completion * 1000, 2),
+            "unhedged_ms": round((unhedged or 0.0) * 1000, 2),
+        }
+
+    def metrics(self):
+        def pct(samples, q):
+            times = sorted(samples)
+            return round(times[min(int(q * len(times)), len(times) - 1)] * 1000, 2) if times else 0.0
+
+        return {
+            "pairs": self.executed,
+            "hedged": self.hedged,
+            "chased": self.chased,
+            "unwound": self.unwound,
+            "broken": self.broken,
+            "completion_p50_ms": pct(self._completion, 0.50),
+            "completion_p95_ms": pct(self._completion, 0.95),
+            "unhedged_p50_ms": pct(self._unhedged, 0.50),
+            "unhedged_p95_ms": pct(self._unhedged, 0.95),
+            "unhedged_max_ms": pct(self._unhedged, 1.0),
+        }
@@ -0,0 +1,307 @@
+import math
+import time
+import asyncio
+import uuid
+from collections import deque
+from dataclasses import dataclass, field
+from typing import Optional
+from src.utils import logger
+from src.api.ratelimit import ORDER
+
+@dataclass
+class PeggedOrder:
+    """
+    A resting order kept at the best bid ("bid") or best ask ("ask") plus
+    `offset`, never past `cap` (buys never above it, sells never below it) and
+    never crossing the opposite side. Prices are probabilities on `side`.
+    """
+    venue: str
+    market_id: str
+    side: str
+    action: str
+    size: float
+    peg: str
+    offset: float
+    cap: Optional[float]
+    threshold: float
+    peg_id: str = field(default_factory=lambda: uuid.uuid4().hex)
+    state: str = "working"          # working / filled / cancelled
+    order: object = None            # The engine Order currently resting
+    done_filled: float = 0.0        # Filled by orders already replaced or finished
+    done_cost: float = 0.0
+    replaces: int = 0
+    book: Optional[dict] = None     # Latest book seen
+    book_at: float = 0.0            # perf_counter() of the latest book
+    pending_since: Optional[float] = None   # First book update not yet acted on
+    last_replace: float = 0.0
+    busy: bool = False
+    reported: float = 0.0           # Fills already passed to the on_fill hook
+
+    @property
+    def filled(self):
+        return self.done_filled + (self.order.filled if self.order else 0.0)
+
+    @property
+    def avg_price(self):
+        cost = self.done_cost + (self.order.filled * self.order.avg_price if self.order else 0.0)
+        return cost / self.filled if self.filled else 0.0
+
+    @property
+    def is_done(self):
+        return self.state != "working"
+
+class PegManager:
+    """
+    Keeps pegged orders priced off the book with cancel/replace. Book updates
+    come in through `on_book` (a WebSocket consumer, the simulator, anything
+    that has them); markets that haven't had one within STALE_AFTER are polled
+    instead. A move of at least `threshold` triggers a replace, but never more
+    than one per MIN_INTERVAL per order: updates arriving inside that window
+    are coalesced and the latest book is used when it ends. The time from the
+    first unhandled book update to the replace going out is recorded per replace.
+    """
+    def __init__(self, engine, min_interval=0.25, poll_interval=0.5, stale_after=1.0, tick=None, history=1024):
+        self.engine = engine
+        self.MIN_INTERVAL = min_interval     # Debounce: at most one replace per order per interval
+        self.POLL_INTERVAL = poll_interval   # Fill polling, and the pass that refreshes stale books
+        self.STALE_AFTER = stale_after       # Poll the book when no update arrived for this long
+        self.TICK = tick or {"kalshi": 0.01, "polymarket": 0.001}
+
+        self.pegs = {}                       # peg_id -> PeggedOrder
+        self._by_market = {}                 # (venue, market_id, side) -> {peg_id}
+        self._task = None
+        self._latency = deque(maxlen=history)       # Book update -> replace sent, debounce included
+        self._undebounced = deque(maxlen=history)   # Same, for replaces that didn't have to wait
+        self.updates = 0
+        self.replaced = 0
+        self.debounced = 0
+        # Optional hooks: on_update(venue, market_id, side, book) sees every book before pegs reprice,
+        # on_fill(peg, qty) every new fill
+        self.on_update = None
+        self.on_fill = None
+
+    def _tick(self, venue):
+        return self.TICK.get(venue, 0.01)
+
+    def _target(self, peg, book):
+        """Price the peg wants on this book, or None when the reference side is empty."""
+        tick = self._tick(peg.venue)
+        ref = book.get("bids" if peg.peg == "bid" else "asks")
+        if not ref:
+            return None
+        price = ref[0][0] + peg.offset
+        buying = peg.action == "buy"
+        if peg.cap is not None:
+            price = min(price, peg.cap) if buying else max(price, peg.cap)
+        # Stay passive: a buy must sit below the best ask, a sell above the best bid
+        other = book.get("asks" if buying else "bids")
+        if other:
+            price = min(price, other[0][0] - tick) if buying else max(price, other[0][0] + tick)
+        price = (math.floor if buying else math.ceil)(round(price / tick, 6)) * tick
+        return round(min(max(price, tick), 1 - tick), 6)
+
+    async def peg(self, venue, market_id, size, action="buy", side="yes", peg=None, offset=0.0, cap=None,
+                  threshold=None, priority=ORDER):
+        """Places a pegged order off the current book; returns the PeggedOrder (not waiting for fills)."""
+        peg = PeggedOrder(venue, market_id, side, action, size, peg or ("bid" if action == "buy" else "ask"),
+                          offset, cap, threshold or self._tick(venue))
+        peg.book = await self.engine.venues[venue].get_book(market_id, side)
+        peg.book_at = time.perf_counter()
+        price = self._target(peg, peg.book)
+        if price is None:
+            raise ValueError(f"no {peg.peg}s to peg {market_id} to")
+        peg.order = await self.engine.place(venue, market_id, price, size, side, action, priority)
+        peg.last_replace = time.perf_counter()
+        if peg.order.is_done and not peg.order.filled:
+            peg.state = "cancelled"
+            logger.warning(f"[PEG] {market_id} not placed: {peg.order.reason}")
+            return peg
+        self.pegs[peg.peg_id] = peg
+        self._by_market.setdefault((venue, market_id, side), set()).add(peg.peg_id)
+        if self._task is None or self._task.done():
+            self._task = asyncio.create_task(self._watch())
+        self._check_fills(peg)
+        return peg
+
+    def on_book(self, venue, market_id, book, side="yes", received=None):
+        """Book update for (venue, market_id, side), in the venue adapters' normalized shape."""
+        received = received or time.perf_counter()
+        self.updates += 1
+        if self.on_update:
+            self.on_update(venue, market_id, side, book)
+        for pid in list(self._by_market.get((venue, market_id, side), ())):
+            peg = self.pegs.get(pid)
+            if peg is None:
+                continue
+            peg.book, peg.book_at = book, received
+            self._kick(peg, received)
+
+    def set_cap(self, peg, cap):
+        """Moves the cap (e.g. a new fair value); the order reprices like on a book update."""
+        if peg.is_done or cap == peg.cap:
+            return
+        peg.cap = cap
+        self._kick(peg, time.perf_counter())
+
+    def _kick(self, peg, received):
+        if peg.pending_since is None:
+            peg.pending_since = received
+        if not peg.busy:
+            peg.busy = True
+            asyncio.create_task(self._reprice(peg))
+
+    def _check_fills(self, peg):
+        qty = peg.filled - peg.reported
+        if qty > 1e-9:
+            peg.reported += qty
+            if self.on_fill:
+                self.on_fill(peg, qty)
+
+    async def _reprice(self, peg):
+        waited = False
+        try:
+            while peg.pending_since is not None and not peg.is_done:
+                target = self._target(peg, peg.book)
+                current = peg.order.price if peg.order else None
+                if target is None or (current is not None and abs(target - current) < peg.threshold - 1e-9):
+                    peg.pending_since = None
+                    break
+                wait = peg.last_replace + self.MIN_INTERVAL - time.perf_counter()
+                if wait > 0:
+                    # Rate-limit friendly: later updates in this window fold into one replace
+                    self.debounced += 1
+                    waited = True
+                    await asyncio.sleep(wait)
+                    continue
+                latency = time.perf_counter() - peg.pending_since
+                self._latency.append(latency)
+                if not waited:
+                    self._undebounced.append(latency)
+                peg.pending_since = None
+                await self._replace(peg, target)
+        except Exception as e:
+            logger.error(f"[PEG] reprice failed for {peg.market_id}: {e}")
+        finally:
+            peg.busy = False
+
+    async def _replace(self, peg, price):
+        old = peg.order
+        peg.last_replace = time.perf_counter()
+        if old is None:
+            new = await self.engine.place(peg.venue, peg.market_id, price, peg.size - peg.filled, peg.side, peg.action)
+        else:
+            new = await self.engine.replace(old, price, reason="repriced")
+            if new is old:
+                return      # Cancel didn't go through; try again on the next update
+            peg.done_filled += old.filled
+            peg.done_cost += old.filled * old.avg_price
+        peg.order = new
+        self._check_fills(peg)
+        peg.replaces += 1
+        self.replaced += 1
+        if new is None or peg.filled >= peg.size - 1e-9:
+            self._finish(peg, "filled")
+        elif new.is_done and not new.filled:
+            logger.warning(f"[PEG] {peg.market_id} replace at {price:.3f} failed: {new.reason}")
+            self._finish(peg, "cancelled")
+
+    def _finish(self, peg, state):
+        peg.state = state
+        self.pegs.pop(peg.peg_id, None)
+        self._by_market.get((peg.venue, peg.market_id, peg.side), set()).discard(peg.peg_id)
+        logger.info(f"[PEG] {peg.market_id} {state}: {peg.filled:g}/{peg.size:g} @ {peg.avg_price:.3f} "
+                    f"after {peg.replaces} replaces")
+
+    async def _watch(self):
+        """Polls fills, and books for markets without a live update source."""
+        while self.pegs:
+            await asyncio.sleep(self.POLL_INTERVAL)
+            now = time.perf_counter()
+            pegs = [p for p in self.pegs.values() if not p.busy]
+            await asyncio.gather(*(self.engine.poll(p.order) for p in pegs if p.order))
+            for peg in pegs:
+                self._check_fills(peg)
+                if peg.order and peg.order.is_done and not peg.busy:
+                    if peg.filled >= peg.size - 1e-9:
+                        self._finish(peg, "filled")
+                    else:
+                        # Pulled by the venue or externally: rest what's left at the current target
+                        peg.done_filled += peg.order.filled
+                        peg.done_cost += peg.order.filled * peg.order.avg_price
+                        peg.order = None
+                        peg.pending_since = now
+            stale = {(p.venue, p.market_id, p.side) for p in self.pegs.values()
+                     if now - p.book_at > self.STALE_AFTER or p.order is None}
+            books = await asyncio.gather(*(self.engine.venues[v].get_book(m, s) for v, m, s in stale),
+                                         return_exceptions=True)
+            for (venue, market_id, side), book in zip(stale, books):
+                if isinstance(book, Exception):
+                    logger.warning(f"[PEG] book poll failed for {market_id}: {book}")
+                    continue
+                self.on_book(venue, market_id, book, side)
+
+    async def cancel(self, peg, reason="cancelled"):
+        if peg.is_done:
+            return peg
+        self._finish(peg, "cancelled")
+        if peg.order:
+            await self.engine.cancel(peg.order, reason)
+            self._check_fills(peg)
+        return peg
+
+    async def cancel_all(self, reason="kill switch"):
+        pegs = list(self.pegs.values())
+        for peg in pegs:
+            self._finish(peg, "cancelled")
+        await self.engine.cancel_many([p.order for p in pegs if p.order], reason)
+        for peg in pegs:
+            self._check_fills(peg)
+        return len(pegs)
+
+    def metrics(self):
+        def pct(samples, q):
+            times = sorted(samples)
+            return round(times[min(int(q * len(times)), len(times) - 1)] * 1000, 2) if times else 0.0
+
+        return {
+            "pegged": len(self.pegs),
+            "updates": self.updates,
+            "replaced": self.replaced,
+            "debounced": self.debounced,
+            "reaction_p50_ms": pct(self._latency, 0.50),
+            "reaction_p95_ms": pct(self._latency, 0.95),
+            "undebounced_p50_ms": pct(self._undebounced, 0.50),
+            "undebounced_p95_ms": pct(self._undebounced, 0.95),
+        }
+
+if __name__ == "__main__":
+    # 20 pegged bids on books that shift a tick every 10-200 ms; the venue answers in 2 ms
+    import random
+    from src.execution.venues import LocalVenue
+    from src.execution.engine import ExecutionEngine
+
+    async def main(n=20, seconds=5.0):
+        rng = random.Random(1)
+        venue = LocalVenue(ack_latency=0.002)
+        engine = ExecutionEngine([venue])
+        manager = PegManager(engine, min_interval=0.1)
+        mids = {f"M{i}": 50 for i in range(n)}
+        for m, mid in mids.items():
+            venue.set_book(m, bids=[(mid / 100, 100)], asks=[((mid + 2) / 100, 100)])
+        pegs = [await manager.peg("local", m, 10, offset=0.01, cap=0.60) for m in mids]
+
+        async def stream(market):
+            end = time.perf_counter() + seconds
+            while time.perf_counter() < end:
+                await asyncio.sleep(rng.uniform(0.01, 0.2))
+                mids[market] = min(max(mids[market] + rng.choice((-1, 1)), 30), 70)
+                venue.set_book(market, bids=[(mids[market] / 100, 100)], asks=[((mids[market] + 2) / 100, 100)])
+                manager.on_book("local", market, await venue.get_book(market, "yes"))
+
+        await asyncio.gather(*(stream(m) for m in mids))
+        await asyncio.sleep(0.2)
+        capped = sum(1 for p in pegs if p.order and p.order.price <= 0.60)
+        print(f"{manager.metrics()}; {venue.requests} venue requests; {capped}/{n} within the cap")
+        await manager.cancel_all("done")
+
+    asyncio.run(main())
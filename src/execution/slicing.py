@@ -0,0 +1,363 @@
+import math
+import time
+import heapq
+import asyncio
+import itertools
+import uuid
+from dataclasses import dataclass, field
+from typing import Optional
+from src.utils import logger
+from src.api.ratelimit import ORDER
+from src.execution.orders import REJECTED
+from src.execution.fill_model import FillEstimator
+
+TWAP = "twap"           # Equal slices at equal intervals over `duration`
+ICEBERG = "iceberg"     # Clips of at most `display`, sized to the depth visible within the band, sent as the book refills
+
+@dataclass
+class ParentOrder:
+    """
+    A large order worked as child orders. Children are limited to
+    `max_slippage` past the arrival price (the touch when the parent was
+    submitted), so the parent never pays more than one big order would have
+    been allowed to; slippage is measured against the same price.
+    """
+    venue: str
+    market_id: str
+    side: str
+    action: str
+    size: float
+    strategy: str
+    arrival_price: float
+    max_slippage: float
+    duration: float
+    slices: int = 10
+    display: Optional[float] = None
+    parent_id: str = field(default_factory=lambda: uuid.uuid4().hex)
+    state: str = "working"      # working / filled / expired / cancelled
+    reason: str = ""
+    filled: float = 0.0
+    cost: float = 0.0
+    working: float = 0.0        # Size in children not yet finished
+    sent_slices: int = 0
+    children: list = field(default_factory=list)
+    started_at: float = field(default_factory=time.perf_counter)
+    done_at: Optional[float] = None
+
+    @property
+    def remaining(self):
+        return max(self.size - self.filled, 0.0)
+
+    @property
+    def progress(self):
+        return self.filled / self.size if self.size else 0.0
+
+    @property
+    def avg_price(self):
+        return self.cost / self.filled if self.filled else 0.0
+
+    @property
+    def notional(self):
+        return self.cost
+
+    @property
+    def slippage(self):
+        """Adverse move of the average fill vs the arrival price (fraction)."""
+        if not self.filled or not self.arrival_price:
+            return 0.0
+        sign = 1 if self.action == "buy" else -1
+        return sign * (self.avg_price - self.arrival_price) / self.arrival_price
+
+    @property
+    def is_done(self):
+        return self.state != "working"
+
+class SliceScheduler:
+    """
+    Works parent orders as child orders through the ExecutionEngine. One
+    scheduler task on the event loop keeps a heap of when each parent next
+    needs attention; children that come due together go out in one
+    execute_many per venue. TWAP parents slice evenly over their duration,
+    each slice catching up on what earlier ones missed. Iceberg parents
+    send clips no larger than `display` and than the depth the book shows
+    within the band, then re-read the book every REFILL_INTERVAL until it
+    has refilled. Unfilled child remainders are cancelled and carried over.
+    """
+    def __init__(self, engine, estimator=None, refill_interval=0.25, min_tick=0.01):
+        self.engine = engine
+        self.estimator = estimator or FillEstimator()
+        self.REFILL_INTERVAL = refill_interval  # How often an iceberg re-reads a depleted book
+        self.MIN_TICK = min_tick                 # Scheduler sleeps at least this long between passes
+        self.CHILD_TIMEOUT_SHARE = 0.8           # TWAP children rest for this share of the slice interval
+        self.ICEBERG_CHILD_TIMEOUT = 1.0
+
+        self.parents = {}
+        self._due = []                   # (when, seq, parent_id)
+        self._seq = itertools.count()
+        self._task = None
+        self._wakeup = asyncio.Event()
+        self._waiters = {}               # parent_id -> asyncio.Event set when done
+        self.children_sent = 0
+        self.completed = []              # Finished parents, for metrics
+
+    def _step(self, venue):
+        return self.engine.SIZE_STEP.get(venue, 1.0)
+
+    def _round(self, venue, size):
+        step = self._step(venue)
+        return math.floor(size / step + 1e-9) * step
+
+    async def submit(self, venue, market_id, size=None, notional_usd=None, strategy=TWAP, side="yes", action="buy",
+                     duration=60.0, slices=10, display=None, reference_price=None, max_slippage=None, book=None):
+        """Starts working a parent order; returns it immediately (await `wait` for the outcome)."""
+        book = book or await self.engine.venues[venue].get_book(market_id, side)
+        levels = book.get("asks" if action == "buy" else "bids")
+        if not levels and not reference_price:
+            raise ValueError(f"no {'asks' if action == 'buy' else 'bids'} for {market_id}")
+        arrival = reference_price or levels[0][0]
+        if size is None:
+            size = self._round(venue, notional_usd / arrival)
+        parent = ParentOrder(venue, market_id, side, action, size, strategy, arrival,
+                             self.engine.MAX_SLIPPAGE if max_slippage is None else max_slippage,
+                             duration, slices, display)
+        self.parents[parent.parent_id] = parent
+        self._waiters[parent.parent_id] = asyncio.Event()
+        self._schedule(parent, time.perf_counter())
+        logger.info(f"[SLICE] {strategy} {action} {size:g} {market_id} @ arrival {arrival:.3f} over {duration:g}s")
+        if self._task is None or self._task.done():
+            self._task = asyncio.create_task(self._run())
+        return parent
+
+    async def wait(self, parent):
+        await self._waiters[parent.parent_id].wait()
+        return parent
+
+    async def execute(self, venue, market_id, notional_usd=None, size=None, side="yes", action="buy",
+                      reference_price=None, duration=30.0, max_slippage=None, **kwargs):
+        """
+        Drop-in for ExecutionEngine.execute: an order the best level covers goes out
+        as is; anything larger is worked as an iceberg (by default) and the finished
+        ParentOrder, which reports filled/avg_price/notional/state like an Order, is returned.
+        `max_slippage` bounds every child against the arrival price, like the single order.
+        """
+        try:
+            book = await self.engine.venues[venue].get_book(market_id, side)
+        except Exception:
+            book = None
+        levels = (book or {}).get("asks" if action == "buy" else "bids")
+        if levels:
+            wanted = size if size is not None else notional_usd / levels[0][0]
+            if wanted <= levels[0][1] + 1e-9:
+                return await self.engine.execute(venue, market_id, side=side, notional_usd=notional_usd, size=size,
+                                                 reference_price=reference_price, action=action,
+                                                 max_slippage=max_slippage)
+        else:
+            # Let the engine reject it with its usual reason
+            return await self.engine.execute(venue, market_id, side=side, notional_usd=notional_usd, size=size,
+                                             reference_price=reference_price, action=action, max_slippage=max_slippage)
+        kwargs.setdefault("strategy", ICEBERG)
+        parent = await self.submit(venue, market_id, size=size, notional_usd=notional_usd, side=side, action=action,
+                                   duration=duration, reference_price=reference_price, max_slippage=max_slippage,
+                                   book=book, **kwargs)
+        return await self.wait(parent)
+
+    async def cancel(self, parent, reason="cancelled"):
+        if parent.is_done:
+            return parent
+        self._finish(parent, "cancelled", reason)
+        working = [o for o in parent.children if not o.is_done]
+        if working:
+            await self.engine.cancel_many(working, reason)
+        return parent
+
+    def cancel_all(self, reason="kill switch"):
+        """Stops every parent from sending more children; children already out are the engine's to cancel."""
+        parents = list(self.parents.values())
+        for parent in parents:
+            self._finish(parent, "cancelled", reason)
+        return len(parents)
+
+    def _schedule(self, parent, when):
+        heapq.heappush(self._due, (when, next(self._seq), parent.parent_id))
+        self._wakeup.set()
+
+    def _finish(self, parent, state, reason=""):
+        if parent.is_done:
+            return
+        parent.state, parent.reason = state, reason
+        parent.done_at = time.perf_counter()
+        self.completed.append(parent)
+        self.parents.pop(parent.parent_id, None)
+        self._waiters[parent.parent_id].set()
+        logger.info(f"[SLICE] {parent.market_id} {state}: {parent.filled:g}/{parent.size:g} @ {parent.avg_price:.4f} "
+                    f"(arrival {parent.arrival_price:.3f}, slippage {parent.slippage:+.2%}, "
+                    f"{len(parent.children)} children, {parent.done_at - parent.started_at:.1f}s)")
+
+    def _deadline(self, parent):
+        return parent.started_at + parent.duration
+
+    def _child_size(self, parent, now, book=None):
+        """Size of the next child, or 0.0 to send nothing this time."""
+        open_size = parent.remaining - parent.working
+        if open_size <= 1e-9:
+            return 0.0
+        if parent.strategy == TWAP:
+            left = max(parent.slices - parent.sent_slices, 1)
+            size = open_size / left
+        else:
+            visible, _ = self.estimator.max_size(book, parent.action, parent.arrival_price, parent.max_slippage)
+            size = min(open_size, visible, parent.display or open_size)
+        size = self._round(parent.venue, size)
+        # Don't strand a sub-step remainder
+        if size <= 0 and parent.strategy == TWAP:
+            size = self._round(parent.venue, open_size)
+        return size if size <= open_size + 1e-9 else 0.0
+
+    async def _plan(self, parent, now):
+        """Decides what (if anything) this parent sends now and when to look at it next."""
+        if parent.is_done:
+            return None
+        deadline = self._deadline(parent)
+        if parent.strategy == TWAP:
+            interval = parent.duration / max(parent.slices, 1)
+            size = self._child_size(parent, now)
+            parent.sent_slices += 1
+            if parent.sent_slices < parent.slices:
+                self._schedule(parent, parent.started_at + parent.sent_slices * interval)
+            timeout = interval * self.CHILD_TIMEOUT_SHARE
+        else:
+            try:
+                book = await self.engine.venues[parent.venue].get_book(parent.market_id, parent.side)
+            except Exception as e:
+                logger.warning(f"[SLICE] book unavailable for {parent.market_id}: {e}")
+                book = {}
+            size = self._child_size(parent, now, book)
+            timeout = min(self.ICEBERG_CHILD_TIMEOUT, max(deadline - now, 0.05))
+            if size <= 0 and now < deadline and parent.working <= 1e-9:
+                # Depth gone: look again once the book has had time to refill
+                self._schedule(parent, now + self.REFILL_INTERVAL)
+        if size <= 0:
+            self._check_done(parent, now)
+            return None
+        parent.working += size
+        return parent, {"venue": parent.venue, "market_id": parent.market_id, "side": parent.side, "size": size,
+                        "reference_price": parent.arrival_price, "action": parent.action,
+                        "max_slippage": parent.max_slippage, "priority": ORDER}, timeout
+
+    def _check_done(self, parent, now):
+        if parent.is_done or parent.working > 1e-9:
+            return
+        if parent.remaining < self._step(parent.venue) - 1e-9:
+            self._finish(parent, "filled")
+        elif now >= self._deadline(parent) or (parent.strategy == TWAP and parent.sent_slices >= parent.slices):
+            self._finish(parent, "expired", f"{parent.remaining:g} unfilled at the deadline")
+
+    async def _send(self, plans, timeout):
+        orders = await self.engine.execute_many([req for _, req, _ in plans], fill_timeout=timeout)
+        now = time.perf_counter()
+        self.children_sent += len(orders)
+        for (parent, req, _), order in zip(plans, orders):
+            parent.working -= req["size"]
+            if order.state != REJECTED:
+                parent.children.append(order)
+            if order.filled:
+                parent.filled += order.filled
+                parent.cost += order.filled * order.avg_price
+            if parent.is_done:
+                continue
+            if parent.strategy == ICEBERG and now < self._deadline(parent):
+                # Next clip as soon as this one is done; a drained book waits for the refill
+                self._schedule(parent, now if order.filled else now + self.REFILL_INTERVAL)
+            self._check_done(parent, now)
+
+    async def _run(self):
+        sending = set()
+        while self.parents or sending:
+            now = time.perf_counter()
+            due = []
+            while self._due and self._due[0][0] <= now:
+                _, _, pid = heapq.heappop(self._due)
+                parent = self.parents.get(pid)
+                if parent is not None and parent not in due:
+                    due.append(parent)
+            if due:
+                plans = [p for p in await asyncio.gather(*(self._plan(p, now) for p in due)) if p]
+                by_timeout = {}
+                for plan in plans:
+                    by_timeout.setdefault(round(plan[2], 3), []).append(plan)
+                for timeout, group in by_timeout.items():
+                    task = asyncio.create_task(self._send(group, timeout))
+                    sending.add(task)
+                    task.add_done_callback(sending.discard)
+            # Parents nothing is scheduled for (expired icebergs, TWAPs past their last slice) close here
+            scheduled = {pid for _, _, pid in self._due}
+            for parent in list(self.parents.values()):
+                if parent.parent_id not in scheduled:
+                    self._check_done(parent, now)
+            wait = max(self._due[0][0] - time.perf_counter(), self.MIN_TICK) if self._due else 0.05
+            self._wakeup.clear()
+            try:
+                await asyncio.wait_for(self._wakeup.wait(), wait)
+            except asyncio.TimeoutError:
+                pass
+
+    def metrics(self):
+        done = self.completed
+        slippages = sorted(p.slippage for p in done if p.filled)
+        return {
+            "working": len(self.parents),
+            "done": len(done),
+            "filled": sum(1 for p in done if p.state == "filled"),
+            "children": self.children_sent,
+            "fill_ratio": round(sum(p.progress for p in done) / len(done), 4) if done else 0.0,
+            "slippage_mean_bps": round(sum(slippages) / len(slippages) * 1e4, 1) if slippages else 0.0,
+            "slippage_max_bps": round(slippages[-1] * 1e4, 1) if slippages else 0.0,
+        }
+
+if __name__ == "__main__":
+    # 40 parents, each 5x the touch, against a local book that refills at the touch every 200 ms.
+    # One block order per market vs iceberg clips vs TWAP.
+    from src.execution.venues import LocalVenue
+    from src.execution.engine import ExecutionEngine
+
+    def seed(venue, market):
+        venue.set_book(market, bids=[(0.49, 100)], asks=[(0.50, 60), (0.51, 60), (0.52, 200), (0.55, 500)])
+
+    async def refill(venue, markets, stop):
+        while not stop.is_set():
+            await asyncio.sleep(0.2)
+            for m in markets:
+                asks = venue.books[(m, "yes")]["asks"]
+                if not asks or asks[0][0] > 0.50:
+                    asks.insert(0, [0.50, 60])
+
+    async def bench(mode, n=40, size=300):
+        venue = LocalVenue(ack_latency=0.005)
+        engine = ExecutionEngine([venue], max_slippage=0.05, fill_timeout=0.5, poll_interval=0.01)
+        markets = [f"M{i}" for i in range(n)]
+        for m in markets:
+            seed(venue, m)
+        stop = asyncio.Event()
+        refiller = asyncio.create_task(refill(venue, markets, stop))
+        started = time.perf_counter()
+        if mode == "block":
+            orders = await asyncio.gather(*(engine.execute("local", m, size=size) for m in markets))
+            filled = sum(o.filled for o in orders)
+            slip = [(o.avg_price - 0.50) / 0.50 for o in orders if o.filled]
+        else:
+            scheduler = SliceScheduler(engine, refill_interval=0.1)
+            parents = [await scheduler.submit("local", m, size=size, strategy=mode, duration=4.0, slices=8,
+                                              display=60, max_slippage=0.02) for m in markets]
+            await asyncio.gather(*(scheduler.wait(p) for p in parents))
+            filled = sum(p.filled for p in parents)
+            slip = [p.slippage for p in parents if p.filled]
+        stop.set()
+        await refiller
+        print(f"{mode:>8}: filled {filled / (n * size):6.1%} in {time.perf_counter() - started:4.1f}s, "
+              f"mean slippage vs arrival {sum(slip) / len(slip) * 1e4:6.1f} bps, {venue.requests} requests")
+
+    async def main():
+        for mode in ("block", ICEBERG, TWAP):
+            await bench(mode)
+
+    asyncio.run(main())
@@ -0,0 +1,353 @@
+import asyncio
+import unittest
+from src.execution import (ExecutionEngine, PairedExecutor, LocalVenue, Order, InvalidTransition, FillEstimator,
+                           TradeFlow, SliceScheduler, TWAP, ICEBERG, PegManager, MarketMaker, PENDING, OPEN, PARTIAL, FILLED, CANCELLED, REJECTED)
+from src.sim import SimVenue, MatchingEngine
+from skills.predict_market_bot.scripts.validate_risk import RiskValidator
+
+class TestOrderStateMachine(unittest.TestCase):
+    def test_fill_path(self):
+        order = Order("local", "M", "yes", 0.50, 10)
+        self.assertEqual(order.state, PENDING)
+        order.sent_at = order.created_at
+        order.acknowledge("v1")
+        self.assertEqual(order.state, OPEN)
+        order.apply_fill(4, 0.50)
+        self.assertEqual(order.state, PARTIAL)
+        order.apply_fill(4, 0.50)            # Repeated cumulative report is a no-op
+        self.assertEqual(order.filled, 4)
+        order.apply_fill(10, 0.49)
+        self.assertEqual(order.state, FILLED)
+        self.assertIsNotNone(order.fill_latency)
+
+    def test_terminal_states_are_final(self):
+        order = Order("local", "M", "yes", 0.50, 10)
+        order.transition(REJECTED, "test")
+        with self.assertRaises(InvalidTransition):
+            order.transition(OPEN)
+        order = Order("local", "M", "yes", 0.50, 10)
+        order.acknowledge("v1")
+        with self.assertRaises(InvalidTransition):
+            order.transition(PENDING)
+
+class TestExecutionEngine(unittest.IsolatedAsyncioTestCase):
+    async def asyncSetUp(self):
+        self.venue = LocalVenue(ack_latency=0.002)
+        self.engine = ExecutionEngine([self.venue], fill_timeout=0.2, poll_interval=0.01)
+
+    async def test_limit_walks_the_book(self):
+        self.venue.set_book("M", asks=[(0.50, 60), (0.51, 100)])
+        order = await self.engine.execute("local", "M", size=100, reference_price=0.50)
+        self.assertEqual(order.state, FILLED)
+        self.assertAlmostEqual(order.price, 0.51)
+        self.assertAlmostEqual(order.avg_price, (60 * 0.50 + 40 * 0.51) / 100)
+        self.assertGreaterEqual(order.ack_latency, 0.002)
+
+    async def test_slippage_guard_aborts_before_sending(self):
+        self.venue.set_book("M", asks=[(0.50, 10), (0.53, 100)])
+        order = await self.engine.execute("local", "M", size=50, reference_price=0.50)
+        self.assertEqual(order.state, REJECTED)
+        self.assertIn("slippage", order.reason)
+        self.assertEqual(self.venue.placed, 0)
+
+    async def test_notional_sizing(self):
+        self.venue.set_book("M", asks=[(0.40, 1000)])
+        order = await self.engine.execute("local", "M", notional_usd=100.0, reference_price=0.40)
+        self.assertEqual(order.size, 250)
+        self.assertAlmostEqual(order.notional, 100.0)
+
+    async def test_notional_below_one_contract_rejects(self):
+        self.venue.set_book("M", asks=[(0.60, 1000)])
+        order = await self.engine.execute("local", "M", notional_usd=0.50, reference_price=0.60)
+        self.assertEqual(order.state, REJECTED)
+        self.assertIn("rounds to zero", order.reason)
+
+    async def test_partial_fill_then_timeout_cancel(self):
+        self.venue.set_book("M", asks=[(0.50, 30)])
+        order = await self.engine.execute("local", "M", size=100, reference_price=0.50)
+        self.assertEqual(order.state, CANCELLED)
+        self.assertEqual(order.filled, 30)
+        self.assertEqual(order.reason, "fill timeout")
+        self.assertEqual(self.engine.metrics()["working"], 0)
+
+    async def test_resting_order_fills_while_polled(self):
+        self.venue.set_book("M", asks=[(0.55, 5)])
+        task = asyncio.ensure_future(self.engine.execute("local", "M", size=20, reference_price=0.55))
+        await asyncio.sleep(0.03)
+        self.assertEqual(self.venue.orders["local-1"]["status"], PARTIAL)   # 5 lifted, 15 resting
+        self.assertEqual(self.venue.trade("M", "yes", 0.55, 50), 15)
+        order = await task
+        self.assertEqual(order.state, FILLED)
+        m = self.engine.metrics()
+        self.assertEqual(m["filled"], 1)
+        self.assertGreater(m["fill_p50_ms"], 0)
+
+    async def test_cancel_all(self):
+        self.engine.FILL_TIMEOUT = 5.0
+        self.venue.set_book("M", asks=[(0.50, 1)])
+        task = asyncio.ensure_future(self.engine.execute("local", "M", size=10, reference_price=0.50))
+        await asyncio.sleep(0.02)
+        self.assertEqual(await self.engine.cancel_all(), 1)
+        order = await task
+        self.assertEqual(order.state, CANCELLED)
+        self.assertEqual(order.reason, "kill switch")
+
+    async def test_execute_many_batches_per_venue(self):
+        for i in range(30):
+            self.venue.set_book(f"M{i}", asks=[(0.50, 10)])
+        requests = [{"venue": "local", "market_id": f"M{i}", "size": 10, "reference_price": 0.50} for i in range(30)]
+        requests.append({"venue": "local", "market_id": "UNKNOWN", "size": 1})
+        orders = await self.engine.execute_many(requests)
+        self.assertEqual([o.state for o in orders[:30]], [FILLED] * 30)
+        self.assertEqual(orders[30].state, REJECTED)
+        self.assertEqual(self.venue.requests, 2)           # 30 orders in batches of 20
+
+    async def test_mass_cancel_by_market_and_venue(self):
+        self.engine.FILL_TIMEOUT = 5.0
+        for m in ("M1", "M2"):
+            self.venue.set_book(m, asks=[(0.50, 1)])
+        tasks = [asyncio.ensure_future(self.engine.execute("local", m, size=10, reference_price=0.50))
+                 for m in ("M1", "M1", "M2")]
+        await asyncio.sleep(0.02)
+        self.assertEqual(await self.engine.cancel_all("market", market_id="M1"), 2)
+        self.assertEqual(await self.engine.cancel_all("venue", venue="local"), 1)
+        orders = await asyncio.gather(*tasks)
+        self.assertEqual([o.reason for o in orders], ["market", "market", "venue"])
+        self.assertEqual(self.engine.metrics()["working"], 0)
+
+    async def test_venue_error_rejects(self):
+        order = await self.engine.execute("local", "UNKNOWN", size=1)
+        self.assertEqual(order.state, REJECTED)
+
+class TestPairedExecutor(unittest.IsolatedAsyncioTestCase):
+    async def asyncSetUp(self):
+        self.a, self.b = LocalVenue(ack_latency=0.002, name="a"), LocalVenue(ack_latency=0.002, name="b")
+        self.engine = ExecutionEngine([self.a, self.b], poll_interval=0.01)
+        self.paired = PairedExecutor(self.engine, leg_timeout=0.05, hedge_timeout=0.2)
+        self.legs = PairedExecutor.size_legs([
+            {"venue": "a", "market_id": "K", "side": "yes", "price": 0.40},
+            {"venue": "b", "market_id": "P", "side": "no", "price": 0.55},
+        ], budget_usd=9.5)
+
+    async def test_both_legs_fill(self):
+        self.assertEqual([l["size"] for l in self.legs], [10, 10])
+        self.a.set_book("K", asks=[(0.40, 50)])
+        self.b.set_book("P", "no", asks=[(0.55, 50)])
+        result = await self.paired.execute(self.legs)
+        self.assertTrue(result["hedged"])
+        self.assertEqual(result["filled"], [10, 10])
+        self.assertEqual(self.paired.metrics()["hedged"], 1)
+        self.assertEqual(self.paired.chased, 0)
+
+    async def test_lagging_leg_is_chased(self):
+        self.a.set_book("K", asks=[(0.40, 50)])
+        self.b.set_book("P", "no", asks=[(0.55, 4), (0.56, 50)])   # 0.56 is 1.8% over plan but within the chase limit
+        self.engine.MAX_SLIPPAGE = 0.0
+        result = await self.paired.execute(self.legs)
+        self.assertTrue(result["hedged"])
+        self.assertEqual(result["filled"], [10, 10])
+        self.assertEqual(self.paired.chased, 1)
+        self.assertEqual(self.paired.unwound, 0)
+        self.assertGreater(result["unhedged_ms"], 0)
+
+    async def test_unhedgeable_leg_is_unwound(self):
+        self.a.set_book("K", bids=[(0.39, 50)], asks=[(0.40, 50)])
+        self.b.set_book("P", "no", asks=[(0.55, 3)])   # 3 lifted, 7 rest and time out, nothing left to chase
+        result = await self.paired.execute(self.legs)
+        self.assertTrue(result["hedged"])
+        self.assertEqual(result["filled"], [3, 3])
+        sells = [o for o in result["orders"] if o.action == "sell"]
+        self.assertEqual([o.filled for o in sells], [7])
+        m = self.paired.metrics()
+        self.assertEqual((m["chased"], m["unwound"], m["broken"]), (1, 1, 0))
+
+    async def test_untradeable_venue_skips_pair(self):
+        self.b.tradeable = False
+        result = await self.paired.execute(self.legs)
+        self.assertTrue(result["skipped"])
+        self.assertEqual(self.a.placed, 0)
+
+class TestSliceScheduler(unittest.IsolatedAsyncioTestCase):
+    def setUp(self):
+        self.venue = LocalVenue()
+        self.venue.set_book("M", bids=[(0.49, 100)], asks=[(0.50, 30), (0.51, 30), (0.60, 1000)])
+        self.engine = ExecutionEngine([self.venue], fill_timeout=0.2, poll_interval=0.01)
+        self.scheduler = SliceScheduler(self.engine, refill_interval=0.02)
+
+    async def test_iceberg_clips_follow_book_refills(self):
+        parent = await self.scheduler.submit("local", "M", size=100, strategy=ICEBERG, display=25, duration=2.0)
+
+        async def refill():
+            while not parent.is_done:
+                await asyncio.sleep(0.05)
+                asks = self.venue.books[("M", "yes")]["asks"]
+                if asks[0][0] > 0.50:
+                    asks.insert(0, [0.50, 30])
+
+        await asyncio.gather(self.scheduler.wait(parent), refill())
+        self.assertEqual((parent.state, parent.filled), ("filled", 100))
+        self.assertTrue(all(child.size <= 25 for child in parent.children))
+        # Never beyond the 2% band: the 0.60 level is never touched
+        self.assertLessEqual(max(child.price for child in parent.children), 0.51)
+        self.assertGreaterEqual(parent.slippage, 0.0)
+        self.assertLess(parent.slippage, 0.02)
+
+    async def test_twap_spreads_slices_and_expires_the_rest(self):
+        started = asyncio.get_running_loop().time()
+        parent = await self.scheduler.submit("local", "M", size=80, strategy=TWAP, slices=4, duration=0.4)
+        await self.scheduler.wait(parent)
+        # 60 visible within the band and no refills: the last slices find nothing
+        self.assertEqual((parent.state, parent.filled), ("expired", 60))
+        self.assertGreaterEqual(asyncio.get_running_loop().time() - started, 0.3)
+        self.assertEqual(self.scheduler.metrics()["done"], 1)
+
+    async def test_execute_works_a_size_beyond_the_touch_inside_a_tight_band(self):
+        # 90 wanted, 30 at the touch: sliced, and with a 1% band the 0.51 level is out of reach
+        parent = await self.scheduler.execute("local", "M", size=90, reference_price=0.50, max_slippage=0.01,
+                                              duration=0.3)
+        self.assertEqual((parent.state, parent.filled), ("expired", 30))
+        self.assertTrue(all(child.price <= 0.50 for child in parent.children))
+
+class TestPegManager(unittest.IsolatedAsyncioTestCase):
+    def setUp(self):
+        self.venue = LocalVenue()
+        self.venue.set_book("M", bids=[(0.40, 100)], asks=[(0.45, 100)])
+        self.engine = ExecutionEngine([self.venue])
+        self.manager = PegManager(self.engine, min_interval=0.05, poll_interval=0.02, stale_after=10.0)
+
+    def move(self, bid, ask):
+        self.venue.set_book("M", bids=[(bid, 100)], asks=[(ask, 100)])
+        self.manager.on_book("local", "M", {"bids": [(bid, 100)], "asks": [(ask, 100)]})
+
+    async def test_replaces_follow_the_book_within_cap_and_debounce(self):
+        peg = await self.manager.peg("local", "M", 10, offset=0.01, cap=0.44)
+        self.assertAlmostEqual(peg.order.price, 0.41)
+        # Burst of updates inside the debounce window after placing: one replace, at the latest book
+        self.move(0.41, 0.46)
+        await asyncio.sleep(0)
+        self.move(0.42, 0.46)
+        self.move(0.43, 0.47)
+        await asyncio.sleep(0.1)
+        self.assertAlmostEqual(peg.order.price, 0.44)
+        self.assertEqual(peg.replaces, 1)
+        # Cap holds however far the bid runs; never crosses the ask
+        self.move(0.50, 0.52)
+        await asyncio.sleep(0.1)
+        self.assertAlmostEqual(peg.order.price, 0.44)
+        self.move(0.40, 0.42)
+        await asyncio.sleep(0.1)
+        self.assertAlmostEqual(peg.order.price, 0.41)
+        self.assertGreater(self.manager.metrics()["debounced"], 0)
+        await self.manager.cancel_all()
+        self.assertEqual(self.venue.orders[peg.order.venue_order_id]["status"], CANCELLED)
+
+    async def test_polls_stale_books_and_tracks_fills(self):
+        self.manager.STALE_AFTER = 0.0
+        peg = await self.manager.peg("local", "M", 10)
+        # No update pushed: the manager reads the book itself
+        self.venue.set_book("M", bids=[(0.42, 100)], asks=[(0.45, 100)])
+        await asyncio.sleep(0.1)
+        self.assertAlmostEqual(peg.order.price, 0.42)
+        self.venue.trade("M", "yes", 0.42, 10)
+        await asyncio.sleep(0.1)
+        self.assertEqual((peg.state, peg.filled), ("filled", 10))
+
+class TestMarketMaker(unittest.IsolatedAsyncioTestCase):
+    async def asyncSetUp(self):
+        self.matcher = MatchingEngine("kalshi")
+        self.matcher.on_book("M", [(0.40, 100)], [(0.50, 100)], 0.0)
+        self.engine = ExecutionEngine([SimVenue("kalshi", matcher=self.matcher)])
+        # $200 bankroll: $10 of inventory per market
+        self.mm = MarketMaker(self.engine, RiskValidator(), 200.0, half_spread=0.02, quote_size=12, refresh=0.02)
+
+    async def test_two_sided_quotes_skew_and_pull_at_the_limit(self):
+        state = await self.mm.quote("kalshi", "M", fair=0.45)
+        await asyncio.sleep(0.05)
+        bid, offer = state["pegs"]["yes"], state["pegs"]["no"]
+        # A tick inside the spread on both sides; the offer rests as a NO bid at 1 - 0.49
+        self.assertAlmostEqual(bid.order.price, 0.41)
+        self.assertAlmostEqual(offer.order.price, 0.51)
+        self.assertAlmostEqual(offer.cap, 0.53)
+        # A seller hits the bid: long 12 YES ($5.40 at fair), so another 12 would breach $10
+        self.matcher.on_event({"type": "trade", "market": "M", "price": 0.41, "size": 12, "aggressor": "sell", "ts": 1.0})
+        await asyncio.sleep(0.1)
+        self.assertEqual((state["yes"], state["no"]), (12, 0))
+        self.assertNotIn("yes", state["pegs"])
+        # Offer skewed down by 0.54 * half spread to shed the inventory
+        self.assertAlmostEqual(state["pegs"]["no"].cap, round(1 - (0.45 - 0.0108 + 0.02), 6))
+        # Fair value moves: the offer follows within the debounce window
+        self.mm.set_fair("kalshi", "M", 0.60)
+        await asyncio.sleep(0.1)
+        self.assertAlmostEqual(state["pegs"]["no"].cap, round(1 - (0.60 - 0.0144 + 0.02), 6))
+        self.assertAlmostEqual(self.mm.pnl(state), 12 * (0.60 - 0.41))
+        self.assertEqual(await self.mm.stop(), 1)
+        self.assertEqual(self.mm.metrics()["markets"], 0)
+
+    async def test_fills_reach_the_owner_and_the_var_rows(self):
+        fills = []
+        self.mm.on_fill = lambda state, side, qty, price: fills.append((side, qty, price))
+        state = await self.mm.quote("kalshi", "M", fair=0.45)
+        await asyncio.sleep(0.05)
+        # A buyer lifts the offer: the NO bid at 0.51 fills, short 12 YES
+        self.matcher.on_event({"type": "trade", "market": "M", "price": 0.49, "size": 12, "aggressor": "buy", "ts": 1.0})
+        await asyncio.sleep(0.1)
+        self.assertEqual(fills, [("no", 12, 0.51)])
+        self.assertEqual((state["yes"], state["no"]), (0, 12))
+        # Long NO at 1 - fair: 12 contracts at 0.55, winning with probability 0.55
+        [[stake, price, p_win]] = self.mm.positions()
+        self.assertAlmostEqual(stake, 12 * 0.55)
+        self.assertAlmostEqual(price, 0.55)
+        self.assertAlmostEqual(p_win, 0.55)
+        self.assertAlmostEqual(self.mm.total_pnl(), 12 * (0.55 - 0.51))
+        # NO wins: 12 paid at $1 on $6.12; the market and its VaR row are gone
+        self.assertAlmostEqual(await self.mm.settle("kalshi", "M", 0.0, 1.0), 12 - 6.12)
+        self.assertEqual((self.mm.positions(), self.mm.markets), ([], {}))
+        self.assertEqual(await self.mm.settle("kalshi", "M", 0.0, 1.0), 0.0)
+
+class TestFillEstimator(unittest.TestCase):
+    BOOK = {"bids": [(0.49, 100)], "asks": [(0.50, 100), (0.51, 100), (0.53, 500)]}
+
+    def test_walk_matches_engine_limit(self):
+        est = FillEstimator().estimate(self.BOOK, 150)
+        self.assertEqual((est.limit, est.immediate, est.expected_fill, est.fill_prob), (0.51, 150, 150, 1.0))
+        self.assertAlmostEqual(est.vwap, (100 * 0.50 + 50 * 0.51) / 150)
+        self.assertAlmostEqual(est.limit_slippage, 0.02)
+        self.assertEqual(FillEstimator().max_size(self.BOOK), (200, 101.0))
+
+    def test_resting_remainder_fills_from_trade_flow(self):
+        flow = TradeFlow(window=100.0)
+        for i in range(50):
+            flow.record("M", 0.49, 10, "sell", ts=float(i))
+        estimator = FillEstimator(flow, horizon=30.0)
+        # 0.5 sells/s of 10 at 0.49 over 30 s ~ 150 expected, 100 of it queued ahead of us
+        est = estimator.estimate(self.BOOK, 100, limit=0.49, market_id="M", now=50.0)
+        self.assertEqual(est.immediate, 0)
+        self.assertAlmostEqual(est.expected_fill, 50, delta=5)
+        self.assertLess(est.fill_prob, 0.5)
+        # No flow seen: nothing beyond the displayed book is expected
+        self.assertEqual(FillEstimator().estimate(self.BOOK, 100, limit=0.49, market_id="M").expected_fill, 0)
+
+    def test_venue_prints_extend_the_flow_once(self):
+        venue = LocalVenue()
+        for _ in range(3):
+            venue.trade("M", "yes", 0.49, 10, aggressor="sell")
+        flow = TradeFlow()
+        flow.extend("M", asyncio.run(venue.get_trades("M")))
+        # A later poll from the last seen print adds nothing new
+        flow.extend("M", asyncio.run(venue.get_trades("M", flow.last("M"))))
+        flow.extend("M", [{"ts": flow.last("M") - 1, "price": 0.49, "size": 5, "aggressor": "sell"}])
+        self.assertEqual(len(flow.trades["M"]), 3)
+        self.assertEqual(flow.rate("M", "buy", 0.49)[1], 10)
+
+    def test_risk_validator_sizes_to_the_book(self):
+        validator = RiskValidator()
+        # $500 at p_market 0.50 would walk to 0.53 (6%); the guard allows 0.51 and the edge allows 0.56
+        allowed, msg, size = validator.validate_fill(0.60, 0.50, 500.0, self.BOOK, FillEstimator())
+        self.assertTrue(allowed)
+        self.assertAlmostEqual(size, 101.0)
+        # Edge gone at the touch
+        allowed, msg, size = validator.validate_fill(0.53, 0.50, 500.0, self.BOOK, FillEstimator())
+        self.assertFalse(allowed)
+
+if __name__ == "__main__":
+    unittest.main()
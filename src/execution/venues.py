@@ -0,0 +1,327 @@
+import time
+import asyncio
+import itertools
+from datetime import datetime
+from src.utils import logger
+from src.execution.orders import OPEN, PARTIAL, FILLED, CANCELLED
+from src.api.ratelimit import ORDER
+
+class VenueError(Exception):
+    pass
+
+class VenueAdapter:
+    """
+    What the execution engine needs from a venue. Books are normalized to
+    {"bids": [(price, size), ...], "asks": [...]} for the side being traded,
+    best level first, prices as probabilities. Order reports are
+    {"venue_order_id", "status", "filled", "avg_price"} with cumulative fills.
+    """
+    name = "venue"
+    tradeable = True     # False when the venue can quote books but not take orders
+
+    async def get_book(self, market_id, side):
+        raise NotImplementedError
+
+    async def place(self, order):
+        raise NotImplementedError
+
+    async def poll(self, order):
+        raise NotImplementedError
+
+    async def cancel(self, order):
+        raise NotImplementedError
+
+    async def place_batch(self, orders):
+        """One report (or the exception) per order. Venues without a batch endpoint submit concurrently."""
+        return await asyncio.gather(*(self.place(o) for o in orders), return_exceptions=True)
+
+    async def cancel_batch(self, orders):
+        return await asyncio.gather(*(self.cancel(o) for o in orders), return_exceptions=True)
+
+    async def get_settlement(self, market_id, side):
+        """Payout per contract of `side` once the market has resolved (1.0 or 0.0), else None."""
+        return None
+
+    async def get_trades(self, market_id, since=None):
+        """Public prints on the YES book, oldest first: {"ts", "price", "size", "aggressor"}. Empty when unknown."""
+        return []
+
+class KalshiVenue(VenueAdapter):
+    name = "kalshi"
+
+    def __init__(self, client):
+        self.client = client
+
+    async def get_book(self, market_id, side):
+        book = await asyncio.to_thread(self.client.get_orderbook, market_id, priority=ORDER)
+        if book is None:
+            raise VenueError(f"no orderbook for {market_id}")
+        # Kalshi lists bids only; an offer on one side is a bid on the other at 100 - p
+        own = sorted(book.get(side) or [], key=lambda l: -l[0])
+        other = sorted(book.get("no" if side == "yes" else "yes") or [], key=lambda l: -l[0])
+        return {
+            "bids": [(p / 100, float(q)) for p, q in own],
+            "asks": [((100 - p) / 100, float(q)) for p, q in other],
+        }
+
+    async def get_trades(self, market_id, since=None):
+        raw = await asyncio.to_thread(self.client.get_trades, market_id, min_ts=since)
+        trades = []
+        for t in reversed(raw):
+            try:
+                ts = datetime.fromisoformat(t["created_time"].replace("Z", "+00:00")).timestamp()
+            except (KeyError, ValueError):
+                continue
+            # A YES taker lifts YES offers; a NO taker hits YES bids
+            trades.append({"ts": ts, "price": t.get("yes_price", 0) / 100, "size": t.get("count", 0),
+                           "aggressor": "buy" if t.get("taker_side") == "yes" else "sell"})
+        return trades
+
+    async def get_settlement(self, market_id, side):
+        market = await asyncio.to_thread(self.client.get_market, market_id)
+        result = (market or {}).get("result")
+        if result not in ("yes", "no"):
+            return None
+        return 1.0 if result == side else 0.0
+
+    @staticmethod
+    def _report(raw, order):
+        filled = raw.get("fill_count")
+        if filled is None:
+            filled = (raw.get("taker_fill_count") or 0) + (raw.get("maker_fill_count") or 0)
+        cost = (raw.get("taker_fill_cost") or 0) + (raw.get("maker_fill_cost") or 0)
+        status = raw.get("status")
+        if status == "canceled":
+            state = CANCELLED
+        elif status == "executed" or filled >= order.size:
+            state = FILLED
+        else:
+            state = PARTIAL if filled else OPEN
+        return {
+            "venue_order_id": raw.get("order_id"),
+            "status": state,
+            "filled": float(filled),
+            "avg_price": cost / filled / 100 if filled and cost else order.price,
+        }
+
+    async def place(self, order):
+        raw = await asyncio.to_thread(self.client.place_order, order.market_id, order.side, order.action,
+                                      order.size, round(order.price * 100), order.client_order_id, order.priority)
+        if not raw.get("order_id"):
+            raise VenueError(f"Kalshi did not acknowledge {order.client_order_id}")
+        return self._report(raw, order)
+
+    async def poll(self, order):
+        raw = await asyncio.to_thread(self.client.get_order, order.venue_order_id, order.priority)
+        return self._report(raw, order)
+
+    async def cancel(self, order):
+        raw = await asyncio.to_thread(self.client.cancel_order, order.venue_order_id)
+        return self._report(raw.get("order", {}), order) if raw.get("order") else None
+
+    async def place_batch(self, orders):
+        specs = [{"ticker": o.market_id, "side": o.side, "action": o.action, "count": o.size,
+                  "price_cents": round(o.price * 100), "client_order_id": o.client_order_id} for o in orders]
+        results = await asyncio.to_thread(self.client.place_orders, specs, min(o.priority for o in orders))
+        reports = []
+        for order, (raw, error) in zip(orders, results):
+            if error or not raw.get("order_id"):
+                reports.append(VenueError(error or f"Kalshi did not acknowledge {order.client_order_id}"))
+            else:
+                reports.append(self._report(raw, order))
+        return reports
+
+    async def cancel_batch(self, orders):
+        results = await asyncio.to_thread(self.client.cancel_orders, [o.venue_order_id for o in orders])
+        return [VenueError(error) if error else (self._report(raw, order) if raw else None)
+                for order, (raw, error) in zip(orders, results)]
+
+class PolymarketVenue(VenueAdapter):
+    """Books come from the public CLOB. Order entry needs CLOB L2 credentials, which are not wired up yet."""
+    name = "polymarket"
+    tradeable = False
+
+    def __init__(self, client):
+        self.client = client
+
+    async def get_book(self, market_id, side):
+        # market_id is the outcome token; buying "yes" on it means lifting its asks
+        book = await asyncio.to_thread(self.client.get_book, market_id, ORDER)
+        if not book:
+            raise VenueError(f"no CLOB book for token {market_id}")
+        bids = sorted(((float(l["price"]), float(l["size"])) for l in book.get("bids", [])), key=lambda l: -l[0])
+        asks = sorted((float(l["price"]), float(l["size"])) for l in book.get("asks", []))
+        if side == "no":
+            bids, asks = [(1 - p, s) for p, s in asks], [(1 - p, s) for p, s in bids]
+        return {"bids": bids, "asks": asks}
+
+    async def get_settlement(self, market_id, side):
+        # Resolved markets are closed with outcomePrices pinned to 0/1; the token's own price is its payout
+        price = await asyncio.to_thread(self.client.get_resolution, market_id)
+        if price is None:
+            return None
+        return price if side == "yes" else 1.0 - price
+
+    async def place(self, order):
+        raise VenueError("Polymarket order entry requires CLOB API credentials")
+
+    async def poll(self, order):
+        raise VenueError("Polymarket order entry requires CLOB API credentials")
+
+    async def cancel(self, order):
+        raise VenueError("Polymarket order entry requires CLOB API credentials")
+
+class LocalVenue(VenueAdapter):
+    """
+    In-process venue stand-in for tests and dry runs. Limit orders match against
+    the configured book immediately; any remainder rests until `trade` sends
+    counterparties through it or it is cancelled. Latencies are simulated with
+    sleeps: one `ack_latency` per request, and batches of up to `batch_limit`
+    orders cost one request, like Kalshi's batched endpoints.
+    """
+    name = "local"
+
+    def __init__(self, ack_latency=0.0, name="local", batch_limit=20):
+        self.name = name
+        self.ack_latency = ack_latency
+        self.batch_limit = batch_limit
+        self.requests = 0
+        self.books = {}     # (market_id, side) -> {"bids": [[p, s]], "asks": [[p, s]]}
+        self.orders = {}    # venue_order_id -> {"order", "filled", "cost", "status"}
+        self._ids = itertools.count(1)
+        self.placed = 0
+        self.cancelled = 0
+        self.results = {}   # market_id -> "yes"/"no" once settled
+        self.prints = {}    # market_id -> YES-side trades sent through `trade`
+
+    def set_book(self, market_id, side="yes", bids=(), asks=()):
+        self.books[(market_id, side)] = {
+            "bids": sorted(([p, s] for p, s in bids), key=lambda l: -l[0]),
+            "asks": sorted([p, s] for p, s in asks),
+        }
+
+    async def get_book(self, market_id, side):
+        book = self.books.get((market_id, side))
+        if book is None:
+            raise VenueError(f"no book for {market_id}/{side}")
+        return {"bids": [tuple(l) for l in book["bids"]], "asks": [tuple(l) for l in book["asks"]]}
+
+    def _report(self, vid):
+        rec = self.orders[vid]
+        filled = rec["filled"]
+        return {
+            "venue_order_id": vid,
+            "status": rec["status"],
+            "filled": filled,
+            "avg_price": rec["cost"] / filled if filled else rec["order"].price,
+        }
+
+    def _fill(self, rec, qty, price):
+        rec["filled"] += qty
+        rec["cost"] += qty * price
+        if rec["filled"] >= rec["order"].size - 1e-9:
+            rec["status"] = FILLED
+        elif rec["filled"] > 0:
+            rec["status"] = PARTIAL
+
+    async def _round_trip(self):
+        self.requests += 1
+        if self.ack_latency:
+            await asyncio.sleep(self.ack_latency)
+
+    def _match(self, order):
+        book = self.books.get((order.market_id, order.side))
+        if book is None:
+            raise VenueError(f"unknown market {order.market_id}/{order.side}")
+        vid = f"{self.name}-{next(self._ids)}"
+        rec = self.orders[vid] = {"order": order, "filled": 0.0, "cost": 0.0, "status": OPEN}
+        self.placed += 1
+
+        # Cross the spread: buys lift asks at or below the limit, sells hit bids at or above it
+        buying = order.action == "buy"
+        levels = book["asks"] if buying else book["bids"]
+        for level in levels:
+            crosses = level[0] <= order.price + 1e-12 if buying else level[0] >= order.price - 1e-12
+            if rec["status"] == FILLED or not crosses:
+                break
+            qty = min(level[1], order.size - rec["filled"])
+            level[1] -= qty
+            self._fill(rec, qty, level[0])
+        book["asks" if buying else "bids"] = [l for l in levels if l[1] > 1e-9]
+        return self._report(vid)
+
+    async def place(self, order):
+        await self._round_trip()
+        return self._match(order)
+
+    async def place_batch(self, orders):
+        reports = []
+        for i in range(0, len(orders), self.batch_limit):
+            await self._round_trip()
+            for order in orders[i:i + self.batch_limit]:
+                try:
+                    reports.append(self._match(order))
+                except VenueError as e:
+                    reports.append(e)
+        return reports
+
+    def trade(self, market_id, side, price, size, aggressor="sell"):
+        """
+        Flow from other participants: a seller at `price` fills resting buys priced at or
+        above it (aggressor="sell"), a buyer fills resting sells at or below it. Oldest
+        first; returns the size traded.
+        """
+        if side == "yes":
+            self.prints.setdefault(market_id, []).append(
+                {"ts": time.time(), "price": price, "size": size, "aggressor": aggressor})
+        left = size
+        resting = "buy" if aggressor == "sell" else "sell"
+        for vid, rec in self.orders.items():
+            order = rec["order"]
+            if left <= 0:
+                break
+            if (order.market_id, order.side, order.action) != (market_id, side, resting) or rec["status"] not in (OPEN, PARTIAL):
+                continue
+            if (order.price + 1e-12 < price) if resting == "buy" else (order.price - 1e-12 > price):
+                continue
+            qty = min(left, order.size - rec["filled"])
+            self._fill(rec, qty, order.price)
+            left -= qty
+        return size - left
+
+    async def poll(self, order):
+        return self._report(order.venue_order_id)
+
+    def settle(self, market_id, result):
+        self.results[market_id] = result
+
+    async def get_trades(self, market_id, since=None):
+        return [t for t in self.prints.get(market_id, []) if since is None or t["ts"] > since]
+
+    async def get_settlement(self, market_id, side):
+        result = self.results.get(market_id)
+        return None if result is None else (1.0 if result == side else 0.0)
+
+    def _cancel(self, order):
+        rec = self.orders.get(order.venue_order_id)
+        if rec is None:
+            raise VenueError(f"unknown order {order.venue_order_id}")
+        if rec["status"] in (OPEN, PARTIAL):
+            rec["status"] = CANCELLED
+            self.cancelled += 1
+        return self._report(order.venue_order_id)
+
+    async def cancel(self, order):
+        await self._round_trip()
+        return self._cancel(order)
+
+    async def cancel_batch(self, orders):
+        reports = []
+        for i in range(0, len(orders), self.batch_limit):
+            await self._round_trip()
+            for order in orders[i:i + self.batch_limit]:
+                try:
+                    reports.append(self._cancel(order))
+                except VenueError as e:
+                    reports.append(e)
+        return reports
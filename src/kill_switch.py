@@ -0,0 +1,249 @@
+import os
+import sys
+import time
+import json
+import signal
+import select
+import struct
+import asyncio
+import threading
+import ctypes
+import ctypes.util
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from src.utils import logger
+
+# inotify(7) constants
+IN_CREATE = 0x00000100
+IN_MOVED_TO = 0x00000080
+IN_CLOEXEC = 0o2000000
+_EVENT_HEADER = struct.Struct("iIII")
+
+class KillSwitch:
+    """
+    Event-driven emergency halt. The STOP file is watched with inotify (polling
+    fallback off Linux), and the switch can also be thrown by signal or by a POST
+    to a localhost HTTP endpoint. Triggering flips an in-memory flag that hot paths
+    read for free, cancels every tracked in-flight task and runs the halt callbacks
+    (e.g. mass-cancelling resting orders).
+    """
+    def __init__(self, stop_path="STOP", http_port=None, signals=(signal.SIGUSR1,), poll_interval=0.1):
+        self.stop_path = os.path.abspath(stop_path)
+        self.http_port = http_port
+        self.signals = signals
+        self.poll_interval = poll_interval
+
+        self._flag = threading.Event()
+        self._shutdown = threading.Event()
+        self._loop = None
+        self._async_event = None
+        self._tasks = set()
+        self._halt_callbacks = []
+        self._halt_tasks = []       # Async halt callbacks in flight; drain() waits for them before shutdown
+        self._threads = []
+        self._http_server = None
+
+        self.reason = None
+        self.triggered_at = None   # time.perf_counter() at trigger, for time-to-halt metrics
+
+    @property
+    def engaged(self):
+        return self._flag.is_set()
+
+    def on_halt(self, callback):
+        """Registers a sync or async callable to run once when the switch is thrown."""
+        self._halt_callbacks.append(callback)
+
+    def start(self):
+        """Binds to the running event loop and starts all trigger sources."""
+        self._loop = asyncio.get_running_loop()
+        self._async_event = asyncio.Event()
+        if self._flag.is_set():
+            # Thrown before there was a loop to halt on: run the halt path now
+            self._loop.call_soon(self._halt_in_loop)
+            return
+
+        if os.path.exists(self.stop_path):
+            self.trigger("STOP file present at startup")
+            return
+
+        if sys.platform.startswith("linux") and self._start_inotify():
+            pass
+        else:
+            self._spawn(self._poll_loop, "kill-switch-poll")
+
+        for sig in self.signals:
+            try:
+                self._loop.add_signal_handler(sig, self.trigger, f"signal {signal.Signals(sig).name}")
+            except (NotImplementedError, RuntimeError, ValueError) as e:
+                logger.debug(f"Kill switch could not install handler for {sig}: {e}")
+
+        if self.http_port is not None:
+            self._start_http()
+
+    def stop(self):
+        self._shutdown.set()
+        if self._http_server:
+            self._http_server.shutdown()
+            self._http_server.server_close()
+        for sig in self.signals:
+            try:
+                self._loop.remove_signal_handler(sig)
+            except Exception:
+                pass
+        for t in self._threads:
+            t.join(timeout=1.0)
+
+    def trigger(self, reason="manual"):
+        """Thread-safe. Flips the flag immediately, then cancels work on the loop."""
+        if self._flag.is_set():
+            return
+        self.triggered_at = time.perf_counter()
+        self.reason = reason
+        self._flag.set()
+        logger.critical(f"KILL SWITCH ENGAGED! ({reason})")
+
+        if self._loop and not self._loop.is_closed():
+            try:
+                self._loop.call_soon_threadsafe(self._halt_in_loop)
+            except RuntimeError:
+                pass
+
+    def _halt_in_loop(self):
+        self._async_event.set()
+        pending = [t for t in self._tasks if not t.done()]
+        for task in pending:
+            task.cancel()
+        if pending:
+            logger.critical(f"Kill switch cancelled {len(pending)} in-flight task(s).")
+
+        for cb in self._halt_callbacks:
+            try:
+                res = cb()
+                if asyncio.iscoroutine(res):
+                    self._halt_tasks.append(self._loop.create_task(res))
+            except Exception as e:
+                logger.error(f"Kill switch halt callback failed: {e}")
+
+    async def drain(self, timeout=10.0):
+        """Waits for async halt callbacks (the mass-cancel) to finish, so loop shutdown can't cut them off."""
+        pending = [t for t in self._halt_tasks if not t.done()]
+        if not pending:
+            return True
+        done, pending = await asyncio.wait(pending, timeout=timeout)
+        if pending:
+            logger.error(f"Kill switch: {len(pending)} halt callback(s) still running after {timeout:.0f}s.")
+        return not pending
+
+    def track(self, coro):
+        """Schedules a coroutine as a task that will be cancelled if the switch is thrown."""
+        task = asyncio.ensure_future(coro)
+        if self._flag.is_set():
+            task.cancel()
+            return task
+        self._tasks.add(task)
+        task.add_done_callback(self._tasks.discard)
+        return task
+
+    async def sleep(self, seconds):
+        """Interruptible sleep. Returns True if the switch was thrown while waiting."""
+        if self._async_event is None:
+            await asyncio.sleep(seconds)
+            return self.engaged
+        try:
+            await asyncio.wait_for(self._async_event.wait(), timeout=seconds)
+        except asyncio.TimeoutError:
+            pass
+        return self.engaged
+
+    # --- Trigger sources ---
+
+    def _spawn(self, target, name):
+        t = threading.Thread(target=target, name=name, daemon=True)
+        t.start()
+        self._threads.append(t)
+
+    def _start_inotify(self):
+        try:
+            libc = ctypes.CDLL(ctypes.util.find_library("c") or "libc.so.6", use_errno=True)
+            fd = libc.inotify_init1(IN_CLOEXEC)
+            if fd < 0:
+                return False
+            watch_dir = os.path.dirname(self.stop_path).encode()
+            if libc.inotify_add_watch(fd, watch_dir, IN_CREATE | IN_MOVED_TO) < 0:
+                os.close(fd)
+                return False
+        except (OSError, AttributeError) as e:
+            logger.debug(f"inotify unavailable, falling back to polling: {e}")
+            return False
+
+        # The file may have appeared between the exists() check and the watch
+        if os.path.exists(self.stop_path):
+            os.close(fd)
+            self.trigger("STOP file detected")
+            return True
+
+        self._spawn(lambda: self._inotify_loop(fd), "kill-switch-inotify")
+        return True
+
+    def _inotify_loop(self, fd):
+        target = os.path.basename(self.stop_path).encode()
+        try:
+            while not self._shutdown.is_set() and not self._flag.is_set():
+                ready, _, _ = select.select([fd], [], [], 0.25)
+                if not ready:
+                    continue
+                buf = os.read(fd, 4096)
+                offset = 0
+                while offset < len(buf):
+                    _, _, _, name_len = _EVENT_HEADER.unpack_from(buf, offset)
+                    start = offset + _EVENT_HEADER.size
+                    name = buf[start:start + name_len].rstrip(b"\0")
+                    offset = start + name_len
+                    if name == target:
+                        self.trigger("STOP file detected")
+                        return
+        finally:
+            os.close(fd)
+
+    def _poll_loop(self):
+        while not self._shutdown.is_set() and not self._flag.is_set():
+            if os.path.exists(self.stop_path):
+                self.trigger("STOP file detected")
+                return
+            time.sleep(self.poll_interval)
+
+    def _start_http(self):
+        switch = self
+
+        class Handler(BaseHTTPRequestHandler):
+            def _reply(self, code, payload):
+                body = json.dumps(payload).encode()
+                self.send_response(code)
+                self.send_header("Content-Type", "application/json")
+                self.send_header("Content-Length", str(len(body)))
+                self.end_headers()
+                self.wfile.write(body)
+
+            def do_POST(self):
+                if self.path.rstrip("/") != "/halt":
+                    return self._reply(404, {"error": "not found"})
+                switch.trigger("HTTP /halt")
+                self._reply(200, {"halted": True})
+
+            def do_GET(self):
+                self._reply(200, {"halted": switch.engaged, "reason": switch.reason})
+
+            def log_message(self, *args):
+                pass
+
+        # Loopback only: anyone who can reach this port can halt trading
+        try:
+            self._http_server = ThreadingHTTPServer(("127.0.0.1", self.http_port), Handler)
+        except OSError as e:
+            # Port taken (another worker on this host): the STOP file and signal still work
+            logger.warning(f"Kill switch HTTP endpoint disabled, could not bind 127.0.0.1:{self.http_port}: {e}")
+            self.http_port = None
+            return
+        self.http_port = self._http_server.server_address[1]
+        self._spawn(self._http_server.serve_forever, "kill-switch-http")
+        logger.info(f"Kill switch HTTP endpoint listening on 127.0.0.1:{self.http_port}/halt")
@@ -0,0 +1,131 @@
+import asyncio
+import threading
+from concurrent.futures import Future
+from src.utils import logger
+
+PLATFORMS = ("kalshi", "polymarket")
+
+class MarketDataService:
+    """
+    The one place a sweep's market data comes from. Each venue is fetched and
+    normalized at most once per sweep; the results are shared by every consumer
+    (candidate scan, arbitrage scan, point lookups). Concurrent requests for the
+    same key, from threads or coroutines, wait on the first caller's future
+    instead of issuing their own upstream fetch.
+    """
+    def __init__(self, scanner, compute=None):
+        self.scanner = scanner        # Supplies the clients, the pushed-down filter and the normalizers
+        self.compute = compute        # Optional ComputeExecutor; normalization runs inline without one
+        self.sweep = 0
+        self.seeded = False
+        self._results = {}            # (sweep, key) -> Future, kept until the next sweep
+        self._lock = threading.Lock()
+
+        self.upstream_fetches = 0
+        self.coalesced = 0
+
+    def new_sweep(self, raw_markets=None):
+        """Drops the previous sweep's data. A persisted snapshot can be passed in to stand in for the fetch."""
+        with self._lock:
+            self.sweep += 1
+            self._results.clear()
+            self.seeded = raw_markets is not None
+            if self.seeded:
+                for platform in PLATFORMS:
+                    fut = Future()
+                    fut.set_result(raw_markets.get(platform, []))
+                    self._results[(self.sweep, ("raw", platform))] = fut
+        self.scanner.aggregator.reset_stats()
+
+    def _claim(self, key):
+        """Returns (future, owner). Only the owner computes; everyone else waits on its future."""
+        with self._lock:
+            key = (self.sweep, key)
+            fut = self._results.get(key)
+            if fut is not None:
+                self.coalesced += 1
+                return fut, False
+            fut = self._results[key] = Future()
+            return fut, True
+
+    def _fail(self, key, fut, exc):
+        # Not cached: the next caller retries instead of inheriting the error for the whole sweep
+        with self._lock:
+            if self._results.get((self.sweep, key)) is fut:
+                del self._results[(self.sweep, key)]
+        fut.set_exception(exc)
+
+    def _once(self, key, fn):
+        fut, owner = self._claim(key)
+        if owner:
+            try:
+                fut.set_result(fn())
+            except Exception as e:
+                self._fail(key, fut, e)
+        return fut.result()
+
+    async def _aonce(self, key, coro_fn):
+        fut, owner = self._claim(key)
+        if owner:
+            try:
+                fut.set_result(await coro_fn())
+            except BaseException as e:
+                self._fail(key, fut, e)
+                raise
+        return await asyncio.wrap_future(fut)
+
+    # --- Raw venue pages ---
+
+    def _fetch(self, platform):
+        client = self.scanner.aggregator.kalshi if platform == "kalshi" else self.scanner.aggregator.poly
+        self.upstream_fetches += 1
+        markets = client.get_markets(market_filter=self.scanner.market_filter())
+        logger.info(f"{platform} transfer: {client.stats}")
+        return markets
+
+    def raw(self, platform):
+        return self._once(("raw", platform), lambda: self._fetch(platform))
+
+    async def araw(self, platform):
+        return await self._aonce(("raw", platform), lambda: asyncio.to_thread(self._fetch, platform))
+
+    def raw_markets(self):
+        return {platform: self.raw(platform) for platform in PLATFORMS}
+
+    async def araw_markets(self):
+        pages = await asyncio.gather(*(self.araw(platform) for platform in PLATFORMS))
+        return dict(zip(PLATFORMS, pages))
+
+    # --- Normalized rows (the representation every consumer reads) ---
+
+    def normalized(self, platform):
+        return self._once(("norm", platform), lambda: self.scanner.filter_candidates(platform, self.raw(platform)))
+
+    async def anormalized(self, platform):
+        async def build():
+            raw = await self.araw(platform)
+            if not self.compute:
+                return self.scanner.filter_candidates(platform, raw)
+            from src.compute import normalize_batch
+            return await self.compute.run(normalize_batch, platform, raw,
+                                          self.scanner.MIN_VOLUME, self.scanner.MAX_EXPIRY_DAYS)
+        return await self._aonce(("norm", platform), build)
+
+    def candidates(self):
+        # Shallow copies: consumers annotate their rows (priority_score) without touching the shared ones
+        return [dict(row) for platform in PLATFORMS for row in self.normalized(platform)]
+
+    async def acandidates(self):
+        batches = await asyncio.gather(*(self.anormalized(platform) for platform in PLATFORMS))
+        return [dict(row) for batch in batches for row in batch]
+
+    async def amarket(self, platform, market_id):
+        """Point lookup of one normalized market; shares the venue fetch with everything else in the sweep."""
+        async def build():
+            return {row["id"]: row for row in await self.anormalized(platform)}
+        index = await self._aonce(("index", platform), build)
+        return index.get(market_id)
+
+    def report(self):
+        return (f"sweep {self.sweep}: {self.upstream_fetches} upstream fetch(es), {self.coalesced} coalesced | "
+                f"{self.scanner.aggregator.transfer_report()}")
@@ -0,0 +1,777 @@
+import os
+import json
+import time
+import base64
+import random
+import asyncio
+import hashlib
+import itertools
+from dataclasses import dataclass
+from datetime import datetime, timezone, timedelta
+from urllib.parse import urlsplit, parse_qs
+import numpy as np
+from src.utils import logger
+
+try:
+    import msgspec
+    _dumps = msgspec.json.encode
+    _loads = msgspec.json.decode
+except ImportError:
+    msgspec = None
+    _dumps = lambda obj: json.dumps(obj, separators=(",", ":")).encode()
+    _loads = json.loads
+
+KALSHI_PREFIX = "/trade-api/v2"
+_WS_GUID = b"258EAFA5-E914-47DA-95CA-C5AB0DC11B65"
+_REASONS = {200: "OK", 201: "Created", 400: "Bad Request", 401: "Unauthorized", 404: "Not Found",
+            429: "Too Many Requests", 500: "Internal Server Error"}
+
+@dataclass
+class MockConfig:
+    """Everything the mock venues can be tuned with; `python -m src.mock_venue --help` exposes the same knobs."""
+    kalshi_markets: int = 2000
+    ladder_size: int = 8              # Kalshi strikes per event ("greater" ladders)
+    poly_events: int = 1000
+    neg_risk_share: float = 0.2       # Share of Gamma events that are multi-outcome negRisk baskets
+    max_outcomes: int = 8
+    overlap_share: float = 0.05       # Polymarket markets titled like a Kalshi market (cross-venue pairs)
+    mispricing_share: float = 0.01    # Kalshi ladders with a monotonicity violation injected
+    book_depth: int = 5
+    latency_ms: float = 0.0           # Added to every REST response
+    jitter_ms: float = 0.0
+    error_rate: float = 0.0           # Share of REST requests answered 500
+    throttle_rate: float = 0.0        # Share of REST requests answered 429 + Retry-After
+    rate_limit_rps: float = 0.0       # Server-side per-venue limit enforced with 429s (0 = off)
+    updates_per_sec: float = 1000.0   # Book updates generated across both venues
+    trade_share: float = 0.1          # Share of updates that are trades (last_trade_price)
+    tick_s: float = 0.01
+    verify_signatures: bool = True    # Kalshi /portfolio requests must carry a valid RSA signature
+    max_page: int = 1000
+    seed: int = 7
+
+class _Book:
+    """Top levels in integer cents, YES terms: bids/asks are {price: size}."""
+    __slots__ = ("bids", "asks", "hash")
+
+    def __init__(self, bids, asks):
+        self.bids, self.asks, self.hash = bids, asks, 0
+
+    def best_bid(self):
+        return max(self.bids) if self.bids else 0
+
+    def best_ask(self):
+        return min(self.asks) if self.asks else 100
+
+class MockUniverse:
+    """
+    Synthetic markets on both venues, their books and the Kalshi orders placed
+    against them. Listing payloads are pre-encoded per row and re-encoded only
+    when a row's quote changes, so large pages are mostly byte joins.
+    """
+    def __init__(self, config):
+        self.config = config
+        self.rng = np.random.default_rng(config.seed)
+        self._rand = random.Random(config.seed)
+        now = datetime.now(timezone.utc).replace(microsecond=0)
+
+        # Kalshi: ladders of "greater" strikes, YES price falling with the strike
+        n = config.kalshi_markets
+        ladder = max(config.ladder_size, 1)
+        self.k_event = np.arange(n) // ladder
+        self.k_strike_idx = np.arange(n) % ladder
+        base = self.rng.integers(60, 95, size=int(self.k_event.max()) + 1 if n else 0)
+        step = self.rng.integers(4, 9, size=len(base))
+        mid = np.clip(base[self.k_event] - step[self.k_event] * self.k_strike_idx, 3, 97) if n else np.zeros(0, int)
+        bad = self.rng.random(len(base)) < config.mispricing_share
+        for e in np.flatnonzero(bad):
+            # Higher strike priced above the lower one: a free monotonic spread
+            lo = e * ladder
+            if lo + 1 < n and self.k_event[lo + 1] == e:
+                mid[lo + 1] = min(mid[lo] + 8, 97)
+        self.k_mid = mid.astype(np.int64)
+        close_days = self.rng.integers(1, 60, size=len(base))
+        volume = self.rng.lognormal(8, 2, size=n).astype(np.int64)
+        self.k_rows, self.k_index = [], {}
+        for i in range(n):
+            e = int(self.k_event[i])
+            strike = 1000 + 25 * int(self.k_strike_idx[i])
+            ticker = f"KXMOCK-{e:05d}-T{strike}"
+            self.k_index[ticker] = i
+            self.k_rows.append({
+                "ticker": ticker,
+                "event_ticker": f"KXMOCK-{e:05d}",
+                "title": f"Will mock index {e} close above {strike}?",
+                "status": "open",
+                "yes_bid": int(mid[i]) - 1,
+                "yes_ask": int(mid[i]) + 1,
+                "volume": int(volume[i]),
+                "close_time": (now + timedelta(days=int(close_days[e]))).isoformat().replace("+00:00", "Z"),
+                "strike_type": "greater",
+                "floor_strike": float(strike),
+                "cap_strike": None,
+            })
+        self.k_close_ts = np.array([now.timestamp() + 86400 * int(close_days[int(e)]) for e in self.k_event], dtype=np.float64)
+        self.k_encoded = [_dumps(r) for r in self.k_rows]
+
+        # Gamma: binary events plus negRisk baskets; a slice reuses Kalshi titles so pairs match
+        self.p_events, self.p_encoded, self.tokens = [], [], {}   # token -> (event idx, market idx, is_no)
+        self.pairs = {}                                           # token -> (yes token, no token, market id)
+        self.p_close_ts, self.p_volume = [], []
+        token_ids = itertools.count(10**20)
+        for e in range(config.poly_events):
+            neg = self._rand.random() < config.neg_risk_share
+            k = self._rand.randint(3, max(config.max_outcomes, 3)) if neg else 1
+            days = self._rand.randint(1, 60)
+            end = (now + timedelta(days=days)).isoformat().replace("+00:00", "Z")
+            title = (self.k_rows[self._rand.randrange(n)]["title"] if n and self._rand.random() < config.overlap_share
+                     else f"Mock event {e}")
+            # Basket prices roughly sum to one, with noise that occasionally leaves an arb
+            weights = self.rng.dirichlet(np.ones(k)) if neg else np.array([self.rng.uniform(0.05, 0.95)])
+            markets = []
+            for m in range(k):
+                yes, no = str(next(token_ids)), str(next(token_ids))
+                mid_c = int(np.clip(round(weights[m] * 100 * self.rng.uniform(0.95, 1.05)), 2, 98))
+                market = {
+                    "id": f"{e}{m:02d}",
+                    "question": f"{title} - outcome {m}" if neg else title,
+                    "outcomes": '["Yes", "No"]',
+                    "outcomePrices": "",
+                    "clobTokenIds": json.dumps([yes, no]),
+                    "bestBid": 0.0,
+                    "bestAsk": 0.0,
+                    "volume": float(self.rng.lognormal(9, 2)),
+                    "endDate": end,
+                    "negRisk": neg,
+                    "_mid": mid_c,
+                }
+                self._quote_poly(market, mid_c - 1, mid_c + 1)
+                self.tokens[yes] = (e, m, False)
+                self.tokens[no] = (e, m, True)
+                self.pairs[yes] = self.pairs[no] = (yes, no, market["id"])
+                markets.append(market)
+            self.p_events.append({
+                "id": str(e),
+                "title": title,
+                "volume": sum(mk["volume"] for mk in markets),
+                "endDate": end,
+                "negRisk": neg,
+                "active": True,
+                "closed": False,
+                "markets": markets,
+            })
+            self.p_close_ts.append(now.timestamp() + 86400 * days)
+            self.p_volume.append(self.p_events[-1]["volume"])
+        self.p_close_ts = np.array(self.p_close_ts, dtype=np.float64)
+        self.p_volume = np.array(self.p_volume, dtype=np.float64)
+        self.p_encoded = [self._encode_event(ev) for ev in self.p_events]
+        self.token_list = list(self.tokens)
+
+        self.books = {}         # Kalshi ticker or Polymarket YES token -> _Book, built on first touch
+        self.orders = {}        # Kalshi order_id -> order dict
+        self.resting = {}       # ticker -> [order_id]
+        self._order_ids = itertools.count(1)
+
+    @staticmethod
+    def _quote_poly(market, bid, ask):
+        market["bestBid"], market["bestAsk"] = bid / 100, ask / 100
+        mid = (bid + ask) / 200
+        market["outcomePrices"] = json.dumps([f"{mid:.3f}", f"{1 - mid:.3f}"])
+
+    @staticmethod
+    def _encode_event(event):
+        return _dumps({**event, "markets": [{k: v for k, v in m.items() if k != "_mid"} for m in event["markets"]]})
+
+    # Books
+
+    def _build_book(self, mid):
+        depth = self.config.book_depth
+        sizes = self.rng.integers(50, 500, size=2 * depth)
+        bids = {p: int(s) for p, s in zip(range(mid - 1, mid - 1 - depth, -1), sizes[:depth]) if 1 <= p <= 99}
+        asks = {p: int(s) for p, s in zip(range(mid + 1, mid + 1 + depth), sizes[depth:]) if 1 <= p <= 99}
+        return _Book(bids, asks)
+
+    def book(self, key):
+        """Kalshi ticker or Polymarket token (NO tokens resolve to their YES token's book)."""
+        if key in self.k_index:
+            if key not in self.books:
+                self.books[key] = self._build_book(int(self.k_mid[self.k_index[key]]))
+            return key, self.books[key]
+        if key in self.tokens:
+            e, m, _ = self.tokens[key]
+            yes = self.pairs[key][0]
+            if yes not in self.books:
+                self.books[yes] = self._build_book(self.p_events[e]["markets"][m]["_mid"])
+            return yes, self.books[yes]
+        return None, None
+
+    def _requote(self, key):
+        """Pushes a changed top of book into the listing row and its pre-encoded bytes."""
+        book = self.books[key]
+        bid, ask = book.best_bid(), book.best_ask()
+        if key in self.k_index:
+            i = self.k_index[key]
+            row = self.k_rows[i]
+            if (row["yes_bid"], row["yes_ask"]) != (bid, ask):
+                row["yes_bid"], row["yes_ask"] = bid, ask
+                self.k_encoded[i] = _dumps(row)
+            self._cross_resting(key)
+        else:
+            e, m, _ = self.tokens[key]
+            market = self.p_events[e]["markets"][m]
+            if (market["bestBid"], market["bestAsk"]) != (bid / 100, ask / 100):
+                self._quote_poly(market, bid, ask)
+                self.p_encoded[e] = self._encode_event(self.p_events[e])
+
+    def kalshi_orderbook(self, ticker, depth):
+        _, book = self.book(ticker)
+        if book is None:
+            return None
+        yes = sorted(book.bids.items())[-depth:]
+        no = sorted((100 - p, s) for p, s in book.asks.items())[-depth:]
+        return {"yes": [list(l) for l in yes] or None, "no": [list(l) for l in no] or None}
+
+    def clob_book(self, token):
+        yes, book = self.book(token)
+        if book is None:
+            return None
+        bids, asks = book.bids.items(), book.asks.items()
+        if token != yes:
+            bids, asks = [(100 - p, s) for p, s in asks], [(100 - p, s) for p, s in bids]
+        return {
+            "market": self.pairs[token][2],
+            "asset_id": token,
+            "bids": [{"price": f"{p / 100:.2f}", "size": str(s)} for p, s in sorted(bids)],
+            "asks": [{"price": f"{p / 100:.2f}", "size": str(s)} for p, s in sorted(asks, reverse=True)],
+            "hash": f"{book.hash:x}",
+            "timestamp": str(int(time.time() * 1000)),
+        }
+
+    def tick(self, keys):
+        """
+        Random walk on the given books: a level resizes, the quote shifts a cent, or a
+        trade takes liquidity. Returns [(key, event)] with event in CLOB WS format.
+        """
+        events = []
+        trade_share = self.config.trade_share
+        draws = self.rng.random((len(keys), 3))
+        for key, (u, v, w) in zip(keys, draws):
+            key, book = self.book(key)
+            if u < trade_share:
+                buy = v < 0.5
+                levels = book.asks if buy else book.bids
+                if not levels:
+                    continue
+                price = min(levels) if buy else max(levels)
+                size = max(1, int(levels[price] * w))
+                levels[price] -= size
+                if levels[price] <= 0:
+                    del levels[price]
+                events.append((key, {"event_type": "last_trade_price", "price": f"{price / 100:.2f}",
+                                     "side": "BUY" if buy else "SELL", "size": str(size)}))
+            elif u < 0.5:
+                # Quote shift: whole book moves one cent, bounded to 2..98
+                shift = 1 if v < 0.5 else -1
+                if not (2 <= book.best_bid() + shift and book.best_ask() + shift <= 98):
+                    continue
+                book.bids = {p + shift: s for p, s in book.bids.items()}
+                book.asks = {p + shift: s for p, s in book.asks.items()}
+            else:
+                side = book.bids if v < 0.5 else book.asks
+                if not side:
+                    continue
+                price = max(side) if side is book.bids else min(side)
+                side[price] = max(1, int(side[price] * (0.5 + w)))
+            if not book.bids:
+                book.bids[max(book.best_ask() - 2, 1)] = 100
+            if not book.asks:
+                book.asks[min(book.best_bid() + 2, 99)] = 100
+            book.hash += 1
+            self._requote(key)
+            events.append((key, {"event_type": "price_change", "best_bid": f"{book.best_bid() / 100:.2f}",
+                                 "best_ask": f"{book.best_ask() / 100:.2f}", "hash": f"{book.hash:x}"}))
+        return events
+
+    # Kalshi orders (integer cents; YES-equivalent matching)
+
+    def place(self, spec):
+        ticker, side, action = spec.get("ticker"), spec.get("side"), spec.get("action", "buy")
+        count = int(spec.get("count") or 0)
+        price = spec.get(f"{side}_price")
+        if ticker not in self.k_index or side not in ("yes", "no") or count <= 0 or not price:
+            return None, {"code": "invalid_order", "message": "ticker, side, count and price are required"}
+        order = {
+            "order_id": f"mock-{next(self._order_ids)}",
+            "client_order_id": spec.get("client_order_id"),
+            "ticker": ticker, "side": side, "action": action, "type": "limit",
+            "yes_price": price if side == "yes" else 100 - price,
+            "no_price": price if side == "no" else 100 - price,
+            "status": "resting", "count": count, "fill_count": 0, "remaining_count": count,
+            "taker_fill_count": 0, "taker_fill_cost": 0, "maker_fill_count": 0, "maker_fill_cost": 0,
+            "created_time": datetime.now(timezone.utc).isoformat().replace("+00:00", "Z"),
+        }
+        self.orders[order["order_id"]] = order
+        self._match(order, taker=True)
+        if order["status"] == "resting":
+            self.resting.setdefault(ticker, []).append(order["order_id"])
+        return order, None
+
+    @staticmethod
+    def _yes_terms(order):
+        # Buying NO at p is selling YES at 100 - p
+        buys_yes = (order["side"] == "yes") == (order["action"] == "buy")
+        return buys_yes, order["yes_price"]
+
+    def _match(self, order, taker):
+        _, book = self.book(order["ticker"])
+        buys_yes, limit = self._yes_terms(order)
+        levels = book.asks if buys_yes else book.bids
+        for price in sorted(levels, reverse=not buys_yes):
+            if order["remaining_count"] <= 0 or (price > limit if buys_yes else price < limit):
+                break
+            qty = min(levels[price], order["remaining_count"])
+            levels[price] -= qty
+            if levels[price] <= 0:
+                del levels[price]
+            own_price = price if order["side"] == "yes" else 100 - price
+            kind = "taker" if taker else "maker"
+            order[f"{kind}_fill_count"] += qty
+            order[f"{kind}_fill_cost"] += qty * own_price
+            order["fill_count"] += qty
+            order["remaining_count"] -= qty
+        if order["remaining_count"] <= 0:
+            order["status"] = "executed"
+
+    def _cross_resting(self, ticker):
+        ids = self.resting.get(ticker)
+        if not ids:
+            return
+        for oid in ids:
+            order = self.orders[oid]
+            if order["status"] == "resting":
+                self._match(order, taker=False)
+        self.resting[ticker] = [oid for oid in ids if self.orders[oid]["status"] == "resting"]
+
+    def cancel(self, order_id):
+        order = self.orders.get(order_id)
+        if order is None:
+            return None
+        if order["status"] == "resting":
+            order["status"] = "canceled"
+            order["reduced_by"] = order["remaining_count"]
+            order["remaining_count"] = 0
+        return order
+
+def _ws_frame(payload, opcode=0x1, mask=False):
+    header = bytearray([0x80 | opcode])
+    n = len(payload)
+    bit = 0x80 if mask else 0
+    if n < 126:
+        header.append(bit | n)
+    elif n < 65536:
+        header += bytes([bit | 126]) + n.to_bytes(2, "big")
+    else:
+        header += bytes([bit | 127]) + n.to_bytes(8, "big")
+    if mask:
+        key = os.urandom(4)
+        payload = bytes(b ^ key[i % 4] for i, b in enumerate(payload)) if n < 1024 else \
+            (np.frombuffer(payload, np.uint8) ^ np.resize(np.frombuffer(key, np.uint8), n)).tobytes()
+        header += key
+    return bytes(header) + payload
+
+async def ws_read(reader):
+    """One WebSocket frame: (opcode, payload). Unmasks client frames."""
+    b0, b1 = await reader.readexactly(2)
+    n = b1 & 0x7F
+    if n == 126:
+        n = int.from_bytes(await reader.readexactly(2), "big")
+    elif n == 127:
+        n = int.from_bytes(await reader.readexactly(8), "big")
+    key = await reader.readexactly(4) if b1 & 0x80 else None
+    payload = await reader.readexactly(n)
+    if key:
+        payload = (np.frombuffer(payload, np.uint8) ^ np.resize(np.frombuffer(key, np.uint8), n)).tobytes()
+    return b0 & 0x0F, payload
+
+async def ws_connect(host, port, path="/ws/market"):
+    """Minimal client used by tests and the load generator. Returns (reader, writer)."""
+    reader, writer = await asyncio.open_connection(host, port)
+    key = base64.b64encode(os.urandom(16)).decode()
+    writer.write((f"GET {path} HTTP/1.1\r\nHost: {host}:{port}\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                  f"Sec-WebSocket-Key: {key}\r\nSec-WebSocket-Version: 13\r\n\r\n").encode())
+    head = await reader.readuntil(b"\r\n\r\n")
+    if b" 101 " not in head.split(b"\r\n", 1)[0]:
+        raise ConnectionError(f"WebSocket upgrade refused: {head[:80]!r}")
+    return reader, writer
+
+def ws_send(writer, obj):
+    writer.write(_ws_frame(_dumps(obj), mask=True))
+
+class MockVenueServer:
+    """
+    One asyncio HTTP/1.1 + WebSocket server standing in for every venue endpoint:
+    Kalshi /trade-api/v2 (markets, orderbooks, signed portfolio/orders incl.
+    batched), Gamma /events, CLOB /book, /books and the /ws/market channel.
+    Point clients at it with KALSHI_BASE_URL / POLYMARKET_GAMMA_URL / POLYMARKET_CLOB_URL.
+    """
+    def __init__(self, config=None, host="127.0.0.1", port=0, public_key=None):
+        self.config = config or MockConfig()
+        self.universe = MockUniverse(self.config)
+        self.host, self.port = host, port
+        self.public_key = public_key     # Kalshi RSA public key signatures are checked against
+        self._server = None
+        self._ticker = None
+        self._subs = {}                  # token -> set of subscriber writers
+        self._pending = {}               # writer -> [events] to flush on the next tick
+        self._limits = {}                # venue -> [tokens, updated]
+        self._rand = random.Random(self.config.seed)
+        self.requests = 0
+        self.updates = 0
+        self.messages = 0
+
+    @property
+    def url(self):
+        return f"http://{self.host}:{self.port}"
+
+    def client_env(self):
+        return {
+            "KALSHI_BASE_URL": self.url + KALSHI_PREFIX,
+            "POLYMARKET_GAMMA_URL": self.url,
+            "POLYMARKET_CLOB_URL": self.url,
+        }
+
+    async def start(self):
+        self._server = await asyncio.start_server(self._handle, self.host, self.port, limit=1 << 20)
+        self.port = self._server.sockets[0].getsockname()[1]
+        self._ticker = asyncio.ensure_future(self._tick_loop())
+        logger.info(f"[MOCK] Serving {self.config.kalshi_markets} Kalshi markets and {self.config.poly_events} "
+                    f"Gamma events on {self.url} ({self.config.updates_per_sec:g} book updates/s)")
+        return self
+
+    async def stop(self):
+        if self._ticker:
+            self._ticker.cancel()
+        for writer in list(self._pending):
+            writer.close()
+        if self._server:
+            self._server.close()
+            await self._server.wait_closed()
+
+    # HTTP
+
+    async def _handle(self, reader, writer):
+        try:
+            while True:
+                try:
+                    head = await reader.readuntil(b"\r\n\r\n")
+                except (asyncio.IncompleteReadError, ConnectionError):
+                    return
+                lines = head.decode("latin-1").split("\r\n")
+                method, target, _ = lines[0].split(" ", 2)
+                headers = {}
+                for line in lines[1:]:
+                    if ":" in line:
+                        k, v = line.split(":", 1)
+                        headers[k.strip().lower()] = v.strip()
+                body = await reader.readexactly(int(headers.get("content-length", 0) or 0))
+                parts = urlsplit(target)
+                if parts.path == "/ws/market" and headers.get("upgrade", "").lower() == "websocket":
+                    await self._websocket(reader, writer, headers)
+                    return
+                self.requests += 1
+                status, payload, extra = await self._route(method, parts.path, parse_qs(parts.query), headers, body)
+                out = [f"HTTP/1.1 {status} {_REASONS.get(status, 'OK')}",
+                       "Content-Type: application/json", f"Content-Length: {len(payload)}"]
+                out += [f"{k}: {v}" for k, v in extra.items()]
+                writer.write(("\r\n".join(out) + "\r\n\r\n").encode() + payload)
+                await writer.drain()
+                if headers.get("connection", "").lower() == "close":
+                    return
+        except asyncio.CancelledError:
+            pass    # Server shutting down
+        except Exception as e:
+            logger.error(f"[MOCK] Connection error: {e}")
+        finally:
+            writer.close()
+
+    def _throttled(self, venue):
+        rps = self.config.rate_limit_rps
+        if not rps:
+            return None
+        now = time.monotonic()
+        tokens, updated = self._limits.get(venue, (rps, now))
+        tokens = min(rps, tokens + (now - updated) * rps)
+        if tokens < 1:
+            self._limits[venue] = (tokens, now)
+            return {"Retry-After": f"{(1 - tokens) / rps:.3f}", "X-RateLimit-Remaining": "0"}
+        self._limits[venue] = (tokens - 1, now)
+        return None
+
+    async def _route(self, method, path, query, headers, body):
+        cfg = self.config
+        if cfg.latency_ms or cfg.jitter_ms:
+            await asyncio.sleep((cfg.latency_ms + self._rand.uniform(0, cfg.jitter_ms)) / 1000)
+        venue = "kalshi" if path.startswith(KALSHI_PREFIX) else "polymarket"
+        limited = self._throttled(venue)
+        if limited or self._rand.random() < cfg.throttle_rate:
+            return 429, _dumps({"error": "rate limited"}), limited or {"Retry-After": "1"}
+        if self._rand.random() < cfg.error_rate:
+            return 500, _dumps({"error": "injected failure"}), {}
+        q = {k: v[-1] for k, v in query.items()}
+        try:
+            if venue == "kalshi":
+                return self._kalshi(method, path[len(KALSHI_PREFIX):], q, headers, body)
+            if path == "/events" and method == "GET":
+                return 200, self._gamma_events(q), {}
+            if path == "/book" and method == "GET":
+                book = self.universe.clob_book(q.get("token_id", ""))
+                return (200, _dumps(book), {}) if book else (404, _dumps({"error": "No orderbook exists"}), {})
+            if path == "/books" and method == "POST":
+                books = [self.universe.clob_book(r.get("token_id", "")) for r in _loads(body or b"[]")]
+                return 200, _dumps([b for b in books if b]), {}
+        except Exception as e:
+            logger.error(f"[MOCK] {method} {path} failed: {e}")
+            return 500, _dumps({"error": str(e)}), {}
+        return 404, _dumps({"error": f"no route for {method} {path}"}), {}
+
+    def _verify(self, method, path, headers):
+        if not self.config.verify_signatures:
+            return True
+        key, sig, ts = (headers.get(h) for h in ("kalshi-access-key", "kalshi-access-signature", "kalshi-access-timestamp"))
+        if not (key and sig and ts and self.public_key):
+            return False
+        if abs(time.time() * 1000 - int(ts)) > 30_000:
+            return False
+        from cryptography.exceptions import InvalidSignature
+        from cryptography.hazmat.primitives import hashes
+        from cryptography.hazmat.primitives.asymmetric import padding
+        try:
+            self.public_key.verify(base64.b64decode(sig), (ts + method + KALSHI_PREFIX + path).encode(),
+                                   padding.PKCS1v15(), hashes.SHA256())
+            return True
+        except (InvalidSignature, ValueError):
+            return False
+
+    def _kalshi(self, method, path, q, headers, body):
+        u = self.universe
+        if path == "/markets" and method == "GET":
+            return 200, self._kalshi_markets(q), {}
+        if path.startswith("/markets/") and path.endswith("/orderbook"):
+            book = u.kalshi_orderbook(path[len("/markets/"):-len("/orderbook")], int(q.get("depth", 10)))
+            return (200, _dumps({"orderbook": book}), {}) if book else (404, _dumps({"error": "market not found"}), {})
+        if not path.startswith("/portfolio/"):
+            return 404, _dumps({"error": "not found"}), {}
+        if not self._verify(method, path, headers):
+            return 401, _dumps({"error": {"code": "authentication_error", "message": "invalid signature"}}), {}
+
+        data = _loads(body) if body else {}
+        if path == "/portfolio/orders" and method == "POST":
+            order, error = u.place(data)
+            return (201, _dumps({"order": order}), {}) if order else (400, _dumps({"error": error}), {})
+        if path == "/portfolio/orders/batched" and method == "POST":
+            results = [u.place(spec) for spec in data.get("orders", [])]
+            return 201, _dumps({"orders": [{"order": o, "error": e} for o, e in results]}), {}
+        if path == "/portfolio/orders/batched" and method == "DELETE":
+            out = []
+            for oid in data.get("ids", []):
+                order = u.cancel(oid)
+                out.append({"order_id": oid, "order": order, "reduced_by": (order or {}).get("reduced_by", 0),
+                            "error": None if order else {"code": "not_found", "message": "order not found"}})
+            return 200, _dumps({"orders": out}), {}
+        if path == "/portfolio/orders" and method == "GET":
+            orders = [o for o in u.orders.values()
+                      if q.get("status") in (None, o["status"]) and q.get("ticker") in (None, o["ticker"])]
+            start, limit = int(q.get("cursor") or 0), int(q.get("limit", 100))
+            page = orders[start:start + limit]
+            cursor = str(start + limit) if start + limit < len(orders) else ""
+            return 200, _dumps({"orders": page, "cursor": cursor}), {}
+        if path.startswith("/portfolio/orders/"):
+            oid = path[len("/portfolio/orders/"):]
+            order = u.orders.get(oid) if method == "GET" else u.cancel(oid) if method == "DELETE" else None
+            if order is None:
+                return 404, _dumps({"error": {"code": "not_found"}}), {}
+            return 200, _dumps({"order": order, "reduced_by": order.get("reduced_by", 0)}), {}
+        return 404, _dumps({"error": "not found"}), {}
+
+    def _kalshi_markets(self, q):
+        u = self.universe
+        limit = min(int(q.get("limit", 100)), self.config.max_page)
+        start = int(q.get("cursor") or 0)
+        idx = None
+        if any(k in q for k in ("event_ticker", "series_ticker", "min_close_ts", "max_close_ts")):
+            mask = np.ones(len(u.k_rows), dtype=bool)
+            if "min_close_ts" in q:
+                mask &= u.k_close_ts >= float(q["min_close_ts"])
+            if "max_close_ts" in q:
+                mask &= u.k_close_ts <= float(q["max_close_ts"])
+            if "event_ticker" in q:
+                e = q["event_ticker"].rsplit("-", 1)[-1]
+                mask &= u.k_event == (int(e) if e.isdigit() else -1)
+            if "series_ticker" in q and q["series_ticker"] != "KXMOCK":
+                mask[:] = False
+            idx = np.flatnonzero(mask)
+        total = len(u.k_rows) if idx is None else len(idx)
+        sel = range(start, min(start + limit, total))
+        rows = [u.k_encoded[i] for i in sel] if idx is None else [u.k_encoded[idx[i]] for i in sel]
+        cursor = str(start + limit) if start + limit < total else ""
+        return b'{"markets":[' + b",".join(rows) + b'],"cursor":' + _dumps(cursor) + b"}"
+
+    def _gamma_events(self, q):
+        u = self.universe
+        limit = min(int(q.get("limit", 100)), self.config.max_page)
+        offset = int(q.get("offset", 0))
+        if q.get("closed") == "true":
+            return b"[]"
+        mask = np.ones(len(u.p_events), dtype=bool)
+        if "volume_min" in q:
+            mask &= u.p_volume >= float(q["volume_min"])
+        for key, op in (("end_date_min", np.greater_equal), ("end_date_max", np.less_equal)):
+            if key in q:
+                mask &= op(u.p_close_ts, datetime.fromisoformat(q[key].replace("Z", "+00:00")).timestamp())
+        idx = np.flatnonzero(mask)[offset:offset + limit]
+        return b"[" + b",".join(u.p_encoded[i] for i in idx) + b"]"
+
+    # WebSocket market channel
+
+    async def _websocket(self, reader, writer, headers):
+        accept = base64.b64encode(hashlib.sha1(headers["sec-websocket-key"].encode() + _WS_GUID).digest()).decode()
+        writer.write(("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                      f"Sec-WebSocket-Accept: {accept}\r\n\r\n").encode())
+        self._pending[writer] = []
+        subscribed = set()
+        try:
+            while True:
+                opcode, payload = await ws_read(reader)
+                if opcode == 0x8:
+                    writer.write(_ws_frame(b"", 0x8))
+                    return
+                if opcode == 0x9:
+                    writer.write(_ws_frame(payload, 0xA))
+                    continue
+                if opcode != 0x1 or payload in (b"PING", b"ping"):
+                    if payload in (b"PING", b"ping"):
+                        writer.write(_ws_frame(b"PONG"))
+                    continue
+                msg = _loads(payload)
+                assets = [str(a) for a in msg.get("assets_ids", []) if str(a) in self.universe.tokens]
+                snapshots = []
+                for token in assets:
+                    if token not in subscribed:
+                        subscribed.add(token)
+                        self._subs.setdefault(token, set()).add(writer)
+                        snapshots.append({"event_type": "book", **self.universe.clob_book(token)})
+                if snapshots:
+                    writer.write(_ws_frame(_dumps(snapshots)))
+                    await writer.drain()
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            for token in subscribed:
+                self._subs.get(token, set()).discard(writer)
+            self._pending.pop(writer, None)
+
+    async def _tick_loop(self):
+        u, cfg = self.universe, self.config
+        carry = 0.0
+        all_keys = list(u.k_index) + u.token_list
+        while True:
+            started = time.perf_counter()
+            carry += cfg.updates_per_sec * cfg.tick_s
+            n, carry = int(carry), carry - int(carry)
+            if n and all_keys:
+                # Half the flow on subscribed tokens so WS clients see a busy tape
+                hot = list(self._subs) if self._subs else []
+                picks = [hot[i] for i in u.rng.integers(0, len(hot), n // 2)] if hot else []
+                picks += [all_keys[i] for i in u.rng.integers(0, len(all_keys), n - len(picks))]
+                events = u.tick(picks)
+                self.updates += len(picks)
+                self._fan_out(events)
+            await asyncio.sleep(max(cfg.tick_s - (time.perf_counter() - started), 0))
+
+    def _fan_out(self, events):
+        pairs = self.universe.pairs
+        for yes, event in events:
+            if yes not in pairs:
+                continue
+            _, no, market = pairs[yes]
+            for token in (yes, no):
+                for writer in self._subs.get(token, ()):
+                    self._pending[writer].append({**event, "asset_id": token, "market": market})
+        for writer, pending in self._pending.items():
+            if not pending:
+                continue
+            if writer.transport.get_write_buffer_size() > 8 << 20:
+                logger.warning("[MOCK] Dropping slow WebSocket consumer (8 MB backlog).")
+                writer.close()
+            else:
+                writer.write(_ws_frame(_dumps(pending)))
+                self.messages += len(pending)
+            self._pending[writer] = []
+
+def generate_kalshi_key(path=None):
+    """RSA key pair for signing against the mock; writes the private PEM to `path` for KALSHI_PRIVATE_KEY_PATH."""
+    from cryptography.hazmat.primitives import serialization
+    from cryptography.hazmat.primitives.asymmetric import rsa
+    key = rsa.generate_private_key(public_exponent=65537, key_size=2048)
+    pem = key.private_bytes(serialization.Encoding.PEM, serialization.PrivateFormat.PKCS8, serialization.NoEncryption())
+    if path:
+        os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+        with open(path, "wb") as f:
+            f.write(pem)
+    return key, pem
+
+if __name__ == "__main__":
+    import argparse
+    parser = argparse.ArgumentParser(description="Local mock of the Kalshi, Gamma and CLOB APIs")
+    parser.add_argument("--port", type=int, default=8900)
+    parser.add_argument("--key-out", default="data/mock-kalshi-key.pem", help="private key clients should sign with")
+    parser.add_argument("--bench", action="store_true", help="run a load test against an in-process server and exit")
+    for name, default in vars(MockConfig()).items():
+        if isinstance(default, bool):
+            parser.add_argument(f"--{name.replace('_', '-')}", type=lambda s: s.lower() in ("1", "true", "yes"), default=default)
+        else:
+            parser.add_argument(f"--{name.replace('_', '-')}", type=type(default), default=default)
+    args = parser.parse_args()
+    config = MockConfig(**{k: getattr(args, k) for k in vars(MockConfig())})
+
+    async def serve():
+        key, _ = generate_kalshi_key(args.key_out)
+        server = await MockVenueServer(config, port=args.port, public_key=key.public_key()).start()
+        for k, v in server.client_env().items():
+            print(f"export {k}={v}")
+        print(f"export KALSHI_PRIVATE_KEY_PATH={args.key_out} KALSHI_API_KEY_ID=mock")
+        await asyncio.Event().wait()
+
+    async def bench():
+        # Full listing through the real clients, then a WS subscriber counting book updates
+        key, pem = generate_kalshi_key()
+        server = await MockVenueServer(config, port=0, public_key=key.public_key()).start()
+        os.environ.update(server.client_env())
+        from src.api.kalshi import KalshiClient
+        from src.api.polymarket import PolymarketClient
+        from src.api.filters import MarketFilter
+        kalshi, poly = KalshiClient(), PolymarketClient()
+        for client in (kalshi, poly):
+            client.limiter.LIMITS = {k: (1e9, 1e9) for k in client.limiter.LIMITS}
+
+        start = time.perf_counter()
+        markets = await asyncio.to_thread(kalshi.get_markets, market_filter=MarketFilter(page_size=1000, max_pages=10**6))
+        k_s = time.perf_counter() - start
+        start = time.perf_counter()
+        events = await asyncio.to_thread(poly.get_markets, market_filter=MarketFilter(page_size=1000, max_pages=10**6))
+        p_s = time.perf_counter() - start
+        print(f"Kalshi /markets: {len(markets)} markets in {k_s:.2f}s ({len(markets) / k_s:,.0f}/s)")
+        print(f"Gamma /events:   {len(events)} events in {p_s:.2f}s ({len(events) / p_s:,.0f}/s)")
+
+        reader, writer = await ws_connect(server.host, server.port)
+        ws_send(writer, {"type": "market", "assets_ids": server.universe.token_list[:500]})
+        server.updates, received, start = 0, 0, time.perf_counter()
+        while time.perf_counter() - start < 5.0:
+            opcode, payload = await ws_read(reader)
+            if opcode == 0x1:
+                received += len(_loads(payload))
+        elapsed = time.perf_counter() - start
+        print(f"Book updates generated: {server.updates / elapsed:,.0f}/s; WS events received: {received / elapsed:,.0f}/s")
+        writer.close()
+        await server.stop()
+
+    asyncio.run(bench() if args.bench else serve())
@@ -1,8 +1,20 @@
-import time
 import os
+import sys
+import re
 import asyncio
+from datetime import date
 from src.utils import logger
 from src.scanner import MarketScanner
+from src.prioritizer import CandidatePrioritizer
+from src.kill_switch import KillSwitch
+from src.stages import StagePipeline
+from src.sharding import ShardWorker, RiskService
+from src.checkpoint import CheckpointStore
+from src.execution import ExecutionEngine, PairedExecutor, KalshiVenue, PolymarketVenue, FillEstimator, SliceScheduler, MarketMaker
+from src.sim import SimVenue, FeedWriter
+from src.api.ratelimit import rate_limiter
+from src.startup import profiler
+from src.compute import ComputeExecutor, SharedArray, monte_carlo_var
 from skills.research.scripts.research import ResearcherAgent
 from skills.research.scripts.scrapers import NewsScraper
 from skills.research.scripts.twitter import TwitterScraper
@@ -13,14 +25,19 @@ from skills.compound.scripts.history import TradeLogger
 
 # Set up dummy state for local simulation testing
 class TradingBotOrchestrator:
-    def __init__(self):
+    def __init__(self, shard=None, risk_service=None):
         self.scanner = MarketScanner()
+        self.prioritizer = CandidatePrioritizer()
         self.researcher = ResearcherAgent()
         self.news_scraper = NewsScraper()
         self.twitter_scraper = TwitterScraper()
         self.predictor = PredictorAgent()
         self.risk_manager = RiskValidator()
-        self.arbitrage_scanner = ArbitrageScanner()
+        # One fetch + normalization per sweep, read by both the candidate scan and the arbitrage scan
+        self.market_data = self.scanner.market_data
+        self.arbitrage_scanner = ArbitrageScanner(self.market_data)
+        # Cross-venue pairs checked by hand to resolve on the same event (JSON list of "poly_id|kalshi_ticker")
+        self.arbitrage_scanner.load_verified(os.getenv("ARB_VERIFIED_PAIRS") or "data/verified_pairs.json")
         self.trade_logger = TradeLogger()
         
         self.bankroll = 10000.0
@@ -29,12 +46,126 @@ class TradingBotOrchestrator:
         self.concurrent_positions = 0
         self.daily_api_spend = 0.0
         self.api_budget_ceiling = 50.0 # From Beast Mode architecture
+        self.open_positions = []       # {"legs", "stake", "price", "p_model"}: legs settle it, the rest feeds VaR
+        self.peak_bankroll = self.bankroll
+        self.daily_pnl = 0.0           # Realized today, from settled positions, plus the day's market-making marks
+        self.mm_pnl = 0.0              # Market-making inventory at fair value, as of the last mark
+        self.pnl_day = date.today().isoformat()
+
+        # CPU-bound kernels (normalization, VaR) run here instead of on the event loop
+        self.compute = ComputeExecutor()
+        self.market_data.compute = self.compute
+
+        # Sharded mode: this worker only handles markets it owns on the hash ring and
+        # every risk decision goes through the one shared RiskService
+        self.shard = shard
+        self.risk_service = risk_service
+
+        # Limit orders with the PRD 2% slippage guard; tracks every order until filled or cancelled.
+        # The PRD wants two weeks of paper trading first: real order entry needs LIVE_TRADING=1
+        self.LIVE_TRADING = os.getenv("LIVE_TRADING") == "1"
+        venues = [KalshiVenue(self.scanner.aggregator.kalshi), PolymarketVenue(self.scanner.aggregator.poly)]
+        self.recorder = None
+        if not self.LIVE_TRADING:
+            # Paper mode: live books, simulated fills; the books read are kept for replay
+            self.recorder = FeedWriter(self._feed_path())
+            venues = [SimVenue(v.name, source=v, recorder=self.recorder) for v in venues]
+            logger.info(f"[SIM] Paper trading: orders fill against a simulated book, feed -> {self.recorder.path} "
+                        f"(LIVE_TRADING=1 to trade).")
+        self.execution = ExecutionEngine(venues)
+        # Pre-trade fill/slippage estimates from the book, fed into sizing
+        self.fill_estimator = FillEstimator()
+        # Parent orders larger than the touch, sliced into child orders on this loop
+        self.slicer = SliceScheduler(self.execution, self.fill_estimator)
+        # Arbitrage legs go out together; a leg that lags is chased, then unwound
+        self.paired = PairedExecutor(self.execution)
+        # MARKET_MAKING=n: quote both sides of up to n wide-spread markets, inventory capped by the risk limits
+        self.MM_MARKETS = int(os.getenv("MARKET_MAKING") or 0)
+        self.market_maker = MarketMaker(self.execution, self.risk_manager, self.bankroll) if self.MM_MARKETS else None
+        self._mm_mark = None
+        if self.market_maker:
+            self.market_maker.on_fill = self._on_mm_fill
+
+        # STOP file (inotify), SIGUSR1 or POST 127.0.0.1:$KILL_SWITCH_PORT/halt. Sharded workers share a host,
+        # so worker "w3" defaults to 8768; a worker id without a number binds any free port (logged at startup)
+        port = os.getenv("KILL_SWITCH_PORT")
+        if port is None:
+            digits = re.search(r"(\d+)$", shard.worker_id) if shard else None
+            port = str(8765 + int(digits.group(1))) if digits else "0" if shard else "8765"
+        self.kill_switch = KillSwitch("STOP", http_port=int(port) if port else None)
+        self.kill_switch.on_halt(self.cancel_resting_orders)
+
+        # Warm restart: caches, portfolio and sweep progress survive container restarts
+        self.checkpoint = CheckpointStore(f"data/checkpoint-{shard.worker_id}.db" if shard else "data/checkpoint.db")
+        self.SNAPSHOT_MAX_AGE = 900    # Reuse a market snapshot younger than one sweep interval
+        self.SWEEP_MAX_AGE = 3600      # Drop interrupted sweeps older than this
+        self.LLM_CACHE_TTL = 3600      # Reuse research + prediction for an unchanged price within this window
+        self._warm_start = True
+        self.restore_state()
+
+    def restore_state(self):
+        state = self.checkpoint.get("portfolio", "state")
+        if state:
+            self.bankroll = state["bankroll"]
+            self.current_drawdown = state["current_drawdown"]
+            self.peak_bankroll = state.get("peak_bankroll", self.bankroll)
+            positions = state.get("open_positions", [])
+            # Older checkpoints kept bare [stake, price, p_model] rows, which can't be matched to a market to settle
+            self.open_positions = [p for p in positions if isinstance(p, dict)]
+            if len(self.open_positions) < len(positions):
+                logger.warning(f"Dropped {len(positions) - len(self.open_positions)} restored position(s) without market ids.")
+            # The slot count follows the positions actually held; a checkpointed counter would keep
+            # reservations from a crash mid-order and never come back down
+            self.concurrent_positions = len(self.open_positions)
+            if state["day"] == date.today().isoformat():
+                self.daily_api_spend = state["daily_api_spend"]
+                self.daily_loss = state["daily_loss"]
+                self.daily_pnl = state.get("daily_pnl", 0.0)
+            logger.info(f"Restored portfolio state: bankroll ${self.bankroll:.2f}, {self.concurrent_positions} open positions.")
+        if self.risk_service:
+            # Drops whatever this worker had reserved before it restarted
+            self.risk_service.sync_positions(len(self.open_positions))
+            self._apply_risk_snapshot(self.risk_service.snapshot())
+        self.arbitrage_scanner.pairs = self.checkpoint.get("arbitrage", "pairs", default={})
+        self.checkpoint.prune("llm", self.LLM_CACHE_TTL)
+
+    def _apply_risk_snapshot(self, snapshot):
+        # Sharded mode: bankroll and limits are the RiskService's, the same for every worker
+        self.bankroll = snapshot["bankroll"]
+        self.daily_loss, self.current_drawdown = snapshot["daily_loss_pct"], snapshot["drawdown_pct"]
+
+    def save_state(self):
+        self.checkpoint.put("portfolio", "state", {
+            "bankroll": self.bankroll,
+            "current_drawdown": self.current_drawdown,
+            "daily_loss": self.daily_loss,
+            "open_positions": self.open_positions,
+            "peak_bankroll": self.peak_bankroll,
+            "daily_pnl": self.daily_pnl,
+            "daily_api_spend": self.daily_api_spend,
+            "day": date.today().isoformat(),
+        })
 
     def check_kill_switch(self):
-        if os.path.exists("STOP"):
-            logger.critical("KILL SWITCH ENGAGED! STOP file detected.")
-            return True
-        return False
+        # In-memory flag flipped by the watcher threads; cheap enough for every hot path
+        return self.kill_switch.engaged
+
+    async def cancel_resting_orders(self):
+        """Halt callback: pull every resting order we have on the venues."""
+        parents = self.slicer.cancel_all("kill switch")
+        if parents:
+            logger.critical(f"Kill switch: {parents} sliced parent order(s) stopped.")
+        if self.market_maker:
+            quotes = await self.market_maker.stop(reason="kill switch")
+            logger.critical(f"Kill switch: {quotes} market-making quote(s) pulled.")
+        working = await self.execution.cancel_all("kill switch")
+        logger.critical(f"Kill switch: {working} working order(s) pulled by the execution engine.")
+        if not self.LIVE_TRADING:
+            return      # Paper orders never reached the exchange; leave the account's real orders alone
+        kalshi = self.scanner.aggregator.kalshi
+        cancelled = await asyncio.to_thread(kalshi.cancel_all_orders)
+        logger.critical(f"Kill switch mass-cancel: {cancelled} Kalshi order(s) cancelled.")
+        # Polymarket orders live on the CLOB, which needs L2 credentials we don't wire up yet
 
     async def run_pipeline(self):
         logger.info("============== PIPELINE START ==============")
@@ -45,104 +176,620 @@ class TradingBotOrchestrator:
         # BULLETPROOF CHECK 1: Ensure AI budget is safe
         if self.daily_api_spend >= self.api_budget_ceiling:
             logger.warning(f"AI Budget exceeded (${self.daily_api_spend:.2f} >= ${self.api_budget_ceiling:.2f}). Sleeping till tomorrow.")
-            await asyncio.sleep(86400) # Sleep for a day
+            if await self.kill_switch.sleep(86400): # Sleep for a day
+                return
             self.daily_api_spend = 0.0
             
-        # BULLETPROOF CHECK 2: Arbitrage mathematical superiority
-        arbs = await self.arbitrage_scanner.scan_overlapping_strikes()
-        if arbs:
-            logger.info(f"Executing Risk-Free Arbitrage instead of AI Prediction. Override triggered.")
-            return
+        if self.shard:
+            await asyncio.to_thread(self.shard.refresh)
+        if self.risk_service:
+            # Other workers' settlements move the shared bankroll
+            self._apply_risk_snapshot(await asyncio.to_thread(self.risk_service.snapshot))
 
-        # STEP 1: SCAN
-        candidates = self.scanner.scan()
-        if not candidates:
-            logger.info("No candidate markets found.")
-            return
+        # Resolved markets free their position slots and feed realized P&L into the loss limits
+        await self.settle_positions()
+        if self.market_maker:
+            await self.mark_market_making()
+
+        # Right after a restart, a recent snapshot stands in for the first full fetch
+        snapshot = self.checkpoint.get("markets", "snapshot", max_age=self.SNAPSHOT_MAX_AGE) if self._warm_start else None
+        self.market_data.new_sweep(snapshot)
             
-        logger.info(f"Processing {len(candidates)} candidates.")
+        # BULLETPROOF CHECK 2: Arbitrage mathematical superiority
+        # (cross-venue scan is global, so in sharded mode only one worker runs it)
+        if not self.shard or self.shard.owns_key("arbitrage"):
+            arbs = await self.scan_arbitrage()
+            self.checkpoint.put("arbitrage", "pairs", self.arbitrage_scanner.pairs)
+            if arbs and await self.execute_arbitrage(arbs):
+                logger.info("Arbitrage executed; skipping the AI prediction sweep this cycle.")
+                return
+
+        # STEP 1: SCAN (or pick up the sweep a restart interrupted)
+        sweep = self.checkpoint.get("pipeline", "sweep", max_age=self.SWEEP_MAX_AGE)
+        if sweep and sweep["next"] < len(sweep["candidates"]):
+            candidates, start = sweep["candidates"], sweep["next"]
+            logger.info(f"Resuming interrupted sweep at candidate {start + 1}/{len(candidates)}.")
+        else:
+            candidates, start = await self._scan_candidates(), 0
+            if not candidates:
+                logger.info("No candidate markets found.")
+                return
+        self._warm_start = False
+        if self.market_maker:
+            await self.start_market_making(candidates)
+        logger.info(f"Processing {len(candidates) - start} candidates.")
         
-        for target in candidates:
+        halted = False
+        for i in range(start, len(candidates)):
+            target = candidates[i]
             # Re-check kill switch in deep loop
             if self.check_kill_switch():
+                halted = True
                 break
                 
-            logger.info(f"Target selected: {target['title']} on {target['platform']}")
-            
-            # STEP 2: RESEARCH
-            news = self.news_scraper.fetch_news(target['title'], limit=3)
-            tweets = self.twitter_scraper.fetch_recent_tweets(target['title'], limit=3)
-            brief = self.researcher.analyze(target['title'], news, tweets)
-            
-            logger.info(f"Research compiled.")
+            if self.daily_api_spend + self.prioritizer.EST_LLM_COST_PER_EVAL > self.api_budget_ceiling:
+                logger.warning(f"AI Budget exhausted (${self.daily_api_spend:.2f}). Skipping remaining candidates.")
+                break
+                
+            logger.info(f"Target selected: {target['title']} on {target['platform']} (score {target['priority_score']:.1f})")
             
-            # STEP 3: PREDICT
-            prediction = await self.predictor.evaluate_edge(target['title'], target['price']/100.0, brief)
+            # STEP 2 + 3: RESEARCH & PREDICT (cancelled mid-flight if the kill switch fires)
+            try:
+                brief, prediction = await self.kill_switch.track(self._research_and_predict(target))
+            except asyncio.CancelledError:
+                if not self.check_kill_switch():
+                    raise
+                logger.critical("In-flight research/prediction cancelled by kill switch.")
+                halted = True
+                break
             logger.info(f"Model Edge: {prediction['edge']:.4f}")
+            if self.market_maker:
+                # Quoted markets take the ensemble's probability as fair value instead of the book mid
+                market_id = target.get('token_id') if target['platform'] == 'polymarket' else target['id']
+                self.market_maker.set_fair(target['platform'], market_id, prediction['p_model'])
             
-            if prediction['signal'] == "TRADE":
+            if prediction['signal'] == "TRADE" and not self.check_kill_switch():
+                if self.market_maker:
+                    # The limits this trade is checked against include the quoting book's latest marks
+                    await self.mark_market_making()
                 # STEP 4: RISK & EXECUTE
-                allowed, msg, size = self.risk_manager.validate(
-                    p_model=prediction['p_model'],
-                    p_market=prediction['p_market'],
-                    bankroll=self.bankroll,
-                    current_daily_loss_pct=self.daily_loss,
-                    current_drawdown_pct=self.current_drawdown,
-                    concurrent_positions=self.concurrent_positions,
-                    daily_api_spend=self.daily_api_spend
-                )
-            
-                if allowed:
-                    logger.info(f"TRADE APPROVED! Executing Limit Order for ${size:.2f}")
-                    
-                    try:
-                        # In a real environment, you must handle size scaling per exchange rules.
-                        if target['platform'] == 'polymarket':
-                            logger.warning(f"LIVE EXECUTION TRIGGERED: Buying {size} on Polymarket for {target['id']}")
-                        elif target['platform'] == 'kalshi':
-                            logger.warning(f"LIVE EXECUTION TRIGGERED: Buying {size} on Kalshi for {target['id']}")
-                            
-                        self.concurrent_positions += 1
-                        
-                        # Log the trade to DB
-                        self.trade_logger.log_trade(
-                            market_id=target['id'],
-                            market_title=target['title'],
-                            platform=target['platform'],
-                            action="BUY",
-                            price=prediction['p_market'],
-                            size=size,
-                            model_edge=prediction['edge'],
-                            research_brief=brief
-                        )
-                    except Exception as e:
-                        logger.error(f"Execution Failed: {e}")
-                        
-                else:
-                    logger.warning(f"Trade rejected by Risk Manager: {msg}")
+                await self.risk_and_execute(target, prediction, brief)
             else:
                 logger.info("Signal is WAIT. Edge is insufficient.")
                 
+            self.checkpoint.put("pipeline", "sweep", {"candidates": candidates, "next": i + 1})
+            self.save_state()
+            if self.recorder:
+                # The paper feed is as durable as the checkpoint
+                self.recorder.flush()
+                
             # Polite sleep to prevent LLM rate limiting (HTTP 429)
-            time.sleep(3.0)
+            if await self.kill_switch.sleep(3.0):
+                halted = True
+                break
             
+        if not halted:
+            self.checkpoint.delete("pipeline", "sweep")
         logger.info("============== PIPELINE COMPLETE ==============")
 
+    async def _scan_candidates(self):
+        if self.market_data.seeded:
+            logger.info("Warm start: scanning persisted market snapshot.")
+        else:
+            logger.info("Starting scan...")
+        
+        # Shares the venue fetches (and the compute-pool normalization) the arbitrage scan already triggered
+        candidates = await self.market_data.acandidates()
+        logger.info(f"Sweep transfer: {self.market_data.report()}")
+        if not self.market_data.seeded:
+            self.checkpoint.put("markets", "snapshot", await self.market_data.araw_markets())
+        logger.info(f"Scan complete. Found {len(candidates)} valid candidate markets.")
+        if not candidates:
+            return []
+            
+        if self.shard:
+            candidates = self.shard.filter(candidates)
+            
+        # Dispatch in expected-value-per-dollar order so the AI budget hits the best markets first
+        candidates = self.prioritizer.top_k(candidates)
+        # raw_data is only needed for normalization; keep the checkpointed sweep small
+        candidates = [{k: v for k, v in c.items() if k != "raw_data"} for c in candidates]
+        self.checkpoint.put("pipeline", "sweep", {"candidates": candidates, "next": 0})
+        return candidates
+
+    async def start_market_making(self, candidates):
+        """Quotes the widest wide-spread markets on venues we can trade, up to MM_MARKETS at a time."""
+        if self.check_kill_switch() or self._mm_limit_breached():
+            return
+        self.market_maker.set_bankroll(self.bankroll)
+        free = self.MM_MARKETS - self.market_maker.metrics()["markets"]
+        wide = []
+        for target in candidates:
+            market_id = target.get('token_id') if target['platform'] == 'polymarket' else target['id']
+            venue = self.execution.venues.get(target['platform'])
+            if (target.get('anomaly_flag') == "wide_spread" and venue and venue.tradeable
+                    and (target['platform'], market_id) not in self.market_maker.markets):
+                wide.append((target['spread'], target['platform'], market_id, target['title']))
+        for _, platform, market_id, title in sorted(wide, reverse=True)[:max(free, 0)]:
+            try:
+                await self.market_maker.quote(platform, market_id)
+            except Exception as e:
+                logger.warning(f"[MM] Not quoting {title}: {e}")
+
+    async def risk_and_execute(self, target, prediction, brief):
+        if self.risk_service:
+            # Global limits: the check and the position booking are one atomic step
+            allowed, msg, size = await asyncio.to_thread(
+                self.risk_service.reserve, prediction['p_model'], prediction['p_market']
+            )
+        else:
+            allowed, msg, size = self.risk_manager.validate(
+                p_model=prediction['p_model'],
+                p_market=prediction['p_market'],
+                bankroll=self.bankroll,
+                current_daily_loss_pct=self.daily_loss,
+                current_drawdown_pct=self.current_drawdown,
+                concurrent_positions=self.concurrent_positions,
+                daily_api_spend=self.daily_api_spend
+            )
+    
+        # Polymarket rows are outcome tokens; Kalshi rows are tickers (buying YES)
+        market_id = target.get('token_id') if target['platform'] == 'polymarket' else target['id']
+        if allowed:
+            # Liquidity Check: the edge must survive the expected fill. The slicer still gets the full
+            # Kelly size; what the book can't take at once is worked as clips inside the same band
+            allowed, msg, _ = await self.validate_fill(target['platform'], market_id, prediction, size)
+            if not allowed and self.risk_service:
+                await asyncio.to_thread(self.risk_service.release_position)
+
+        if allowed:
+            # VaR Check (PRD): simulate the book including this trade before committing to it
+            var_usd = await self.portfolio_var([size, prediction['p_market'], prediction['p_model']])
+            allowed, msg = self.risk_manager.validate_var(var_usd, self.bankroll)
+            if not allowed and self.risk_service:
+                await asyncio.to_thread(self.risk_service.release_position)
+            
+        if allowed:
+            logger.info(f"TRADE APPROVED! Executing Limit Order for ${size:.2f}")
+            booked = False
+            try:
+                # Sizes beyond the touch are worked as iceberg clips instead of walking the book.
+                # Every child stays inside the slippage guard and never pays away the minimum edge
+                reference = prediction['p_market']
+                band = min(self.risk_manager.MAX_SLIPPAGE,
+                           (prediction['p_model'] - self.risk_manager.MIN_EDGE - reference) / reference)
+                order = await self.slicer.execute(
+                    target['platform'], market_id, side="yes",
+                    notional_usd=size, reference_price=reference, max_slippage=max(band, 0.0),
+                )
+                if order.filled:
+                    filled_usd = order.notional
+                    self.concurrent_positions += 1
+                    self.open_positions.append({
+                        "legs": [{"venue": target['platform'], "market_id": market_id, "side": "yes",
+                                  "contracts": order.filled}],
+                        "stake": filled_usd, "price": order.avg_price, "p_model": prediction['p_model'],
+                    })
+                    booked = True
+                    
+                    # Log the trade to DB
+                    self.trade_logger.log_trade(
+                        market_id=target['id'],
+                        market_title=target['title'],
+                        platform=target['platform'],
+                        action="BUY",
+                        price=order.avg_price,
+                        size=filled_usd,
+                        model_edge=prediction['edge'],
+                        research_brief=brief
+                    )
+                else:
+                    logger.warning(f"Order on {target['id']} ended {order.state} without fills: {order.reason}")
+                    if self.risk_service:
+                        await asyncio.to_thread(self.risk_service.release_position)
+            except Exception as e:
+                logger.error(f"Execution Failed: {e}")
+                # The reservation only stands for a position that was actually booked
+                if self.risk_service and not booked:
+                    await asyncio.to_thread(self.risk_service.release_position)
+
+        else:
+            logger.warning(f"Trade rejected by Risk Manager: {msg}")
+
+    async def validate_fill(self, venue, market_id, prediction, size):
+        """
+        Runs RiskValidator.validate_fill on the venue's current book, with the market's recent
+        prints fed into the estimator's trade flow first. Without a book the engine decides.
+        """
+        adapter, flow = self.execution.venues[venue], self.fill_estimator.flow
+        book, trades = await asyncio.gather(
+            adapter.get_book(market_id, "yes"), adapter.get_trades(market_id, flow.last(market_id)),
+            return_exceptions=True)
+        if isinstance(trades, Exception):
+            logger.warning(f"[EXEC] No recent trades for {market_id}: {trades}")
+        else:
+            flow.extend(market_id, trades)
+        if isinstance(book, Exception):
+            logger.warning(f"[EXEC] No book for the liquidity check on {market_id}: {book}")
+            return True, "APPROVED", size
+        allowed, msg, fill_size = self.risk_manager.validate_fill(
+            prediction['p_model'], prediction['p_market'], size, book, self.fill_estimator, market_id)
+        if allowed and fill_size < size - 0.01:
+            logger.info(f"Liquidity Check: ${fill_size:.2f} of ${size:.2f} expected at once, rest sliced ({msg})")
+        return allowed, msg, fill_size
+
+    async def scan_arbitrage(self):
+        """
+        Runs the cross-venue, basket and strike-ladder scans and returns every opportunity
+        whose legs can all be traded here (a read-only venue can still be scanned).
+        """
+        pair, baskets, ladders = await asyncio.gather(
+            self.arbitrage_scanner.scan_overlapping_strikes(),
+            self.arbitrage_scanner.scan_baskets(),
+            self.arbitrage_scanner.scan_strike_ladders(),
+        )
+        arbs = ([pair] if pair else []) + (baskets or []) + (ladders or [])
+        executable = []
+        for arb in arbs:
+            legs = self.arbitrage_scanner.execution_legs(arb)
+            if legs and all(getattr(self.execution.venues[l["venue"]], "tradeable", True) for l in legs):
+                executable.append(arb)
+        if len(executable) < len(arbs):
+            logger.info(f"[ARBITRAGE] {len(arbs) - len(executable)} of {len(arbs)} opportunities need a venue "
+                        f"that can't take orders; skipped.")
+        return executable
+
+    async def _reserve_arbitrage(self):
+        """Portfolio limits for one arbitrage set; in sharded mode the slot is booked globally."""
+        if self.risk_service:
+            return await asyncio.to_thread(self.risk_service.reserve, None, None, locked=True)
+        return self.risk_manager.validate_locked(
+            bankroll=self.bankroll,
+            current_daily_loss_pct=self.daily_loss,
+            current_drawdown_pct=self.current_drawdown,
+            concurrent_positions=self.concurrent_positions,
+            daily_api_spend=self.daily_api_spend,
+        )
+
+    async def execute_arbitrage(self, arbs):
+        """
+        Sends every leg of each arbitrage at once, sized to the single-position cap
+        (and to the depth the scanner found, when it sized the trade itself). Each
+        set takes a position slot like any other trade. Returns how many were executed.
+        """
+        executed = 0
+        for arb in (arbs if isinstance(arbs, list) else [arbs]):
+            if self.check_kill_switch():
+                break
+            legs = self.arbitrage_scanner.execution_legs(arb)
+            if not legs:
+                continue
+            allowed, msg, cap = await self._reserve_arbitrage()
+            if not allowed:
+                logger.warning(f"Arbitrage rejected by Risk Manager: {msg}")
+                break
+            legs = self.paired.size_legs(legs, cap)
+            depth = arb.get("size") or arb.get("count")
+            if depth:
+                legs = [dict(l, size=min(l["size"], depth)) for l in legs]
+            if not legs[0]["size"]:
+                logger.info("Arbitrage set costs more than the position cap; skipped.")
+                if self.risk_service:
+                    await asyncio.to_thread(self.risk_service.release_position)
+                continue
+            result = await self.paired.execute(legs)
+            sets = min(result["filled"])
+            if not (result["hedged"] and sets > 0):
+                if self.risk_service:
+                    await asyncio.to_thread(self.risk_service.release_position)
+                continue
+            executed += 1
+            cost = sum(o.filled * o.avg_price * (1 if o.action == "buy" else -1) for o in result["orders"])
+            # Pairs and ladders pay a fixed amount per set; NO baskets pay (n - 1)
+            payout = arb["payout"] / arb["size"] if arb.get("payout") else arb.get("payout_cents", 100) / 100
+            if payout <= 0:
+                logger.warning(f"Arbitrage set on '{arb.get('title', '')}' filled with no payout; booked as a loss.")
+            self.concurrent_positions += 1
+            self.open_positions.append({
+                "legs": [{"venue": l["venue"], "market_id": l["market_id"], "side": l["side"], "contracts": n}
+                         for l, n in zip(legs, result["filled"])],
+                # A locked payout: VaR sees a position that can't lose
+                "stake": cost, "price": cost / (sets * payout) if payout > 0 else 1.0, "p_model": float(payout > 0),
+            })
+            self.trade_logger.log_trade(
+                market_id=" + ".join(l["market_id"] for l in legs),
+                market_title=arb.get("title") or arb.get("event_ticker", ""),
+                platform="+".join(sorted({l["venue"] for l in legs})),
+                action="ARB",
+                price=cost / sets,
+                size=cost,
+                model_edge=payout - cost / sets,
+                research_brief=f"Paired execution, legs done in {result['completion_ms']:.0f} ms",
+            )
+        logger.info(f"Paired execution metrics: {self.paired.metrics()}")
+        return executed
+
+    @staticmethod
+    def _feed_path():
+        return f"data/feeds/paper-{date.today().strftime('%Y%m%d')}.jsonl"
+
+    async def settle_positions(self):
+        """Closes every open position whose markets have all resolved."""
+        today = date.today().isoformat()
+        if today != self.pnl_day:
+            self.pnl_day, self.daily_pnl, self.daily_loss = today, 0.0, 0.0
+        if self.recorder and self.recorder.path != self._feed_path():
+            # One paper feed per day, like the daily P&L: a long run doesn't pile every day into the first file
+            self.recorder.reopen(self._feed_path())
+            logger.info(f"[SIM] Paper feed -> {self.recorder.path}")
+        still_open = []
+        for position in self.open_positions:
+            payout = 0.0
+            for leg in position["legs"]:
+                try:
+                    value = await self.execution.venues[leg["venue"]].get_settlement(leg["market_id"], leg["side"])
+                except Exception as e:
+                    logger.warning(f"Settlement check failed for {leg['market_id']}: {e}")
+                    value = None
+                if value is None:
+                    break
+                payout += leg["contracts"] * value
+            else:
+                await self._close_position(position, payout)
+                continue
+            still_open.append(position)
+        self.open_positions = still_open
+        if self.market_maker:
+            await self._settle_market_making()
+
+    async def _settle_market_making(self):
+        """Resolved quoted markets: the inventory is paid out and leaves the book and the VaR rows."""
+        for venue, market_id in list(self.market_maker.markets):
+            try:
+                payouts = [await self.execution.venues[venue].get_settlement(market_id, side) for side in ("yes", "no")]
+            except Exception as e:
+                logger.warning(f"Settlement check failed for {market_id}: {e}")
+                continue
+            if None in payouts:
+                continue
+            state = self.market_maker.markets[(venue, market_id)]
+            mark, cost = self.market_maker.pnl(state), state["cost"]
+            pnl = await self.market_maker.settle(venue, market_id, *payouts)
+            # The last mark is already in today's P&L; only the move from it to the payout is new
+            self.daily_pnl += pnl - mark
+            self.mm_pnl -= mark
+            if self.risk_service:
+                self.daily_loss, self.current_drawdown, self.bankroll = await asyncio.to_thread(
+                    self.risk_service.realize_unrealized, pnl, self.mm_pnl)
+            else:
+                self.bankroll += pnl
+                self._update_limits()
+            logger.info(f"[MM] {market_id} resolved: inventory settled for {pnl:+.2f} (last mark {mark:+.2f}).")
+            self.trade_logger.log_trade(
+                market_id=market_id,
+                market_title="",
+                platform=venue,
+                action="SETTLE",
+                price=(cost + pnl) / cost if cost else 0.0,
+                size=cost + pnl,
+                model_edge=pnl,
+            )
+
+    async def _close_position(self, position, payout):
+        pnl = payout - position["stake"]
+        self.daily_pnl += pnl
+        self.concurrent_positions = max(self.concurrent_positions - 1, 0)
+        if self.risk_service:
+            self.daily_loss, self.current_drawdown, self.bankroll = await asyncio.to_thread(
+                self.risk_service.close_position, pnl)
+        else:
+            self.bankroll += pnl
+            self._update_limits()
+        markets = " + ".join(leg["market_id"] for leg in position["legs"])
+        logger.info(f"Settled {markets}: paid ${payout:.2f} on ${position['stake']:.2f} staked (P&L {pnl:+.2f}); "
+                    f"daily loss {self.daily_loss:.2%}, drawdown {self.current_drawdown:.2%}.")
+        self.trade_logger.log_trade(
+            market_id=markets,
+            market_title="",
+            platform="+".join(sorted({leg["venue"] for leg in position["legs"]})),
+            action="SETTLE",
+            price=payout / position["stake"] if position["stake"] else 0.0,
+            size=payout,
+            model_edge=pnl,
+        )
+
+    def _update_limits(self):
+        """Local daily loss and drawdown, on equity: the bankroll plus market-making inventory at fair value."""
+        equity = self.bankroll + self.mm_pnl
+        self.peak_bankroll = max(self.peak_bankroll, equity)
+        start = equity - self.daily_pnl
+        # Same guards as RiskService._book_limits: a day that started with nothing left has lost all of it
+        self.daily_loss = max(-self.daily_pnl, 0.0) / start if start > 0 else float(self.daily_pnl < 0)
+        self.current_drawdown = (self.peak_bankroll - equity) / self.peak_bankroll if self.peak_bankroll > 0 else 0.0
+
+    def _mm_limit_breached(self):
+        return (self.daily_loss >= self.risk_manager.MAX_DAILY_LOSS_PCT
+                or self.current_drawdown >= self.risk_manager.MAX_DRAWDOWN_PCT)
+
+    def _on_mm_fill(self, state, side, qty, price):
+        """Market-making fill: logged like any other trade, then marked into the loss limits."""
+        # A NO bid fills as a YES sale at 1 - price (the matcher's view), so the log stays in YES terms
+        action, yes_price = ("BUY", price) if side == "yes" else ("SELL", round(1 - price, 6))
+        self.trade_logger.log_trade(
+            market_id=state["market_id"],
+            market_title="",
+            platform=state["venue"],
+            action=action,
+            price=yes_price,
+            size=qty * yes_price,
+            model_edge=(state["fair"] - price) if side == "yes" else (1 - state["fair"] - price),
+            research_brief=f"Market making: {side.upper()} quote filled, fair {state['fair']:.3f}",
+        )
+        if self._mm_mark is None or self._mm_mark.done():
+            self._mm_mark = asyncio.create_task(self.mark_market_making())
+
+    async def mark_market_making(self):
+        """Marks the quoting book to fair value into daily loss and drawdown; pulls every quote past a limit."""
+        pnl = self.market_maker.total_pnl()
+        self.daily_pnl += pnl - self.mm_pnl
+        self.mm_pnl = pnl
+        if self.risk_service:
+            self.daily_loss, self.current_drawdown, self.bankroll = await asyncio.to_thread(
+                self.risk_service.mark_unrealized, pnl)
+        else:
+            self._update_limits()
+        if self._mm_limit_breached() and self.market_maker.metrics()["markets"]:
+            quotes = await self.market_maker.stop(reason="loss limit")
+            logger.critical(f"[MM] Daily loss {self.daily_loss:.2%} / drawdown {self.current_drawdown:.2%} "
+                            f"at the limit: {quotes} quote(s) pulled, inventory marked at ${pnl:+.2f}.")
+
+    async def portfolio_var(self, proposed=None):
+        positions = [[p["stake"], p["price"], p["p_model"]] for p in self.open_positions] + ([proposed] if proposed else [])
+        if self.market_maker:
+            # Quoted inventory is as much at risk as a directional position
+            positions += self.market_maker.positions()
+        if not positions:
+            return 0.0
+        with SharedArray.from_array(positions) as shared:
+            return await self.compute.run(monte_carlo_var, shared.descriptor, 100_000, self.risk_manager.VAR_CONFIDENCE)
+
+    async def _research_and_predict(self, target):
+        cache_key = f"{target['platform']}:{target['id']}"
+        cached = self.checkpoint.get("llm", cache_key, max_age=self.LLM_CACHE_TTL)
+        if cached and abs(cached["price"] - target["price"]) <= 1:
+            # Same market at (nearly) the same price: re-price the cached p_model instead of re-polling the LLMs
+            prediction = dict(cached["prediction"])
+            prediction['p_market'] = target['price']/100.0
+            prediction['edge'] = round(prediction['p_model'] - prediction['p_market'], 4)
+            prediction['signal'] = "TRADE" if prediction['edge'] > self.risk_manager.MIN_EDGE else "WAIT"
+            logger.info(f"Reusing cached research + prediction for {cache_key}.")
+            return cached["brief"], prediction
+            
+        # Scrapers and the research agent are blocking; keep them off the loop
+        news = await asyncio.to_thread(self.news_scraper.fetch_news, target['title'], limit=3)
+        tweets = await asyncio.to_thread(self.twitter_scraper.fetch_recent_tweets, target['title'], limit=3)
+        brief = await asyncio.to_thread(self.researcher.analyze, target['title'], news, tweets)
+        
+        logger.info(f"Research compiled.")
+        
+        prediction = await self.predictor.evaluate_edge(target['title'], target['price']/100.0, brief)
+        if self.risk_service:
+            self.daily_api_spend = await asyncio.to_thread(self.risk_service.add_api_spend, self.prioritizer.EST_LLM_COST_PER_EVAL)
+        else:
+            self.daily_api_spend += self.prioritizer.EST_LLM_COST_PER_EVAL
+        self.checkpoint.put("llm", cache_key, {"price": target["price"], "brief": brief, "prediction": prediction})
+        return brief, prediction
+
     async def run_forever(self):
         logger.info("Starting Polymaster Continuous Worker Daemon")
-        while True:
+        self.kill_switch.start()
+        heartbeat = self.kill_switch.track(self.shard.heartbeat_loop()) if self.shard else None
+        try:
+            while not self.check_kill_switch():
+                try:
+                    await self.run_pipeline()
+                except Exception as e:
+                    logger.error(f"Pipeline encountered an error: {e}")
+                
+                # Sleep for 15 minutes before running the pipeline again
+                logger.info("Pipeline sweep complete. Sleeping for 15 minutes...")
+                if await self.kill_switch.sleep(900):
+                    break
+        finally:
+            # The mass-cancel runs as a task; let it finish before asyncio.run tears the loop down
+            await self.kill_switch.drain()
+            if heartbeat:
+                heartbeat.cancel()
+                self.shard.leave()
+            self.compute.shutdown()
+            self.kill_switch.stop()
+            if self.recorder:
+                self.recorder.close()
+        logger.critical(f"Worker halted by kill switch: {self.kill_switch.reason}")
+
+    async def _execute_signals(self, pipeline):
+        """The pipeline's execution stage: TRADE signals go through this process's engine, risk and positions."""
+        while not self.check_kill_switch():
+            signal = await asyncio.to_thread(pipeline.next_signal)
+            if signal is None or self.check_kill_switch():
+                continue
+            target, brief, prediction = signal
+            self.daily_api_spend = pipeline.api_spend.value
             try:
-                await self.run_pipeline()
+                await self.risk_and_execute(target, prediction, brief)
             except Exception as e:
-                logger.error(f"Pipeline encountered an error: {e}")
-            
-            # Sleep for 15 minutes before running the pipeline again
-            logger.info("Pipeline sweep complete. Sleeping for 15 minutes...")
-            await asyncio.sleep(900)
+                logger.error(f"Execution of {target['id']} failed: {e}")
+            self.save_state()
+
+    async def run_multiprocess(self):
+        """
+        Same sweep cadence as run_forever, but ingestion, research and prediction
+        run as separate process pools so CPU-bound work escapes the GIL. Their
+        signals are executed here, on the same engine as arbitrage, so the kill
+        switch's mass-cancel sees every order and one checkpoint holds every position.
+        """
+        logger.info("Starting Polymaster Multi-Process Worker Daemon")
+        pipeline = StagePipeline(
+            workers=StagePipeline.workers_from_env(os.getenv("POLYMASTER_STAGE_WORKERS")),
+            api_budget=self.api_budget_ceiling,
+            cost_per_eval=self.prioritizer.EST_LLM_COST_PER_EVAL,
+        )
+        self.kill_switch.on_halt(pipeline.halt.set)
+        self.kill_switch.start()
+        pipeline.start()
+        executor = asyncio.create_task(self._execute_signals(pipeline))
+        budget_day = date.today()
+        try:
+            while not self.check_kill_switch():
+                if date.today() != budget_day:
+                    pipeline.reset_budget()
+                    budget_day = date.today()
+
+                await self.settle_positions()
+                self.market_data.new_sweep()
+                arbs = await self.scan_arbitrage()
+                if arbs and await self.execute_arbitrage(arbs):
+                    logger.info("Arbitrage executed; skipping the AI prediction sweep this cycle.")
+                else:
+                    pipeline.submit_sweep()
+
+                logger.info("Sweep dispatched to stage pipeline. Sleeping for 15 minutes...")
+                self.save_state()
+                if self.recorder:
+                    self.recorder.flush()
+                if await self.kill_switch.sleep(900):
+                    break
+        finally:
+            executor.cancel()
+            await asyncio.gather(executor, return_exceptions=True)
+            await self.kill_switch.drain()
+            self.save_state()
+            pipeline.stop()
+            self.compute.shutdown()
+            self.kill_switch.stop()
+            if self.recorder:
+                self.recorder.close()
 
 if __name__ == "__main__":
     from dotenv import load_dotenv
     load_dotenv()
     
-    bot = TradingBotOrchestrator()
-    asyncio.run(bot.run_forever())
+    worker_id = os.getenv("POLYMASTER_WORKER_ID")
+    multiprocess = "--multiprocess" in sys.argv or os.getenv("POLYMASTER_MODE") == "multiprocess"
+    if worker_id or multiprocess:
+        # Every process on this host shares one API quota per venue; spawned stages inherit the env var
+        os.environ.setdefault("RATE_LIMIT_DB", "data/coordination.db")
+        rate_limiter.share(os.environ["RATE_LIMIT_DB"])
+    with profiler.section("TradingBotOrchestrator()"):
+        if worker_id:
+            # Sharded mode: run one process per worker id against the same data/coordination.db
+            bot = TradingBotOrchestrator(shard=ShardWorker(worker_id), risk_service=RiskService(worker_id=worker_id))
+        else:
+            bot = TradingBotOrchestrator()
+    if profiler.enabled:
+        # Lazy clients add their own rows as they are first used; `python -m src.startup` gives the import breakdown
+        logger.info("Startup profile:\n" + profiler.report())
+    if multiprocess:
+        asyncio.run(bot.run_multiprocess())
+    else:
+        asyncio.run(bot.run_forever())
@@ -0,0 +1,293 @@
+import json
+from datetime import datetime, timezone
+import numpy as np
+
+try:
+    import msgspec
+    _loads = msgspec.json.decode
+except ImportError:
+    _loads = json.loads
+
+def _json_list(value):
+    # Gamma ships outcomes / outcomePrices / clobTokenIds as JSON-encoded strings
+    if isinstance(value, str):
+        return value or "[]"
+    return json.dumps(list(value or []))
+
+def _decode_one(encoded):
+    try:
+        value = _loads(encoded.encode())
+    except ValueError:
+        return []
+    return value if isinstance(value, list) else []
+
+def _bulk_decode(encoded):
+    """
+    Decodes many small JSON arrays with a single parser call. If any of them is
+    malformed, falls back to one call per array; a bad one decodes to [].
+    """
+    try:
+        rows = _loads(("[" + ",".join(encoded) + "]").encode())
+    except ValueError:
+        return [_decode_one(e) for e in encoded]
+    return [r if isinstance(r, list) else [] for r in rows]
+
+def _floats(values):
+    """float64 column; values that don't parse become NaN instead of failing the whole column."""
+    try:
+        return np.asarray(values, dtype=np.float64)
+    except (TypeError, ValueError):
+        out = np.full(len(values), np.nan)
+        for i, v in enumerate(values):
+            try:
+                out[i] = float(v)
+            except (TypeError, ValueError):
+                pass
+        return out
+
+def _is_price_row(prices):
+    try:
+        return all(0.0 <= float(p) <= 1.0 for p in prices)
+    except (TypeError, ValueError):
+        return False
+
+def _to_epoch(dates):
+    """ISO-8601 strings (or None) -> float seconds since epoch, NaN when missing or unparseable."""
+    # numpy parses the naive prefix; Gamma timestamps are all UTC
+    trimmed = [d[:19] if isinstance(d, str) and d else "NaT" for d in dates]
+    try:
+        parsed = np.array(trimmed, dtype="datetime64[s]")
+    except ValueError:
+        parsed = np.array([_to_datetime64(d) for d in trimmed], dtype="datetime64[s]")
+    out = parsed.astype("float64")
+    out[np.isnat(parsed)] = np.nan
+    return out
+
+def _to_datetime64(date):
+    try:
+        return np.datetime64(date, "s")
+    except ValueError:
+        return np.datetime64("NaT")
+
+class OutcomeTable:
+    """
+    Every tradeable Polymarket outcome of a sweep as one columnar table. Row i is
+    outcome `outcome_index[i]` of market `market_idx[i]`; `event_idx[i]` points at
+    the parent event. Numeric columns are numpy arrays so sweep-wide filters run
+    vectorized; dict rows are only built for what survives the filter. A market
+    whose prices don't decode contributes no rows; a bad scalar field becomes
+    NaN. Either way the rest of the sweep is unaffected.
+    """
+    def __init__(self):
+        # Event level
+        self.events = []
+        self.event_id, self.event_title = [], []
+        self.event_augmented = []
+        # Market level
+        self.market_id, self.question = [], []
+        self.market_event = np.zeros(0, dtype=np.int32)
+        self.market_label, self.market_active, self.market_closed = [], [], []
+        # Outcome level
+        self.event_idx = np.zeros(0, dtype=np.int32)
+        self.market_idx = np.zeros(0, dtype=np.int32)
+        self.outcome_index = np.zeros(0, dtype=np.int16)
+        self.outcome_count = np.zeros(0, dtype=np.int16)     # Outcomes of the row's market
+        self.outcome, self.token_id = [], []
+        self.price = np.zeros(0)
+        self.best_bid = np.zeros(0)
+        self.best_ask = np.zeros(0)
+        self.volume = np.zeros(0)
+        self.close_ts = np.zeros(0)
+        self.neg_risk = np.zeros(0, dtype=bool)
+
+    def __len__(self):
+        return len(self.price)
+
+    @classmethod
+    def from_events(cls, events):
+        table = cls()
+        table.events = list(events)
+
+        m_event, m_ids, m_questions, m_outcomes, m_prices, m_tokens = [], [], [], [], [], []
+        m_bid, m_ask, m_volume, m_close, m_negrisk = [], [], [], [], []
+        m_label, m_active, m_closed = [], [], []
+        for e_i, event in enumerate(table.events):
+            table.event_id.append(str(event.get("id", "")))
+            table.event_title.append(event.get("title", ""))
+            table.event_augmented.append(bool(event.get("negRiskAugmented", False)))
+            event_end = event.get("endDate")
+            event_negrisk = bool(event.get("negRisk", False))
+            for market in event.get("markets", []) or []:
+                m_event.append(e_i)
+                m_ids.append(str(market.get("id", "")))
+                m_questions.append(market.get("question", "") or "")
+                m_label.append(market.get("groupItemTitle", "") or "")
+                m_active.append(bool(market.get("active", True)))
+                m_closed.append(bool(market.get("closed", False)))
+                m_outcomes.append(_json_list(market.get("outcomes")))
+                m_prices.append(_json_list(market.get("outcomePrices")))
+                m_tokens.append(_json_list(market.get("clobTokenIds")))
+                m_bid.append(market.get("bestBid", np.nan))
+                m_ask.append(market.get("bestAsk", np.nan))
+                m_volume.append(market.get("volume", 0) or 0)
+                m_close.append(market.get("endDate") or event_end)
+                m_negrisk.append(event_negrisk or bool(market.get("negRisk", False)))
+
+        table.market_id, table.question = m_ids, m_questions
+        table.market_event = np.asarray(m_event, dtype=np.int32)
+        table.market_label, table.market_active, table.market_closed = m_label, m_active, m_closed
+        if not m_ids:
+            return table
+
+        prices = _bulk_decode(m_prices)
+        outcomes = _bulk_decode(m_outcomes)
+        tokens = _bulk_decode(m_tokens)
+        flat_prices = [p for ps in prices for p in ps]
+        try:
+            price = np.array(flat_prices, dtype=np.float64)
+            valid = bool(((price >= 0) & (price <= 1)).all())
+        except (TypeError, ValueError):
+            valid = False
+        if not valid:
+            # Slow path only when some row is bad: that market loses its outcomes, the rest keep theirs
+            prices = [ps if _is_price_row(ps) else [] for ps in prices]
+            flat_prices = [p for ps in prices for p in ps]
+            price = np.array(flat_prices, dtype=np.float64)
+
+        counts = np.fromiter((len(p) for p in prices), dtype=np.int32, count=len(prices))
+        n = int(counts.sum())
+        market_idx = np.repeat(np.arange(len(m_ids), dtype=np.int32), counts)
+        starts = np.cumsum(counts) - counts
+        table.market_idx = market_idx
+        table.event_idx = np.asarray(m_event, dtype=np.int32)[market_idx]
+        table.outcome_index = (np.arange(n, dtype=np.int32) - starts[market_idx]).astype(np.int16)
+        table.outcome_count = counts[market_idx].astype(np.int16)
+
+        table.price = price if n else np.zeros(0)
+        # Labels / token ids are padded per market when a market lists fewer than its prices
+        table.outcome = [o[k] if k < len(o) else "" for o, c in zip(outcomes, counts) for k in range(c)]
+        table.token_id = [str(t[k]) if k < len(t) else "" for t, c in zip(tokens, counts) for k in range(c)]
+
+        # bestBid / bestAsk quote the first outcome; on a binary market the second mirrors it
+        bid = _floats(m_bid)[market_idx]
+        ask = _floats(m_ask)[market_idx]
+        first = table.outcome_index == 0
+        second = (table.outcome_index == 1) & (counts[market_idx] == 2)
+        table.best_bid = np.where(first, bid, np.where(second, 1.0 - ask, np.nan))
+        table.best_ask = np.where(first, ask, np.where(second, 1.0 - bid, np.nan))
+
+        table.volume = np.nan_to_num(_floats(m_volume))[market_idx]
+        table.close_ts = _to_epoch(m_close)[market_idx]
+        table.neg_risk = np.asarray(m_negrisk, dtype=bool)[market_idx]
+        return table
+
+    def mask(self, market_filter):
+        """
+        Candidate rows: vectorized MarketFilter.matches over every outcome row, on
+        open, active markets only. A binary market keeps just its first outcome;
+        the second is the same bet from the other side. Basket arbitrage reads the
+        full table, not this mask.
+        """
+        keep = np.isfinite(self.price)
+        if len(self):
+            tradeable = np.asarray(self.market_active, dtype=bool) & ~np.asarray(self.market_closed, dtype=bool)
+            keep &= tradeable[self.market_idx]
+        keep &= (self.outcome_count != 2) | (self.outcome_index == 0)
+        if market_filter.min_volume is not None:
+            keep &= self.volume >= market_filter.min_volume
+        if market_filter.min_close or market_filter.max_close:
+            keep &= ~np.isnan(self.close_ts)
+        if market_filter.min_close:
+            keep &= self.close_ts >= market_filter.min_close.timestamp()
+        if market_filter.max_close:
+            keep &= self.close_ts <= market_filter.max_close.timestamp()
+        return keep
+
+    def rows(self, mask=None):
+        """Normalized candidate dicts (the scanner's row format) for the selected outcomes."""
+        selected = np.flatnonzero(mask) if mask is not None else np.arange(len(self))
+        spread = np.where(np.isnan(self.best_bid) | np.isnan(self.best_ask), 0.0, (self.best_ask - self.best_bid) * 100)
+        # Pull the selected columns out of numpy once; per-element numpy scalar access dominates otherwise
+        cols = zip(selected.tolist(), self.market_idx[selected].tolist(), self.event_idx[selected].tolist(),
+                   self.outcome_index[selected].tolist(), self.price[selected].tolist(), spread[selected].round(4).tolist(),
+                   self.volume[selected].tolist(), self.close_ts[selected].tolist(), self.neg_risk[selected].tolist())
+        dates = {}
+        out = []
+        for i, m, e, k, price, spr, volume, close, neg_risk in cols:
+            outcome = self.outcome[i]
+            question = self.question[m] or self.event_title[e]
+            if close not in dates:
+                dates[close] = None if close != close else datetime.fromtimestamp(close, timezone.utc)
+            out.append({
+                "id": f"{self.market_id[m]}:{k}",
+                "platform": "polymarket",
+                "title": question if outcome in ("Yes", "") else f"{question} ({outcome})",
+                "volume": volume,
+                "close_date": dates[close],
+                "price": price * 100,
+                "spread": spr,
+                "market_id": self.market_id[m],
+                "outcome": outcome,
+                "outcome_index": k,
+                "token_id": self.token_id[i],
+                "neg_risk": neg_risk,
+                "event_id": self.event_id[e],
+                "event_title": self.event_title[e],
+                "raw_data": self.events[e],
+            })
+        return out
+
+if __name__ == "__main__":
+    # Sweep-sized normalization: the outcome table vs. a per-market Python loop producing the same rows.
+    import time
+    import random
+    from datetime import timedelta
+    from src.api.filters import MarketFilter
+    from src.api.decoding import decode_gamma_events
+
+    def synthetic_events(n_events=3000, n_markets=12, n_outcomes=2):
+        rnd = random.Random(3)
+        events = []
+        for e in range(n_events):
+            markets = []
+            for m in range(n_markets):
+                p = rnd.random()
+                markets.append({
+                    "id": str(e * 100 + m), "question": f"Will candidate {m} win race {e}?",
+                    "outcomes": json.dumps(["Yes", "No"] if n_outcomes == 2 else [f"O{k}" for k in range(n_outcomes)]),
+                    "outcomePrices": json.dumps([f"{p:.3f}", f"{1 - p:.3f}"] if n_outcomes == 2 else [f"{rnd.random():.3f}" for _ in range(n_outcomes)]),
+                    "clobTokenIds": json.dumps([str(rnd.getrandbits(250)) for _ in range(n_outcomes)]),
+                    "bestBid": max(p - 0.01, 0), "bestAsk": min(p + 0.01, 1), "volume": f"{rnd.uniform(0, 50000):.2f}",
+                    "endDate": f"2026-11-{1 + e % 28:02d}T00:00:00Z", "negRisk": True,
+                })
+            events.append({"id": str(e), "title": f"Race {e}", "volume": 1e5, "endDate": "2026-11-30T00:00:00Z",
+                           "negRisk": True, "markets": markets})
+        return decode_gamma_events(json.dumps(events).encode())
+
+    events = synthetic_events()
+    now = datetime(2026, 10, 20, tzinfo=timezone.utc)
+    flt = MarketFilter(min_close=now, max_close=now + timedelta(days=30), min_volume=200)
+
+    start = time.perf_counter()
+    table = OutcomeTable.from_events(events)
+    built = time.perf_counter() - start
+    keep = table.mask(flt)
+    rows = table.rows(keep)
+    total = time.perf_counter() - start
+    print(f"{len(events)} events -> {len(table)} outcome rows: build {built * 1000:.0f} ms, "
+          f"filter + rows {(total - built) * 1000:.0f} ms, {len(rows)} candidates")
+
+    # Baseline: the same outcome rows built one market at a time with per-field json.loads + dateutil
+    from dateutil import parser
+    start = time.perf_counter()
+    naive = []
+    for event in events:
+        for market in event.get("markets", []):
+            prices = json.loads(market.get("outcomePrices"))
+            labels = json.loads(market.get("outcomes"))
+            close = parser.isoparse(market.get("endDate"))
+            for k, price in enumerate(prices):
+                if market.get("volume") >= 200 and now <= close <= now + timedelta(days=30):
+                    naive.append({"id": f"{market.get('id')}:{k}", "price": float(price) * 100, "outcome": labels[k],
+                                  "close_date": close, "event_id": event.get("id")})
+    print(f"per-market loop: {(time.perf_counter() - start) * 1000:.0f} ms, {len(naive)} candidates")
@@ -0,0 +1,69 @@
+import heapq
+from datetime import datetime, timezone
+from src.utils import logger
+
+class CandidatePrioritizer:
+    """
+    Ranks scanned candidates by expected edge per dollar of LLM spend, using only
+    cheap features already present on the normalized market (price, spread, volume,
+    expiry, anomaly flag). Research + ensemble is the expensive part of the pipeline,
+    so the budget should go to the markets most likely to pay it back.
+    """
+    def __init__(self, top_k=20, position_cap_usd=500.0):
+        self.TOP_K = top_k
+        # Upper bound of what a single approved trade can stake (5% of the $10k bankroll)
+        self.POSITION_CAP_USD = position_cap_usd
+        # One research call + five ensemble calls per candidate
+        self.EST_LLM_COST_PER_EVAL = 0.05
+
+        # Prior on how mispriced a market is before we look at it
+        self.BASE_EDGE = 0.02
+        self.SPREAD_WEIGHT = 0.5       # Half of the quoted spread is treated as potential mispricing
+        self.ANOMALY_BONUS = 0.02
+        self.VOLUME_HALF = 5000.0      # Volume at which the liquidity factor reaches 0.5
+        self.TIME_HALF_DAYS = 7.0      # Days to expiry at which the time factor reaches 0.5
+
+    def score(self, candidate, now=None):
+        """Returns the expected USD edge per USD of LLM spend for a normalized candidate."""
+        now = now or datetime.now(timezone.utc)
+
+        p = min(max(candidate.get("price", 50) / 100.0, 0.01), 0.99)
+        spread = candidate.get("spread", 0) / 100.0
+        volume = max(float(candidate.get("volume", 0) or 0), 0.0)
+
+        est_edge = self.BASE_EDGE + self.SPREAD_WEIGHT * spread
+        if candidate.get("anomaly_flag"):
+            est_edge += self.ANOMALY_BONUS
+        # A market priced at 97c can't be more than 3c wrong in our favour
+        est_edge = min(est_edge, 1.0 - p)
+
+        liquidity = volume / (volume + self.VOLUME_HALF)
+
+        close_date = candidate.get("close_date")
+        days = max((close_date - now).total_seconds() / 86400.0, 0.0) if close_date else self.TIME_HALF_DAYS
+        time_factor = self.TIME_HALF_DAYS / (self.TIME_HALF_DAYS + days)
+
+        # Buying YES at p with true probability p + edge returns edge / p per dollar staked
+        expected_value = (est_edge / p) * self.POSITION_CAP_USD * liquidity * time_factor
+        return expected_value / self.EST_LLM_COST_PER_EVAL
+
+    def top_k(self, candidates, k=None):
+        """Keeps a bounded min-heap of the K best candidates and returns them best-first."""
+        k = k or self.TOP_K
+        now = datetime.now(timezone.utc)
+        heap = []
+
+        for seq, cand in enumerate(candidates):
+            entry = (self.score(cand, now), -seq, cand)
+            if len(heap) < k:
+                heapq.heappush(heap, entry)
+            elif entry[0] > heap[0][0]:
+                heapq.heapreplace(heap, entry)
+
+        ranked = []
+        for score, _, cand in sorted(heap, key=lambda e: (e[0], e[1]), reverse=True):
+            cand["priority_score"] = round(score, 4)
+            ranked.append(cand)
+
+        logger.info(f"Prioritized {len(ranked)} of {len(candidates)} candidates (top {k}).")
+        return ranked
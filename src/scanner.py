@@ -1,6 +1,9 @@
 from datetime import datetime, timedelta, timezone
 from dateutil import parser
 from src.aggregator import MarketAggregator
+from src.api.filters import MarketFilter
+from src.market_data import MarketDataService
+from src.outcomes import OutcomeTable
 from src.utils import logger
 
 class MarketScanner:
@@ -8,6 +11,20 @@ class MarketScanner:
         self.aggregator = MarketAggregator()
         self.MIN_VOLUME = 200
         self.MAX_EXPIRY_DAYS = 30
+        self.MAX_PAGES = 5
+        # Shared per-sweep fetch + normalization; the orchestrator hands the same instance to the arbitrage scan
+        self.market_data = MarketDataService(self)
+
+    def market_filter(self, now=None):
+        """The PRD scan bounds as a filter the API clients can push down to each venue."""
+        now = now or datetime.now(timezone.utc)
+        return MarketFilter(
+            status="open",
+            min_close=now,
+            max_close=now + timedelta(days=self.MAX_EXPIRY_DAYS),
+            min_volume=self.MIN_VOLUME,
+            max_pages=self.MAX_PAGES,
+        )
 
     def _parse_date(self, date_str):
         if not date_str:
@@ -44,74 +61,51 @@ class MarketScanner:
             logger.debug(f"Failed to normalize kalshi market: {e}")
             return None
 
-    def _normalize_poly(self, event):
-        """Converts Polymarket event to standard format."""
-        # Polymarket events contain multiple markets. 
-        # For simplicity, we create one item per event if there is active volume.
-        try:
-            close_date = self._parse_date(event.get("endDate"))
-            volume = float(event.get("volume", 0))
-            
-            markets = event.get("markets", [])
-            # Try to find a spread from the primary market
-            spread = 0
-            price = 50
-            if markets:
-                pm = markets[0]
-                price = pm.get("outcomePrices", ["0.5", "0.5"])[0] 
-                try:
-                    price = float(price) * 100
-                except ValueError:
-                    price = 50
-                    
-            return {
-                "id": event.get("id"),
-                "platform": "polymarket",
-                "title": event.get("title", ""),
-                "volume": volume,
-                "close_date": close_date,
-                "price": price,
-                "spread": spread,  # Needs CLOB orderbook for real spread
-                "raw_data": event
-            }
-        except Exception as e:
-            logger.debug(f"Failed to normalize poly market: {e}")
-            return None
-
-    def scan(self):
-        """Fetch all markets, normalize, filter based on PRD bounds, return candidates."""
-        logger.info("Starting scan...")
-        raw_markets = self.aggregator.fetch_all_markets()
+    def filter_candidates(self, platform, raw_items, now=None):
+        """Normalize one venue's raw markets and apply the PRD volume/expiry bounds."""
+        market_filter = self.market_filter(now)
+        if platform == "polymarket":
+            return self._poly_candidates(raw_items, market_filter)
         
         candidates = []
-        now = datetime.now(timezone.utc)
-        
-        # Process Kalshi
-        for m in raw_markets.get("kalshi", []):
-            norm = self._normalize_kalshi(m)
+        for item in raw_items:
+            norm = self._normalize_kalshi(item)
             if not norm: continue
             
-            if norm["volume"] < self.MIN_VOLUME:
-                continue
-            if not norm["close_date"] or (norm["close_date"] - now).days > self.MAX_EXPIRY_DAYS:
+            # Re-applied locally: covers predicates the venue can't evaluate (Kalshi volume)
+            # and snapshots fetched before the filter existed
+            if not market_filter.matches(norm):
                 continue
                 
             norm["anomaly_flag"] = "wide_spread" if norm["spread"] > 5 else None
             candidates.append(norm)
-            
-        # Process Polymarket
-        for e in raw_markets.get("polymarket", []):
-            norm = self._normalize_poly(e)
-            if not norm: continue
-            
-            if norm["volume"] < self.MIN_VOLUME:
-                continue
-            if not norm["close_date"] or (norm["close_date"] - now).days > self.MAX_EXPIRY_DAYS:
-                continue
-                
-            norm["anomaly_flag"] = None
-            candidates.append(norm)
+        return candidates
 
+    def _poly_candidates(self, events, market_filter):
+        """One row per outcome of every market in every event, filtered column-wise before rows are built."""
+        try:
+            table = OutcomeTable.from_events(events)
+        except Exception as e:
+            logger.error(f"Failed to normalize Polymarket events: {e}")
+            return []
+        candidates = table.rows(table.mask(market_filter))
+        for norm in candidates:
+            # bestBid/bestAsk give Polymarket a real spread now, so the same anomaly rule applies
+            norm["anomaly_flag"] = "wide_spread" if norm["spread"] > 5 else None
+        return candidates
+
+    def scan_venue(self, platform):
+        """Fetch and filter a single venue. Used by the per-venue ingestion workers."""
+        self.market_data.new_sweep()
+        return [dict(row) for row in self.market_data.normalized(platform)]
+
+    def scan(self, raw_markets=None):
+        """Fetch all markets, normalize, filter based on PRD bounds, return candidates.
+        A previously saved snapshot can be passed in to skip the fetch on warm restart."""
+        logger.info("Starting scan...")
+        self.market_data.new_sweep(raw_markets)
+        candidates = self.market_data.candidates()
+        logger.info(f"Sweep transfer: {self.market_data.report()}")
         logger.info(f"Scan complete. Found {len(candidates)} valid candidate markets.")
         return candidates
 
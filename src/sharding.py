@@ -0,0 +1,381 @@
+import os
+import time
+import bisect
+import sqlite3
+import asyncio
+import hashlib
+from contextlib import contextmanager
+from datetime import date
+from src.utils import logger
+
+@contextmanager
+def _connect(db_path):
+    """Autocommit connection that is closed on exit (sqlite3's own context manager only commits)."""
+    conn = sqlite3.connect(db_path, timeout=10.0, isolation_level=None)
+    try:
+        yield conn
+    finally:
+        conn.close()
+
+def _hash(key):
+    return int.from_bytes(hashlib.blake2b(key.encode(), digest_size=8).digest(), "big")
+
+class ConsistentHashRing:
+    """Maps market keys to workers. Adding or removing a worker only moves ~1/N of the keys."""
+    def __init__(self, nodes=(), vnodes=256):
+        self.vnodes = vnodes
+        self._ring = sorted((_hash(f"{node}#{i}"), node) for node in nodes for i in range(vnodes))
+        self._points = [h for h, _ in self._ring]
+
+    def owner(self, key):
+        if not self._ring:
+            return None
+        idx = bisect.bisect(self._points, _hash(key)) % len(self._ring)
+        return self._ring[idx][1]
+
+class SQLiteCoordinator:
+    """
+    Local coordination backend. Each worker holds a lease row it must renew before
+    `lease_ttl` runs out; membership is simply the set of unexpired leases, so a
+    crashed worker drops out on its own and its shards move to the survivors.
+    """
+    def __init__(self, db_path="data/coordination.db", lease_ttl=30.0):
+        self.db_path = db_path
+        self.lease_ttl = lease_ttl
+        os.makedirs(os.path.dirname(self.db_path) or ".", exist_ok=True)
+        with self._connect() as conn:
+            conn.execute("PRAGMA journal_mode=WAL")
+            conn.execute('''
+                CREATE TABLE IF NOT EXISTS leases (
+                    worker_id TEXT PRIMARY KEY,
+                    expires_at REAL NOT NULL
+                )
+            ''')
+
+    def _connect(self):
+        return _connect(self.db_path)
+
+    def heartbeat(self, worker_id):
+        with self._connect() as conn:
+            conn.execute(
+                "INSERT INTO leases (worker_id, expires_at) VALUES (?, ?) "
+                "ON CONFLICT(worker_id) DO UPDATE SET expires_at = excluded.expires_at",
+                (worker_id, time.time() + self.lease_ttl),
+            )
+
+    def release(self, worker_id):
+        with self._connect() as conn:
+            conn.execute("DELETE FROM leases WHERE worker_id = ?", (worker_id,))
+
+    def live_workers(self):
+        with self._connect() as conn:
+            rows = conn.execute("SELECT worker_id FROM leases WHERE expires_at > ? ORDER BY worker_id", (time.time(),))
+            return tuple(r[0] for r in rows)
+
+class ShardWorker:
+    """One worker's view of the partitioned market universe."""
+    def __init__(self, worker_id, coordinator=None, vnodes=256):
+        self.worker_id = worker_id
+        self.coordinator = coordinator or SQLiteCoordinator()
+        self.vnodes = vnodes
+        self.members = ()
+        self.ring = ConsistentHashRing()
+
+    def refresh(self):
+        """Renews our lease and rebuilds the ring if anyone joined or left."""
+        self.coordinator.heartbeat(self.worker_id)
+        members = self.coordinator.live_workers()
+        if members != self.members:
+            logger.info(f"[SHARD {self.worker_id}] Rebalancing: {len(self.members)} -> {len(members)} workers {list(members)}")
+            self.members = members
+            self.ring = ConsistentHashRing(members, self.vnodes)
+        return self.members
+
+    async def heartbeat_loop(self):
+        while True:
+            await asyncio.to_thread(self.refresh)
+            await asyncio.sleep(self.coordinator.lease_ttl / 3)
+
+    def owns_key(self, key):
+        return self.ring.owner(key) == self.worker_id
+
+    def owns(self, market):
+        return self.owns_key(f"{market['platform']}:{market['id']}")
+
+    def filter(self, candidates):
+        owned = [c for c in candidates if self.owns(c)]
+        logger.info(f"[SHARD {self.worker_id}] Owns {len(owned)} of {len(candidates)} candidates.")
+        return owned
+
+    def leave(self):
+        self.coordinator.release(self.worker_id)
+
+class RiskService:
+    """
+    Authoritative portfolio-level risk state shared by every shard. Checks and
+    position reservations happen inside one exclusive SQLite transaction, so two
+    workers can never both take the 15th concurrent position. The bankroll and
+    its peak live here too: every worker sizes against the one shared bankroll
+    and reads the same daily-loss and drawdown fractions of it. Open positions
+    are counted per worker, so a restarted worker resets its own count from the
+    positions it actually holds. Settled positions feed realized P&L into the
+    daily-loss and drawdown limits; each worker's market-making inventory,
+    marked to fair value, counts against them as unrealized P&L.
+    """
+    def __init__(self, db_path="data/coordination.db", validator=None, worker_id="default", bankroll=10000.0):
+        from skills.predict_market_bot.scripts.validate_risk import RiskValidator
+        self.db_path = db_path
+        self.validator = validator or RiskValidator()
+        self.worker_id = worker_id
+        os.makedirs(os.path.dirname(self.db_path) or ".", exist_ok=True)
+        with self._connect() as conn:
+            # concurrent_positions is legacy: open positions now live in the positions table
+            conn.execute('''
+                CREATE TABLE IF NOT EXISTS portfolio (
+                    id INTEGER PRIMARY KEY CHECK (id = 1),
+                    day TEXT NOT NULL,
+                    concurrent_positions INTEGER NOT NULL,
+                    daily_loss_pct REAL NOT NULL,
+                    drawdown_pct REAL NOT NULL,
+                    api_spend REAL NOT NULL
+                )
+            ''')
+            conn.execute("INSERT OR IGNORE INTO portfolio (id, day, concurrent_positions, daily_loss_pct, drawdown_pct, api_spend) "
+                         "VALUES (1, ?, 0, 0.0, 0.0, 0.0)", (date.today().isoformat(),))
+            columns = {row[1] for row in conn.execute("PRAGMA table_info(portfolio)")}
+            for column in ("daily_pnl", "realized_pnl", "peak_pnl"):
+                if column not in columns:
+                    conn.execute(f"ALTER TABLE portfolio ADD COLUMN {column} REAL NOT NULL DEFAULT 0.0")
+            for column in ("bankroll", "peak_bankroll"):
+                if column not in columns:
+                    conn.execute(f"ALTER TABLE portfolio ADD COLUMN {column} REAL")
+            # `bankroll` only seeds a new portfolio; afterwards settlements move it
+            conn.execute("UPDATE portfolio SET bankroll = COALESCE(bankroll, ?), "
+                         "peak_bankroll = COALESCE(peak_bankroll, bankroll, ?) WHERE id = 1", (bankroll, bankroll))
+            conn.execute('''
+                CREATE TABLE IF NOT EXISTS positions (
+                    worker_id TEXT PRIMARY KEY,
+                    open INTEGER NOT NULL
+                )
+            ''')
+            if "unrealized_pnl" not in {row[1] for row in conn.execute("PRAGMA table_info(positions)")}:
+                conn.execute("ALTER TABLE positions ADD COLUMN unrealized_pnl REAL NOT NULL DEFAULT 0.0")
+
+    def _connect(self):
+        return _connect(self.db_path)
+
+    def _load(self, conn):
+        day, loss, drawdown, spend, bankroll = conn.execute(
+            "SELECT day, daily_loss_pct, drawdown_pct, api_spend, bankroll FROM portfolio WHERE id = 1"
+        ).fetchone()
+        if day != date.today().isoformat():
+            # Daily counters roll over; open positions and drawdown carry
+            loss, spend = 0.0, 0.0
+            conn.execute("UPDATE portfolio SET day = ?, daily_loss_pct = 0.0, daily_pnl = 0.0, api_spend = 0.0 "
+                         "WHERE id = 1", (date.today().isoformat(),))
+        positions = conn.execute("SELECT COALESCE(SUM(open), 0) FROM positions").fetchone()[0]
+        return positions, loss, drawdown, spend, bankroll
+
+    def _add_open(self, conn, delta):
+        conn.execute("INSERT INTO positions (worker_id, open) VALUES (?, MAX(?, 0)) "
+                     "ON CONFLICT(worker_id) DO UPDATE SET open = MAX(open + ?, 0)",
+                     (self.worker_id, delta, delta))
+
+    def snapshot(self):
+        with self._connect() as conn:
+            conn.execute("BEGIN IMMEDIATE")
+            state = self._load(conn)
+            conn.execute("COMMIT")
+        return dict(zip(("concurrent_positions", "daily_loss_pct", "drawdown_pct", "api_spend", "bankroll"), state))
+
+    def reserve(self, p_model, p_market, locked=False):
+        """
+        Validates against global limits and, if approved, books the position atomically.
+        Sized against the shared bankroll. `locked` is an arbitrage set: portfolio limits
+        only (p_model / p_market are ignored).
+        """
+        with self._connect() as conn:
+            conn.execute("BEGIN IMMEDIATE")
+            try:
+                positions, loss, drawdown, spend, bankroll = self._load(conn)
+                if locked:
+                    allowed, msg, size = self.validator.validate_locked(bankroll, loss, drawdown, positions, spend)
+                else:
+                    allowed, msg, size = self.validator.validate(
+                        p_model=p_model,
+                        p_market=p_market,
+                        bankroll=bankroll,
+                        current_daily_loss_pct=loss,
+                        current_drawdown_pct=drawdown,
+                        concurrent_positions=positions,
+                        daily_api_spend=spend,
+                    )
+                if allowed:
+                    self._add_open(conn, 1)
+                conn.execute("COMMIT")
+            except Exception:
+                conn.execute("ROLLBACK")
+                raise
+        return allowed, msg, size
+
+    def release_position(self):
+        """Gives back a reservation that never turned into a position."""
+        with self._connect() as conn:
+            self._add_open(conn, -1)
+
+    def sync_positions(self, count):
+        """
+        Sets this worker's open-position count from the positions it actually holds (e.g. after a restart).
+        Market-making inventory isn't checkpointed, so its last mark goes too, out of today's P&L as well.
+        """
+        with self._connect() as conn:
+            conn.execute("BEGIN IMMEDIATE")
+            try:
+                self._load(conn)
+                row = conn.execute("SELECT unrealized_pnl FROM positions WHERE worker_id = ?", (self.worker_id,)).fetchone()
+                conn.execute("INSERT INTO positions (worker_id, open, unrealized_pnl) VALUES (?, ?, 0.0) "
+                             "ON CONFLICT(worker_id) DO UPDATE SET open = excluded.open, unrealized_pnl = 0.0",
+                             (self.worker_id, count))
+                if row and row[0]:
+                    conn.execute("UPDATE portfolio SET daily_pnl = daily_pnl - ? WHERE id = 1", (row[0],))
+                    self._book_limits(conn)
+                conn.execute("COMMIT")
+            except Exception:
+                conn.execute("ROLLBACK")
+                raise
+
+    def close_position(self, pnl_usd):
+        """
+        A position settled: frees its slot and books the realized P&L into the shared
+        bankroll. Returns (daily_loss_pct, drawdown_pct, bankroll), the values validate reads.
+        """
+        with self._connect() as conn:
+            conn.execute("BEGIN IMMEDIATE")
+            try:
+                self._load(conn)
+                self._add_open(conn, -1)
+                conn.execute("UPDATE portfolio SET daily_pnl = daily_pnl + ?, realized_pnl = realized_pnl + ?, "
+                             "bankroll = bankroll + ? WHERE id = 1", (pnl_usd, pnl_usd, pnl_usd))
+                limits = self._book_limits(conn)
+                conn.execute("COMMIT")
+            except Exception:
+                conn.execute("ROLLBACK")
+                raise
+        return limits
+
+    def mark_unrealized(self, pnl_usd):
+        """
+        This worker's open market-making P&L at fair value. The move since the
+        last mark goes into today's P&L; the mark itself into drawdown.
+        Returns (daily_loss_pct, drawdown_pct, bankroll).
+        """
+        with self._connect() as conn:
+            conn.execute("BEGIN IMMEDIATE")
+            try:
+                self._load(conn)
+                row = conn.execute("SELECT unrealized_pnl FROM positions WHERE worker_id = ?", (self.worker_id,)).fetchone()
+                conn.execute("INSERT INTO positions (worker_id, open, unrealized_pnl) VALUES (?, 0, ?) "
+                             "ON CONFLICT(worker_id) DO UPDATE SET unrealized_pnl = excluded.unrealized_pnl",
+                             (self.worker_id, pnl_usd))
+                conn.execute("UPDATE portfolio SET daily_pnl = daily_pnl + ? WHERE id = 1",
+                             (pnl_usd - (row[0] if row else 0.0),))
+                limits = self._book_limits(conn)
+                conn.execute("COMMIT")
+            except Exception:
+                conn.execute("ROLLBACK")
+                raise
+        return limits
+
+    def realize_unrealized(self, pnl_usd, unrealized_usd):
+        """
+        Market-making inventory paid out: `pnl_usd` goes into the shared bankroll and this
+        worker's mark becomes `unrealized_usd`, what is still open. Today's P&L moves by
+        the difference from the last mark only. Returns (daily_loss_pct, drawdown_pct, bankroll).
+        """
+        with self._connect() as conn:
+            conn.execute("BEGIN IMMEDIATE")
+            try:
+                self._load(conn)
+                row = conn.execute("SELECT unrealized_pnl FROM positions WHERE worker_id = ?", (self.worker_id,)).fetchone()
+                conn.execute("INSERT INTO positions (worker_id, open, unrealized_pnl) VALUES (?, 0, ?) "
+                             "ON CONFLICT(worker_id) DO UPDATE SET unrealized_pnl = excluded.unrealized_pnl",
+                             (self.worker_id, unrealized_usd))
+                conn.execute("UPDATE portfolio SET daily_pnl = daily_pnl + ?, realized_pnl = realized_pnl + ?, "
+                             "bankroll = bankroll + ? WHERE id = 1",
+                             (pnl_usd + unrealized_usd - (row[0] if row else 0.0), pnl_usd, pnl_usd))
+                limits = self._book_limits(conn)
+                conn.execute("COMMIT")
+            except Exception:
+                conn.execute("ROLLBACK")
+                raise
+        return limits
+
+    def _book_limits(self, conn):
+        """
+        Daily loss and drawdown on equity: the shared bankroll plus every worker's
+        unrealized P&L. Daily loss is a fraction of the day's starting equity.
+        """
+        unrealized = conn.execute("SELECT COALESCE(SUM(unrealized_pnl), 0) FROM positions").fetchone()[0]
+        conn.execute("UPDATE portfolio SET peak_bankroll = MAX(peak_bankroll, bankroll + ?), "
+                     "peak_pnl = MAX(peak_pnl, realized_pnl + ?) WHERE id = 1", (unrealized, unrealized))
+        daily_pnl, bankroll, peak = conn.execute(
+            "SELECT daily_pnl, bankroll, peak_bankroll FROM portfolio WHERE id = 1").fetchone()
+        equity = bankroll + unrealized
+        start = equity - daily_pnl
+        # A day that started with nothing left has lost all of it if it lost anything
+        loss = max(-daily_pnl, 0.0) / start if start > 0 else float(daily_pnl < 0)
+        drawdown = (peak - equity) / peak if peak > 0 else 0.0
+        conn.execute("UPDATE portfolio SET daily_loss_pct = ?, drawdown_pct = ? WHERE id = 1", (loss, drawdown))
+        return loss, drawdown, bankroll
+
+    def add_api_spend(self, amount):
+        with self._connect() as conn:
+            conn.execute("BEGIN IMMEDIATE")
+            self._load(conn)
+            conn.execute("UPDATE portfolio SET api_spend = api_spend + ? WHERE id = 1", (amount,))
+            spend = conn.execute("SELECT api_spend FROM portfolio WHERE id = 1").fetchone()[0]
+            conn.execute("COMMIT")
+        return spend
+
+def _bench_worker(worker_id, db_path, markets, cost_s, ready, result_q):
+    shard = ShardWorker(worker_id, SQLiteCoordinator(db_path))
+    shard.refresh()
+    ready.wait()
+    shard.refresh()
+    start = time.perf_counter()
+    owned = 0
+    for key in markets:
+        if shard.owns_key(key):
+            owned += 1
+            time.sleep(cost_s)  # Stand-in for per-market I/O (fetch books, research)
+    result_q.put((worker_id, owned, time.perf_counter() - start))
+
+if __name__ == "__main__":
+    # Throughput vs. worker count on one host. Each market costs a fixed amount of
+    # I/O-bound work; with even shards the sweep time should fall ~1/N.
+    import tempfile
+    import multiprocessing as mp
+
+    markets = [f"kalshi:MKT-{i}" for i in range(2000)]
+    cost_s = 0.001
+    ctx = mp.get_context("spawn")
+    base = None
+    for n in (1, 2, 4, 8):
+        with tempfile.TemporaryDirectory() as tmp:
+            db = os.path.join(tmp, "coord.db")
+            SQLiteCoordinator(db)
+            ready, result_q = ctx.Event(), ctx.Queue()
+            procs = [ctx.Process(target=_bench_worker, args=(f"w{i}", db, markets, cost_s, ready, result_q)) for i in range(n)]
+            for p in procs:
+                p.start()
+            while len(SQLiteCoordinator(db).live_workers()) < n:
+                time.sleep(0.05)
+            ready.set()
+            results = [result_q.get() for _ in procs]
+            for p in procs:
+                p.join()
+        wall = max(r[2] for r in results)
+        base = base or wall
+        covered = sum(r[1] for r in results)
+        print(f"{n} worker(s): {len(markets) / wall:8.0f} markets/s  speedup {base / wall:4.2f}x  "
+              f"shard sizes {sorted(r[1] for r in results)}  covered {covered}/{len(markets)}")
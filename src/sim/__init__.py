@@ -0,0 +1,4 @@
+from src.sim.feed import FeedWriter, read_feed
+from src.sim.matching import MatchingEngine, FeeModel, SimOrder
+from src.sim.paper import SimVenue, load_trades, replay, format_report
+from src.sim.microstructure import MicrostructureSimulator, SimConfig
@@ -0,0 +1,76 @@
+import os
+import gzip
+import json
+
+try:
+    import msgspec
+    _encode = msgspec.json.encode
+    _decode = msgspec.json.decode
+    _encode_lines = msgspec.json.Encoder().encode_lines
+except ImportError:
+    msgspec = None
+    _encode = lambda obj: json.dumps(obj, separators=(",", ":")).encode()
+    _decode = json.loads
+    _encode_lines = lambda objs: b"".join(_encode(o) + b"\n" for o in objs)
+
+# Recorded-feed format: one JSON object per line, ordered by "ts" (epoch seconds).
+# Every event names its "venue" and "market" (Kalshi ticker / Polymarket token id);
+# prices are YES probabilities and sizes contracts/shares.
+#   book   {"bids": [[p, s], ...], "asks": [[p, s], ...]}   full snapshot, best level first
+#   level  {"side": "bid"|"ask", "price": p, "size": s}      one level's new size (0 removes it)
+#   trade  {"price": p, "size": s, "aggressor": "buy"|"sell"}
+#   resolve {"outcome": 0|1}                                 market settled
+#   news   {"headline": str, "impact": float}                 signed shock to fair value
+EVENT_TYPES = ("book", "level", "trade", "resolve", "news")
+
+class FeedWriter:
+    """Appends feed events to a .jsonl file (gzip when the path ends in .gz); append=False starts it over."""
+    def __init__(self, path, append=True):
+        self._file = None
+        self.written = 0
+        self.reopen(path, append)
+
+    def reopen(self, path, append=True):
+        """Closes the current file and continues in `path` (e.g. the next day's feed)."""
+        os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+        mode = "ab" if append else "wb"
+        new = gzip.open(path, mode) if path.endswith(".gz") else open(path, mode)
+        if self._file:
+            self._file.close()
+        self.path, self._file = path, new
+
+    def write(self, event):
+        self._file.write(_encode(event) + b"\n")
+        self.written += 1
+
+    def write_many(self, events):
+        self._file.write(_encode_lines(events))
+        self.written += len(events)
+
+    def book(self, ts, venue, market, bids, asks):
+        self.write({"ts": ts, "venue": venue, "market": market, "type": "book",
+                    "bids": [list(l) for l in bids], "asks": [list(l) for l in asks]})
+
+    def trade(self, ts, venue, market, price, size, aggressor):
+        self.write({"ts": ts, "venue": venue, "market": market, "type": "trade",
+                    "price": price, "size": size, "aggressor": aggressor})
+
+    def flush(self):
+        self._file.flush()
+
+    def close(self):
+        self._file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+def read_feed(path):
+    """Yields feed events as dicts, in file order."""
+    opener = gzip.open if path.endswith(".gz") else open
+    with opener(path, "rb") as f:
+        for line in f:
+            if line.strip():
+                yield _decode(line)
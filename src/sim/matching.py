@@ -0,0 +1,219 @@
+import math
+import itertools
+from collections import deque
+from dataclasses import dataclass, field
+
+TICK = {"kalshi": 0.01, "polymarket": 0.001}
+
+class FeeModel:
+    """
+    Per-venue trading fees in USD. Kalshi charges ceil-to-the-cent of
+    rate * contracts * P * (1 - P), takers at 7%, makers at 0 on most markets;
+    Polymarket charges fee_rate_bps * min(P, 1 - P) per share (0 bps on most markets).
+    """
+    def __init__(self, venue, taker_rate=None, maker_rate=0.0):
+        self.venue = venue
+        self.taker_rate = (0.07 if venue == "kalshi" else 0.0) if taker_rate is None else taker_rate
+        self.maker_rate = maker_rate
+
+    def fee(self, qty, price, maker):
+        rate = self.maker_rate if maker else self.taker_rate
+        if not rate:
+            return 0.0
+        if self.venue == "kalshi":
+            return math.ceil(rate * qty * price * (1 - price) * 100 - 1e-9) / 100
+        return rate * qty * min(price, 1 - price)
+
+@dataclass
+class SimOrder:
+    order_id: str
+    market: str
+    action: str                 # "buy" / "sell" YES
+    price: float
+    size: float
+    ts: float
+    filled: float = 0.0
+    cost: float = 0.0
+    fees: float = 0.0
+    queue_ahead: float = 0.0    # Displayed size at our price that was there before us
+    status: str = "open"        # open / filled / cancelled
+    fills: list = field(default_factory=list)
+
+    @property
+    def remaining(self):
+        return self.size - self.filled
+
+    @property
+    def avg_price(self):
+        return self.cost / self.filled if self.filled else None
+
+def _key(price):
+    return round(price, 6)
+
+class SimBook:
+    """Displayed liquidity from the feed ({price: size} per side) plus our own resting orders."""
+    __slots__ = ("bids", "asks", "resting")
+
+    def __init__(self):
+        self.bids, self.asks = {}, {}
+        self.resting = {}       # (action, price) -> deque of our SimOrders, time priority
+
+class MatchingEngine:
+    """
+    Price-time priority simulation of one venue's books, driven by recorded or
+    live book data. Our orders never see the venue's real queue, so each
+    resting order carries `queue_ahead`: the displayed size at its price when it
+    arrived. Trades at that price work the queue off before we fill; trades
+    through it fill us outright. Displayed size shrinking below queue_ahead
+    (cancels ahead of us) moves us up. Marketable orders walk the displayed
+    book and use up that liquidity until the next snapshot replaces it.
+    """
+    def __init__(self, venue, fee_model=None):
+        self.venue = venue
+        self.fees = fee_model or FeeModel(venue)
+        self.books = {}
+        self.orders = {}
+        self._ids = itertools.count(1)
+        self.events = 0
+
+    def book(self, market):
+        book = self.books.get(market)
+        if book is None:
+            book = self.books[market] = SimBook()
+        return book
+
+    def _fill(self, order, qty, price, ts, maker):
+        fee = self.fees.fee(qty, price, maker)
+        order.filled += qty
+        order.cost += qty * price
+        order.fees += fee
+        order.fills.append((ts, qty, price, "maker" if maker else "taker", fee))
+        if order.remaining <= 1e-9:
+            order.status = "filled"
+        return (order.order_id, qty, price, maker, fee)
+
+    # Order entry
+
+    def submit(self, market, action, price, size, ts):
+        """Limit order on the YES book. Crosses what it can now; the rest rests with its queue position."""
+        book = self.book(market)
+        order = SimOrder(f"{self.venue}-sim-{next(self._ids)}", market, action, _key(price), size, ts)
+        self.orders[order.order_id] = order
+        fills = []
+        buying = action == "buy"
+        levels = book.asks if buying else book.bids
+        for level in sorted(levels, reverse=not buying):
+            if order.remaining <= 1e-9 or (level > order.price + 1e-12 if buying else level < order.price - 1e-12):
+                break
+            qty = min(levels[level], order.remaining)
+            levels[level] -= qty
+            if levels[level] <= 1e-9:
+                del levels[level]
+            fills.append(self._fill(order, qty, level, ts, maker=False))
+        if order.status == "open":
+            own = book.bids if buying else book.asks
+            order.queue_ahead = own.get(order.price, 0.0)
+            book.resting.setdefault((action, order.price), deque()).append(order)
+        return order, fills
+
+    def cancel(self, order_id):
+        order = self.orders.get(order_id)
+        if order is None or order.status != "open":
+            return order
+        order.status = "cancelled"
+        queue = self.books[order.market].resting.get((order.action, order.price))
+        if queue:
+            try:
+                queue.remove(order)
+            except ValueError:
+                pass
+        return order
+
+    # Market data
+
+    def on_event(self, event):
+        """Applies one feed event; returns our fills [(order_id, qty, price, maker, fee)]."""
+        self.events += 1
+        kind = event["type"]
+        if kind == "trade":
+            return self._on_trade(event["market"], event["price"], event["size"], event["aggressor"], event["ts"])
+        if kind == "book":
+            return self.on_book(event["market"], event["bids"], event["asks"], event["ts"])
+        if kind == "level":
+            book = self.book(event["market"])
+            side = book.bids if event["side"] == "bid" else book.asks
+            price = _key(event["price"])
+            if event["size"] > 0:
+                side[price] = event["size"]
+            else:
+                side.pop(price, None)
+            return self._sync(book, event["ts"])
+        if kind == "resolve":
+            # Settled: nothing trades any more; what's still resting is cancelled
+            for queue in self.book(event["market"]).resting.values():
+                for order in list(queue):
+                    self.cancel(order.order_id)
+        return []
+
+    def on_book(self, market, bids, asks, ts):
+        book = self.book(market)
+        book.bids = {_key(p): s for p, s in bids}
+        book.asks = {_key(p): s for p, s in asks}
+        return self._sync(book, ts)
+
+    def _sync(self, book, ts):
+        """After the displayed book changed: shrink queues to what's displayed, fill what the book crossed."""
+        fills = []
+        for (action, price), queue in list(book.resting.items()):
+            if not queue:
+                continue
+            own = book.bids if action == "buy" else book.asks
+            displayed = own.get(price, 0.0)
+            for order in queue:
+                order.queue_ahead = min(order.queue_ahead, displayed)
+            # Opposite side trading at or through our price means it traded with us first
+            other = book.asks if action == "buy" else book.bids
+            crossing = sorted((p for p in other if (p <= price + 1e-12 if action == "buy" else p >= price - 1e-12)),
+                              reverse=action != "buy")
+            for level in crossing:
+                while queue and other.get(level, 0) > 1e-9:
+                    order = queue[0]
+                    qty = min(order.remaining, other[level])
+                    other[level] -= qty
+                    fills.append(self._fill(order, qty, price, ts, maker=True))
+                    if order.status == "filled":
+                        queue.popleft()
+                if other.get(level, 1) <= 1e-9:
+                    del other[level]
+        return fills
+
+    def _on_trade(self, market, price, size, aggressor, ts):
+        """A print of `size` at `price`: sells hit resting buys (ours at better prices first), buys lift sells."""
+        book = self.book(market)
+        price = _key(price)
+        action = "buy" if aggressor == "sell" else "sell"
+        fills, left = [], size
+        prices = sorted((p for (a, p), q in book.resting.items() if a == action and q), reverse=action == "buy")
+        for level in prices:
+            if left <= 1e-9:
+                break
+            through = level > price + 1e-12 if action == "buy" else level < price - 1e-12
+            if not through and abs(level - price) > 1e-12:
+                break
+            queue = book.resting[(action, level)]
+            for order in list(queue):
+                if left <= 1e-9:
+                    break
+                if not through:
+                    # Queue ahead of us trades first
+                    worked = min(order.queue_ahead, left)
+                    order.queue_ahead -= worked
+                    left -= worked
+                    if left <= 1e-9:
+                        break
+                qty = min(order.remaining, left)
+                left -= qty
+                fills.append(self._fill(order, qty, level, ts, maker=True))
+                if order.status == "filled":
+                    queue.remove(order)
+        return fills
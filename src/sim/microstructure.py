@@ -0,0 +1,206 @@
+import math
+import time
+from dataclasses import dataclass
+import numpy as np
+from src.utils import logger
+from src.sim.feed import FeedWriter
+
+@dataclass
+class SimConfig:
+    markets: int = 2000
+    group_size: int = 8               # Markets per event; they share a common factor (ladders, baskets)
+    polymarket_share: float = 0.5     # Share of events listed on Polymarket instead of Kalshi
+    seed: int = 1
+    start: float = 1.7e9              # Feed timestamp of t = 0
+    dt: float = 0.05                  # Simulation step, seconds
+    factor_vol: float = 0.02          # Event factor volatility, logit units per sqrt(second)
+    idio_vol: float = 0.01            # Market-specific volatility, logit units per sqrt(second)
+    loading: tuple = (0.6, 1.2)       # Range of each market's exposure to its event factor
+    depth_levels: int = 5
+    depth: tuple = (20, 400)          # Contracts per level, drawn uniformly then scaled by distance
+    quote_rate: float = 2.0           # Level-size updates per market per second (quotes moving without price change)
+    trade_rate: float = 0.05          # Hawkes baseline trades per market per second
+    hawkes_alpha: float = 0.6         # Intensity jump per trade (branching ratio alpha / beta < 1)
+    hawkes_beta: float = 1.5          # Intensity decay per second
+    trade_size: float = 25.0          # Median trade size, lognormal
+    news_rate: float = 0.02           # News events per second, across all events
+    news_impact: float = 0.5          # Std of the logit jump a news event applies to its event
+    news_excitation: float = 2.0      # Trade intensity added to every market of the event on news
+    resolve_share: float = 0.1        # Share of markets that resolve within `horizon`
+    horizon: float = 3600.0
+
+class MicrostructureSimulator:
+    """
+    Synthetic activity for thousands of markets, in the recorded-feed format.
+    Fair values are logit random walks driven by one factor per event plus
+    market noise, so prices inside an event move together. Every step:
+    news jumps an event's factor and excites its trading; markets whose
+    best quotes changed publish a book snapshot, a random subset updates a
+    level size; trades arrive as a Hawkes process (each trade raises the
+    market's intensity, which decays at hawkes_beta) and take the touch in
+    the direction of the move; scheduled markets resolve 0/1 by their final
+    probability. Arrays are stepped with numpy; the same config and seed give
+    the same event stream.
+    """
+    def __init__(self, config=None):
+        self.config = c = config or SimConfig()
+        self.rng = rng = np.random.default_rng(c.seed)
+        n = c.markets
+        self.groups = np.arange(n) // c.group_size
+        n_groups = int(self.groups[-1]) + 1 if n else 0
+        poly_group = rng.random(n_groups) < c.polymarket_share
+        self.poly = poly_group[self.groups]
+        self.tick = np.where(self.poly, 0.001, 0.01)
+        self._ticks = self.tick.tolist()
+        # Quoted spread: 1-3 cents either way, on the venue's tick grid
+        self.spread = np.round(rng.integers(1, 4, n) * 0.01, 3)
+        self.names = [f"{int(g) * 7919 + i:077d}" if p else f"KXSIM-{int(g):05d}-M{i % c.group_size}"
+                      for i, (g, p) in enumerate(zip(self.groups, self.poly))]
+        self.venues = ["polymarket" if p else "kalshi" for p in self.poly]
+
+        self.x = rng.normal(0.0, 1.2, n)                      # Logit fair value
+        self.factor = np.zeros(n_groups)
+        self.loading = rng.uniform(*c.loading, n)
+        self.excitation = np.zeros(n)
+        self.mu = c.trade_rate * rng.lognormal(0.0, 0.75, n)  # Some markets are much busier than others
+        self.depth = rng.uniform(*c.depth, n)
+        resolving = rng.random(n) < c.resolve_share
+        self.resolve_at = np.where(resolving, rng.uniform(0, c.horizon, n), np.inf)
+        self.active = np.ones(n, dtype=bool)
+        self.bid = np.full(n, -1.0)
+        self.ask = np.full(n, -1.0)
+        self.t = 0.0
+        self.counts = {"book": 0, "level": 0, "trade": 0, "resolve": 0, "news": 0}
+
+    def _quotes(self, p):
+        """Best bid/ask centred on fair value, snapped to the tick grid."""
+        tick = self.tick
+        bid = np.clip(np.floor((p - self.spread / 2) / tick + 1e-9) * tick, tick, 1 - tick - self.spread)
+        return np.round(bid, 3), np.round(bid + self.spread, 3)
+
+    def _book(self, i, bid, ask, sizes):
+        tick = self._ticks[i]
+        ts = self.config.start + self.t
+        levels = self.config.depth_levels
+        return {"ts": ts, "venue": self.venues[i], "market": self.names[i], "type": "book",
+                "bids": [[round(bid - k * tick, 3), sizes[k]] for k in range(levels) if bid - k * tick > 0],
+                "asks": [[round(ask + k * tick, 3), sizes[levels + k]] for k in range(levels) if ask + k * tick < 1]}
+
+    def step(self):
+        """Advances one dt; returns the events it produced, in timestamp order."""
+        c, rng, n = self.config, self.rng, self.config.markets
+        dt = c.dt
+        self.t += dt
+        ts = c.start + self.t
+        events = []
+
+        # News: a logit jump to one event's factor and a burst of trading interest
+        jump = np.zeros_like(self.factor)
+        for _ in range(rng.poisson(c.news_rate * dt)):
+            g = int(rng.integers(len(self.factor)))
+            impact = float(rng.normal(0.0, c.news_impact))
+            jump[g] += impact
+            members = self.groups == g
+            self.excitation[members] += c.news_excitation
+            events.append({"ts": ts, "venue": self.venues[int(np.argmax(members))], "market": f"event-{g}",
+                           "type": "news", "headline": f"Synthetic development on event {g}", "impact": impact})
+            self.counts["news"] += 1
+
+        # Correlated paths
+        d_factor = rng.normal(0.0, c.factor_vol * math.sqrt(dt), len(self.factor)) + jump
+        self.factor += d_factor
+        dx = self.loading * d_factor[self.groups] + rng.normal(0.0, c.idio_vol * math.sqrt(dt), n)
+        self.x += dx
+        p = 1.0 / (1.0 + np.exp(-self.x))
+
+        # Makers requote (a book snapshot) once fair value leaves their spread; elsewhere level sizes churn
+        moved = self.active & ((p < self.bid) | (p > self.ask))
+        quoting = self.active & ~moved & (rng.random(n) < c.quote_rate * dt)
+        new_bid, new_ask = self._quotes(p)
+        bid = self.bid = np.where(moved, new_bid, self.bid)
+        ask = self.ask = np.where(moved, new_ask, self.ask)
+        idx = np.flatnonzero(moved)
+        if len(idx):
+            scale = np.arange(1, c.depth_levels + 1)[None, :]
+            sizes = np.rint(self.depth[idx, None] * rng.uniform(0.5, 1.5, (len(idx), 2 * c.depth_levels))
+                            * np.concatenate([scale, scale], axis=1) / 2).astype(int) + 1
+            for i, b, a, s in zip(idx.tolist(), bid[idx].tolist(), ask[idx].tolist(), sizes.tolist()):
+                events.append(self._book(i, b, a, s))
+            self.counts["book"] += len(idx)
+        idx = np.flatnonzero(quoting)
+        if len(idx):
+            is_bid = rng.random(len(idx)) < 0.5
+            k = rng.integers(0, c.depth_levels, len(idx))
+            price = np.round(np.where(is_bid, bid[idx] - k * self.tick[idx], ask[idx] + k * self.tick[idx]), 3)
+            size = np.rint(self.depth[idx] * (k + 1) * rng.uniform(0.5, 1.5, len(idx)) / 2).astype(int) + 1
+            for i, b, pr, s in zip(idx.tolist(), is_bid.tolist(), price.tolist(), size.tolist()):
+                if 0 < pr < 1:
+                    events.append({"ts": ts, "venue": self.venues[i], "market": self.names[i], "type": "level",
+                                   "side": "bid" if b else "ask", "price": pr, "size": s})
+                    self.counts["level"] += 1
+
+        # Hawkes trade arrivals: intensity mu + excitation, excitation decays and jumps per trade
+        intensity = (self.mu + self.excitation) * self.active
+        arrivals = rng.poisson(intensity * dt)
+        self.excitation = self.excitation * math.exp(-c.hawkes_beta * dt) + c.hawkes_alpha * arrivals
+        idx = np.flatnonzero(arrivals)
+        if len(idx):
+            counts = arrivals[idx]
+            total = int(counts.sum())
+            markets = np.repeat(idx, counts)
+            # Aggressors lean with the move: buyers when fair value rose
+            buy = rng.random(total) < 1.0 / (1.0 + np.exp(-dx[markets] * 50))
+            size = np.maximum(np.rint(rng.lognormal(math.log(c.trade_size), 1.0, total)), 1).astype(int)
+            price = np.where(buy, ask[markets], bid[markets])
+            for i, b, pr, s in zip(markets.tolist(), buy.tolist(), price.tolist(), size.tolist()):
+                events.append({"ts": ts, "venue": self.venues[i], "market": self.names[i], "type": "trade",
+                               "price": pr, "size": s, "aggressor": "buy" if b else "sell"})
+            self.counts["trade"] += total
+
+        # Resolutions
+        idx = np.flatnonzero(self.active & (self.resolve_at <= self.t))
+        if len(idx):
+            outcome = rng.random(len(idx)) < p[idx]
+            self.active[idx] = False
+            for i, o in zip(idx.tolist(), outcome.tolist()):
+                events.append({"ts": ts, "venue": self.venues[i], "market": self.names[i], "type": "resolve",
+                               "outcome": int(o)})
+            self.counts["resolve"] += len(idx)
+        return events
+
+    def run(self, seconds):
+        """Yields each step's events until `seconds` of market time have been simulated."""
+        for _ in range(int(round(seconds / self.config.dt))):
+            yield self.step()
+
+    def write(self, path, seconds, append=False):
+        """Simulates `seconds` into a feed file; returns the number of events written."""
+        with FeedWriter(path, append=append) as feed:
+            batch = []
+            for events in self.run(seconds):
+                batch.extend(events)
+                if len(batch) >= 50000:
+                    feed.write_many(batch)
+                    batch = []
+            feed.write_many(batch)
+            return feed.written
+
+if __name__ == "__main__":
+    import argparse
+    parser = argparse.ArgumentParser(description="Synthetic market activity in the recorded-feed format")
+    parser.add_argument("--markets", type=int, default=2000)
+    parser.add_argument("--seconds", type=float, default=120.0, help="market time to simulate")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--out", default="data/feeds/synthetic.jsonl", help="feed file (.gz to compress); '-' to discard")
+    args = parser.parse_args()
+
+    config = SimConfig(markets=args.markets, seed=args.seed)
+    sim = MicrostructureSimulator(config)
+    started = time.perf_counter()
+    if args.out == "-":
+        total = sum(len(events) for events in sim.run(args.seconds))
+    else:
+        total = sim.write(args.out, args.seconds)
+    elapsed = time.perf_counter() - started
+    logger.info(f"[SIM] {args.markets} markets, {args.seconds:g}s of market time: {total:,} events in {elapsed:.2f}s "
+                f"({total / elapsed * 60 / 1e6:.2f}M events/min, {args.seconds / elapsed:.1f}x real time) {sim.counts}")
@@ -0,0 +1,288 @@
+import time
+import heapq
+import random
+import sqlite3
+from datetime import datetime
+from src.utils import logger
+from src.execution.venues import VenueAdapter, VenueError
+from src.execution.engine import ExecutionEngine
+from src.execution.orders import OPEN, PARTIAL, FILLED, CANCELLED
+from src.sim.feed import FeedWriter, read_feed
+from src.sim.matching import MatchingEngine
+
+class SimVenue(VenueAdapter):
+    """
+    Paper-trading venue: orders go to a MatchingEngine instead of the exchange.
+    With a `source` adapter the simulated book follows the live one (re-read at
+    most every REFRESH_INTERVAL per market, on get_book and poll), so resting
+    orders fill when the real book trades through them. A `recorder` FeedWriter
+    keeps every book and trade it reads, which later replays through `replay`.
+    """
+    tradeable = True
+
+    def __init__(self, name, source=None, matcher=None, recorder=None, clock=time.time):
+        self.name = name
+        self.source = source
+        self.matcher = matcher or MatchingEngine(name)
+        self.recorder = recorder
+        self.clock = clock
+        self.REFRESH_INTERVAL = 1.0
+        self._refreshed = {}    # market_id -> clock() of the last live read
+        self._orders = {}       # venue_order_id -> (SimOrder, order side)
+
+    async def _refresh(self, market_id):
+        if self.source is None:
+            return
+        last = self._refreshed.get(market_id)
+        if last is not None and self.clock() - last < self.REFRESH_INTERVAL:
+            return
+        book = await self.source.get_book(market_id, "yes")
+        ts = self._refreshed[market_id] = self.clock()
+        self.matcher.on_book(market_id, book["bids"], book["asks"], ts)
+        if self.recorder:
+            self.recorder.book(ts, self.name, market_id, book["bids"], book["asks"])
+
+    async def get_book(self, market_id, side):
+        await self._refresh(market_id)
+        if market_id not in self.matcher.books:
+            raise VenueError(f"no simulated book for {market_id}")
+        book = self.matcher.books[market_id]
+        bids = sorted(book.bids.items(), key=lambda l: -l[0])
+        asks = sorted(book.asks.items())
+        if side == "no":
+            bids, asks = [(round(1 - p, 6), s) for p, s in asks], [(round(1 - p, 6), s) for p, s in bids]
+        return {"bids": bids, "asks": asks}
+
+    async def get_settlement(self, market_id, side):
+        # Paper positions settle when the real market does
+        return await self.source.get_settlement(market_id, side) if self.source else None
+
+    async def get_trades(self, market_id, since=None):
+        if self.source is None:
+            return []
+        trades = await self.source.get_trades(market_id, since)
+        if self.recorder:
+            for t in trades:
+                self.recorder.trade(t["ts"], self.name, market_id, t["price"], t["size"], t["aggressor"])
+        return trades
+
+    def _report(self, vid):
+        sim, side = self._orders[vid]
+        if sim.status == "cancelled":
+            status = CANCELLED
+        elif sim.status == "filled":
+            status = FILLED
+        else:
+            status = PARTIAL if sim.filled else OPEN
+        avg = sim.avg_price if sim.filled else sim.price
+        return {
+            "venue_order_id": vid,
+            "status": status,
+            "filled": sim.filled,
+            "avg_price": 1 - avg if side == "no" else avg,
+            "fees": sim.fees,
+        }
+
+    async def place(self, order):
+        await self._refresh(order.market_id)
+        # The matcher keeps YES books: buying NO at p is selling YES at 1 - p
+        action, price = order.action, order.price
+        if order.side == "no":
+            action, price = ("sell" if action == "buy" else "buy"), 1 - price
+        sim, _ = self.matcher.submit(order.market_id, action, price, order.size, self.clock())
+        self._orders[sim.order_id] = (sim, order.side)
+        return self._report(sim.order_id)
+
+    async def poll(self, order):
+        if order.venue_order_id not in self._orders:
+            raise VenueError(f"unknown order {order.venue_order_id}")
+        await self._refresh(order.market_id)
+        return self._report(order.venue_order_id)
+
+    async def cancel(self, order):
+        if order.venue_order_id not in self._orders:
+            raise VenueError(f"unknown order {order.venue_order_id}")
+        self.matcher.cancel(order.venue_order_id)
+        return self._report(order.venue_order_id)
+
+def load_trades(db_path="data/trading_history.db", actions=("BUY", "SELL")):
+    """Single-leg trades from the TradeLogger history, oldest first, with epoch timestamps."""
+    try:
+        with sqlite3.connect(db_path) as conn:
+            conn.row_factory = sqlite3.Row
+            marks = ",".join("?" * len(actions))
+            rows = conn.execute(f"SELECT * FROM trades WHERE action IN ({marks}) ORDER BY timestamp", actions).fetchall()
+    except Exception as e:
+        logger.error(f"[SIM] Failed to load trade history from {db_path}: {e}")
+        return []
+    return [dict(r, ts=datetime.fromisoformat(r["timestamp"]).timestamp()) for r in rows]
+
+def _pct(values, q):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    return values[min(int(q * len(values)), len(values) - 1)]
+
+def replay(events, trades, aliases=None, max_slippage=0.02, fill_timeout=30.0, matchers=None):
+    """
+    Replays a recorded feed and re-executes each logged trade against it at its
+    logged time, the way ExecutionEngine would: limit at the worst level the
+    size needs, rejected past `max_slippage` over the best price, the rest left
+    resting for `fill_timeout` feed-seconds. Logged sizes are USD notional.
+    `aliases` maps logged market ids to feed markets (Polymarket trades are
+    logged by market id, the feed is keyed by outcome token).
+    Returns the divergence report: per-trade results and the aggregate.
+    """
+    aliases = aliases or {}
+    matchers = matchers if matchers is not None else {}
+    trades = sorted(trades, key=lambda t: t["ts"])
+    results, working, deadlines = [], {}, []
+    next_trade, first_ts, last_ts = 0, None, None
+    started = time.perf_counter()
+
+    def submit(trade):
+        venue = trade["platform"]
+        matcher = matchers.get(venue)
+        if matcher is None:
+            matcher = matchers[venue] = MatchingEngine(venue)
+        market = aliases.get(trade["market_id"], trade["market_id"])
+        action = trade["action"].lower()
+        result = {"trade": trade, "market": market, "logged_price": trade["price"], "size": trade["size"] / trade["price"],
+                  "filled": 0.0, "sim_price": None, "fees": 0.0, "reason": ""}
+        results.append(result)
+        book = matcher.books.get(market)
+        side = (book.asks if action == "buy" else book.bids) if book else None
+        if not side:
+            result["reason"] = "no book"
+            return
+        levels = sorted(side.items(), reverse=action != "buy")
+        limit, _, _ = ExecutionEngine.limit_price({"asks" if action == "buy" else "bids": levels}, result["size"], action)
+        best = levels[0][0]
+        if (limit - best if action == "buy" else best - limit) / best > max_slippage + 1e-9:
+            result["reason"] = "slippage"
+            return
+        order, _ = matcher.submit(market, action, limit, result["size"], trade["ts"])
+        result["order"] = order
+        if order.status == "open":
+            working[order.order_id] = (matcher, order)
+            heapq.heappush(deadlines, (trade["ts"] + fill_timeout, order.order_id))
+
+    for event in events:
+        ts = event["ts"]
+        first_ts = ts if first_ts is None else first_ts
+        last_ts = ts
+        while next_trade < len(trades) and trades[next_trade]["ts"] <= ts:
+            submit(trades[next_trade])
+            next_trade += 1
+        while deadlines and deadlines[0][0] <= ts:
+            _, oid = heapq.heappop(deadlines)
+            matcher, _ = working.pop(oid, (None, None))
+            if matcher:
+                matcher.cancel(oid)
+        matcher = matchers.get(event["venue"])
+        if matcher is None:
+            matcher = matchers[event["venue"]] = MatchingEngine(event["venue"])
+        matcher.on_event(event)
+    elapsed = time.perf_counter() - started
+    for trade in trades[next_trade:]:
+        submit(trade)
+
+    divergences, fill_ratios, fees, reasons = [], [], 0.0, {}
+    for r in results:
+        order = r.pop("order", None)
+        if order is not None:
+            if order.status == "open":
+                order.status = "cancelled"
+            r["filled"], r["sim_price"], r["fees"] = order.filled, order.avg_price, order.fees
+            if not order.filled:
+                r["reason"] = "unfilled"
+        fill_ratios.append(r["filled"] / r["size"] if r["size"] else 0.0)
+        fees += r["fees"]
+        if r["sim_price"] is not None:
+            # Positive = the simulator paid more (bought higher / sold lower) than the log says
+            sign = 1 if r["trade"]["action"].upper() == "BUY" else -1
+            r["divergence_bps"] = sign * (r["sim_price"] - r["logged_price"]) / r["logged_price"] * 1e4
+            divergences.append(r["divergence_bps"])
+        if r["reason"]:
+            reasons[r["reason"]] = reasons.get(r["reason"], 0) + 1
+
+    n_events = sum(m.events for m in matchers.values())
+    span = (last_ts - first_ts) if first_ts is not None else 0.0
+    return {
+        "trades": len(results),
+        "fill_ratio": sum(fill_ratios) / len(fill_ratios) if fill_ratios else 0.0,
+        "divergence_bps": {
+            "mean": sum(divergences) / len(divergences) if divergences else 0.0,
+            "p50": _pct(divergences, 0.50),
+            "p95": _pct(divergences, 0.95),
+            "max": max(divergences, default=0.0),
+        },
+        "fees_usd": fees,
+        "not_filled": reasons,
+        "events": n_events,
+        "events_per_sec": n_events / elapsed if elapsed else 0.0,
+        "speedup": span / elapsed if elapsed else 0.0,
+        "results": results,
+    }
+
+def format_report(report):
+    d = report["divergence_bps"]
+    return (f"[SIM] {report['trades']} trades replayed over {report['events']} events "
+            f"({report['events_per_sec']:,.0f} events/s, {report['speedup']:,.0f}x real time)\n"
+            f"[SIM] fill ratio {report['fill_ratio']:.1%}; fill-price divergence vs log: mean {d['mean']:+.1f} bps, "
+            f"p50 {d['p50']:+.1f}, p95 {d['p95']:+.1f}, max {d['max']:+.1f}; fees ${report['fees_usd']:.2f}; "
+            f"not filled: {report['not_filled'] or 'none'}")
+
+def synthetic_session(path, markets=50, seconds=3600, rate=50, trades=200, seed=7):
+    """Writes a random-walk session feed to `path`; returns trade rows priced off the book plus noise."""
+    rng = random.Random(seed)
+    mids = {f"KXDEMO-{i:03d}": rng.uniform(0.15, 0.85) for i in range(markets)}
+    names = list(mids)
+    logged, t0 = [], time.time() - seconds
+    trade_at = sorted(rng.uniform(0, seconds) for _ in range(trades))
+    with FeedWriter(path, append=False) as feed:
+        batch, ts, step = [], 0.0, 1.0 / rate
+        while ts < seconds:
+            market = rng.choice(names)
+            mid = mids[market] = min(max(mids[market] + rng.gauss(0, 0.004), 0.03), 0.97)
+            if rng.random() < 0.3:
+                bid = round(mid - 0.01, 2)
+                aggressor = rng.choice(("buy", "sell"))
+                price = round(bid + 0.02, 2) if aggressor == "buy" else bid
+                batch.append({"ts": t0 + ts, "venue": "kalshi", "market": market, "type": "trade",
+                              "price": price, "size": rng.randint(1, 80), "aggressor": aggressor})
+            else:
+                bid = round(mid - 0.01, 2)
+                batch.append({"ts": t0 + ts, "venue": "kalshi", "market": market, "type": "book",
+                              "bids": [[round(bid - 0.01 * i, 2), rng.randint(10, 300)] for i in range(5)],
+                              "asks": [[round(bid + 0.02 + 0.01 * i, 2), rng.randint(10, 300)] for i in range(5)]})
+            while trade_at and trade_at[0] <= ts:
+                trade_at.pop(0)
+                logged.append({"ts": t0 + ts + 0.5, "platform": "kalshi", "market_id": market, "action": "BUY",
+                               "price": round(bid + 0.02 + rng.choice((-0.01, 0.0, 0.0, 0.01)), 2),
+                               "size": rng.choice((10.0, 25.0, 50.0, 100.0))})
+            if len(batch) >= 10000:
+                feed.write_many(batch)
+                batch = []
+            ts += step
+        feed.write_many(batch)
+    return logged
+
+if __name__ == "__main__":
+    import argparse
+    parser = argparse.ArgumentParser(description="Replay logged trades against a recorded feed")
+    parser.add_argument("--feed", help="recorded feed (.jsonl / .jsonl.gz); omitted: a synthetic one-hour session")
+    parser.add_argument("--trades", default="data/trading_history.db", help="TradeLogger database")
+    parser.add_argument("--timeout", type=float, default=30.0, help="feed-seconds a remainder may rest")
+    args = parser.parse_args()
+
+    if args.feed:
+        trades = load_trades(args.trades)
+        report = replay(read_feed(args.feed), trades, fill_timeout=args.timeout)
+    else:
+        path = "data/feeds/synthetic-session.jsonl"
+        started = time.perf_counter()
+        trades = synthetic_session(path)
+        print(f"[SIM] wrote {path} in {time.perf_counter() - started:.2f}s")
+        report = replay(read_feed(path), trades, fill_timeout=args.timeout)
+    print(format_report(report))
@@ -0,0 +1,105 @@
+import os
+import asyncio
+import tempfile
+import unittest
+from src.sim.matching import MatchingEngine, FeeModel
+from src.sim.paper import SimVenue, replay
+from src.sim.feed import FeedWriter, read_feed
+from src.sim.microstructure import MicrostructureSimulator, SimConfig
+from src.execution import ExecutionEngine, LocalVenue, FILLED
+
+class MatchingEngineTest(unittest.TestCase):
+    def setUp(self):
+        self.engine = MatchingEngine("kalshi")
+        self.engine.on_book("M", [(0.40, 100), (0.39, 50)], [(0.42, 30), (0.43, 50)], 0.0)
+
+    def test_marketable_order_walks_levels_and_pays_taker_fee(self):
+        order, fills = self.engine.submit("M", "buy", 0.43, 40, 1.0)
+        self.assertEqual(order.status, "filled")
+        self.assertEqual([(f[1], f[2]) for f in fills], [(30, 0.42), (10, 0.43)])
+        # ceil(0.07 * 30 * 0.42 * 0.58 * 100) / 100 and the same for 10 @ 0.43
+        self.assertAlmostEqual(order.fees, 0.52 + 0.18)
+        # Liquidity taken stays taken until the next snapshot
+        self.assertEqual(self.engine.books["M"].asks, {0.43: 40})
+
+    def test_queue_position_and_partial_fills(self):
+        order, fills = self.engine.submit("M", "buy", 0.40, 20, 1.0)
+        self.assertEqual((fills, order.queue_ahead), ([], 100))
+        # 90 traded at our price: all of it was ahead of us
+        self.assertEqual(self.engine.on_event({"type": "trade", "market": "M", "price": 0.40, "size": 90,
+                                               "aggressor": "sell", "ts": 2.0}), [])
+        # Displayed size drops to 5 (cancels ahead of us), then 15 trades: 5 ahead, 10 to us
+        self.engine.on_event({"type": "level", "market": "M", "side": "bid", "price": 0.40, "size": 5, "ts": 3.0})
+        fills = self.engine.on_event({"type": "trade", "market": "M", "price": 0.40, "size": 15,
+                                      "aggressor": "sell", "ts": 4.0})
+        self.assertEqual([(f[1], f[3]) for f in fills], [(10, True)])
+        self.assertEqual(order.status, "open")
+        # A sweep through our price fills the rest without touching the queue
+        self.engine.on_event({"type": "trade", "market": "M", "price": 0.38, "size": 50, "aggressor": "sell", "ts": 5.0})
+        self.assertEqual((order.status, order.filled, order.fees), ("filled", 20, 0.0))
+
+    def test_book_crossing_resting_order_fills_it(self):
+        order, _ = self.engine.submit("M", "sell", 0.45, 10, 1.0)
+        fills = self.engine.on_book("M", [(0.46, 4)], [(0.47, 10)], 2.0)
+        self.assertEqual([(f[1], f[2]) for f in fills], [(4, 0.45)])
+        self.assertEqual(order.remaining, 6)
+
+    def test_polymarket_fee_rate(self):
+        self.assertAlmostEqual(FeeModel("polymarket", taker_rate=0.02).fee(100, 0.7, maker=False), 0.6)
+
+class PaperTradingTest(unittest.TestCase):
+    def test_sim_venue_follows_live_book(self):
+        live = LocalVenue(name="kalshi")
+        live.set_book("M", bids=[(0.50, 10)], asks=[(0.52, 5), (0.53, 100)])
+        clock = [0.0]
+        venue = SimVenue("kalshi", source=live, clock=lambda: clock[0])
+        engine = ExecutionEngine([venue], fill_timeout=0.2, poll_interval=0.01)
+        order = asyncio.run(engine.execute("kalshi", "M", size=20))
+        self.assertEqual((order.state, order.filled), (FILLED, 20))
+        self.assertAlmostEqual(order.avg_price, (5 * 0.52 + 15 * 0.53) / 20)
+        # Nothing was sent to the live venue
+        self.assertEqual(live.placed, 0)
+
+    def test_replay_reports_divergence(self):
+        events = [
+            {"ts": 0.0, "venue": "kalshi", "market": "M", "type": "book", "bids": [[0.49, 10]], "asks": [[0.50, 100]]},
+            {"ts": 5.0, "venue": "kalshi", "market": "M", "type": "book", "bids": [[0.50, 10]], "asks": [[0.51, 100]]},
+        ]
+        trades = [{"ts": 1.0, "platform": "kalshi", "market_id": "M", "action": "BUY", "price": 0.49, "size": 4.9},
+                  {"ts": 2.0, "platform": "kalshi", "market_id": "X", "action": "BUY", "price": 0.30, "size": 3.0}]
+        report = replay(events, trades)
+        self.assertEqual(report["trades"], 2)
+        self.assertEqual(report["not_filled"], {"no book": 1})
+        self.assertAlmostEqual(report["results"][0]["divergence_bps"], (0.50 - 0.49) / 0.49 * 1e4)
+
+    def test_recorder_rolls_over_to_a_new_file(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            first, second = os.path.join(tmp, "paper-20261016.jsonl"), os.path.join(tmp, "feeds", "paper-20261017.jsonl")
+            recorder = FeedWriter(first)
+            venue = SimVenue("kalshi", matcher=MatchingEngine("kalshi"), recorder=recorder)
+            recorder.book(1.0, "kalshi", "M", [(0.49, 10)], [(0.50, 10)])
+            recorder.reopen(second)
+            # The venue keeps its recorder; only the file underneath changed
+            venue.recorder.trade(2.0, "kalshi", "M", 0.50, 3, "buy")
+            recorder.close()
+            self.assertEqual([e["type"] for e in read_feed(first)], ["book"])
+            self.assertEqual([e["type"] for e in read_feed(second)], ["trade"])
+            self.assertEqual(recorder.written, 2)
+
+class MicrostructureSimulatorTest(unittest.TestCase):
+    def test_seeded_runs_are_identical_and_replayable(self):
+        def events(seed):
+            return [e for step in MicrostructureSimulator(SimConfig(markets=64, seed=seed)).run(30) for e in step]
+
+        first = events(3)
+        self.assertEqual(first, events(3))
+        self.assertNotEqual(first, events(4))
+        self.assertTrue({"book", "level", "trade"} <= {e["type"] for e in first})
+        # Timestamps never go backwards, and the matcher accepts every event
+        self.assertEqual(first, sorted(first, key=lambda e: e["ts"]))
+        matchers = {}
+        for e in first:
+            matchers.setdefault(e["venue"], MatchingEngine(e["venue"])).on_event(e)
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,265 @@
+import os
+import queue
+import struct
+import asyncio
+import multiprocessing as mp
+from datetime import datetime, timezone
+from multiprocessing import shared_memory
+from src.utils import logger
+
+PLATFORMS = ("kalshi", "polymarket")
+
+# One fixed-width row per normalized market:
+# seq, platform, anomaly, price, spread, volume, close_ts, priority_score, id, title, token_id, market_id, outcome
+# (a Polymarket order goes to the outcome's token id; ids are up to 78 decimal digits)
+_RECORD = struct.Struct("<IBB2xddddd64s192s80s64s64s")
+
+class MarketBus:
+    """
+    Shared-memory table of normalized market state. The table is split into one
+    partition per ingestion worker and each partition is a ring only its owner
+    writes, so writers never contend. Every row carries a seqlock counter: odd while
+    being written, bumped again when done, so readers in other processes can detect
+    a torn read and retry instead of taking a lock.
+    """
+    def __init__(self, name=None, capacity=8192, partitions=1, create=False):
+        self.capacity = capacity
+        self.partitions = partitions
+        size = capacity * _RECORD.size
+        self.shm = shared_memory.SharedMemory(name=name, create=create, size=size if create else 0)
+        self.name = self.shm.name
+        self._cursor = 0
+
+    @classmethod
+    def create(cls, capacity, partitions):
+        return cls(capacity=capacity, partitions=partitions, create=True)
+
+    def spec(self):
+        return (self.name, self.capacity, self.partitions)
+
+    def _partition_bounds(self, partition):
+        per = self.capacity // self.partitions
+        return partition * per, per
+
+    def write(self, partition, market):
+        """Writes a normalized market into the owner's ring. Returns a (slot, seq) handle."""
+        base, per = self._partition_bounds(partition)
+        slot = base + (self._cursor % per)
+        self._cursor += 1
+
+        offset = slot * _RECORD.size
+        seq = struct.unpack_from("<I", self.shm.buf, offset)[0]
+        struct.pack_into("<I", self.shm.buf, offset, seq + 1)   # odd: write in progress
+
+        close = market.get("close_date")
+        _RECORD.pack_into(
+            self.shm.buf, offset,
+            seq + 1,
+            PLATFORMS.index(market["platform"]),
+            1 if market.get("anomaly_flag") else 0,
+            float(market.get("price", 50)),
+            float(market.get("spread", 0)),
+            float(market.get("volume", 0)),
+            close.timestamp() if close else 0.0,
+            float(market.get("priority_score", 0.0)),
+            str(market["id"]).encode()[:64],
+            market.get("title", "").encode()[:192],
+            str(market.get("token_id") or "").encode()[:80],
+            str(market.get("market_id") or "").encode()[:64],
+            str(market.get("outcome") or "").encode()[:64],
+        )
+        struct.pack_into("<I", self.shm.buf, offset, seq + 2)   # even: published
+        return slot, seq + 2
+
+    def read(self, slot, expected_seq=None, retries=100):
+        """Reads a row without locking. Returns None if the slot has been overwritten since the handle was issued."""
+        offset = slot * _RECORD.size
+        for _ in range(retries):
+            row = _RECORD.unpack_from(self.shm.buf, offset)
+            seq_after = struct.unpack_from("<I", self.shm.buf, offset)[0]
+            if row[0] % 2 or row[0] != seq_after:
+                continue
+            if expected_seq is not None and row[0] != expected_seq:
+                return None
+            _, platform, anomaly, price, spread, volume, close_ts, score, mid, title, token, market_id, outcome = row
+            market = {
+                "id": mid.rstrip(b"\0").decode(errors="ignore"),
+                "platform": PLATFORMS[platform],
+                "title": title.rstrip(b"\0").decode(errors="ignore"),
+                "volume": volume,
+                "close_date": datetime.fromtimestamp(close_ts, timezone.utc) if close_ts else None,
+                "price": price,
+                "spread": spread,
+                "anomaly_flag": "wide_spread" if anomaly else None,
+                "priority_score": score,
+            }
+            # Polymarket-only fields stay absent on Kalshi rows, as on the scanner's own dicts
+            for key, value in (("token_id", token), ("market_id", market_id), ("outcome", outcome)):
+                if value.rstrip(b"\0"):
+                    market[key] = value.rstrip(b"\0").decode(errors="ignore")
+            return market
+        return None
+
+    def close(self, unlink=False):
+        self.shm.close()
+        if unlink:
+            self.shm.unlink()
+
+def _put(q, item, halt, timeout=0.5):
+    """Blocking put with backpressure that still notices a halt."""
+    while not halt.is_set():
+        try:
+            q.put(item, timeout=timeout)
+            return True
+        except queue.Full:
+            continue
+    return False
+
+def _get(q, halt, timeout=0.5):
+    while not halt.is_set():
+        try:
+            return q.get(timeout=timeout)
+        except queue.Empty:
+            continue
+    return None
+
+# --- Stage workers (module-level so they can be spawned) ---
+
+def ingestion_worker(partition, bus_spec, jobs, out_q, halt):
+    from src.scanner import MarketScanner
+    from src.prioritizer import CandidatePrioritizer
+    name, capacity, partitions = bus_spec
+    bus = MarketBus(name, capacity, partitions)
+    scanner = MarketScanner()
+    prioritizer = CandidatePrioritizer()
+
+    while (platform := _get(jobs, halt)) is not None:
+        candidates = prioritizer.top_k(scanner.scan_venue(platform))
+        logger.info(f"[INGEST {partition}] {platform}: publishing {len(candidates)} candidates.")
+        for cand in candidates:
+            if not _put(out_q, bus.write(partition, cand), halt):
+                break
+    bus.close()
+
+def research_worker(bus_spec, in_q, out_q, halt):
+    from skills.research.scripts.research import ResearcherAgent
+    from skills.research.scripts.scrapers import NewsScraper
+    from skills.research.scripts.twitter import TwitterScraper
+    bus = MarketBus(*bus_spec)
+    researcher, news_scraper, twitter_scraper = ResearcherAgent(), NewsScraper(), TwitterScraper()
+
+    while (handle := _get(in_q, halt)) is not None:
+        target = bus.read(*handle)
+        if target is None:
+            continue  # Overwritten by a newer sweep before we got to it
+        news = news_scraper.fetch_news(target['title'], limit=3)
+        tweets = twitter_scraper.fetch_recent_tweets(target['title'], limit=3)
+        brief = researcher.analyze(target['title'], news, tweets)
+        _put(out_q, (handle, brief), halt)
+    bus.close()
+
+def prediction_worker(bus_spec, in_q, out_q, halt, api_spend, cost_per_eval, budget):
+    from skills.predict.scripts.ensemble import PredictorAgent
+    bus = MarketBus(*bus_spec)
+    predictor = PredictorAgent()
+
+    while (item := _get(in_q, halt)) is not None:
+        handle, brief = item
+        target = bus.read(*handle)
+        if target is None:
+            continue
+        with api_spend.get_lock():
+            if api_spend.value + cost_per_eval > budget:
+                logger.warning(f"AI Budget exhausted (${api_spend.value:.2f}). Dropping {target['id']}.")
+                continue
+            api_spend.value += cost_per_eval
+        prediction = asyncio.run(predictor.evaluate_edge(target['title'], target['price']/100.0, brief))
+        logger.info(f"[PREDICT] {target['id']} edge {prediction['edge']:.4f}")
+        if prediction['signal'] == "TRADE":
+            _put(out_q, (handle, brief, prediction), halt)
+    bus.close()
+
+class StagePipeline:
+    """
+    Runs ingestion, research and prediction as separate process pools connected
+    by bounded queues. A full downstream queue blocks the upstream stage
+    (backpressure) instead of buffering an unbounded backlog of stale markets.
+    Execution is the last stage but not a pool: the owner drains TRADE signals
+    with `next_signal` into its own engine, so orders, positions, the bankroll
+    and the kill switch's mass-cancel all live in one long-lived event loop.
+    """
+    def __init__(self, workers=None, queue_depth=64, bus_capacity=8192, api_budget=50.0, cost_per_eval=0.05):
+        cores = os.cpu_count() or 1
+        self.workers = {"ingestion": len(PLATFORMS), "research": cores, "prediction": cores}
+        self.workers.update(workers or {})
+        self.queue_depth = queue_depth
+        self.bus_capacity = bus_capacity
+        self.api_budget = api_budget
+        self.cost_per_eval = cost_per_eval
+
+        self.ctx = mp.get_context("spawn")
+        self.halt = self.ctx.Event()
+        self.api_spend = self.ctx.Value("d", 0.0)
+        self.processes = []
+        self.bus = None
+
+    @staticmethod
+    def workers_from_env(value):
+        """Parses POLYMASTER_STAGE_WORKERS, e.g. "research=8,prediction=4"."""
+        out = {}
+        for part in filter(None, (value or "").split(",")):
+            stage, _, count = part.partition("=")
+            out[stage.strip()] = int(count)
+        return out
+
+    def start(self):
+        ctx, n = self.ctx, self.workers
+        self.bus = MarketBus.create(self.bus_capacity, n["ingestion"])
+        spec = self.bus.spec()
+
+        # Held on self: if the parent drops its handles the queues' semaphores vanish under the children
+        self.ingest_jobs = ctx.Queue()
+        self.research_q = research_q = ctx.Queue(maxsize=self.queue_depth)
+        self.predict_q = predict_q = ctx.Queue(maxsize=self.queue_depth)
+        self.exec_q = exec_q = ctx.Queue(maxsize=self.queue_depth)
+
+        targets = []
+        targets += [(ingestion_worker, (i, spec, self.ingest_jobs, research_q, self.halt)) for i in range(n["ingestion"])]
+        targets += [(research_worker, (spec, research_q, predict_q, self.halt))] * n["research"]
+        targets += [(prediction_worker, (spec, predict_q, exec_q, self.halt, self.api_spend, self.cost_per_eval, self.api_budget))] * n["prediction"]
+
+        for fn, args in targets:
+            p = ctx.Process(target=fn, args=args, name=fn.__name__, daemon=True)
+            p.start()
+            self.processes.append(p)
+        logger.info(f"Stage pipeline started: {n}")
+
+    def submit_sweep(self):
+        for platform in PLATFORMS:
+            self.ingest_jobs.put(platform)
+
+    def next_signal(self, timeout=0.5):
+        """Blocking. The next (target, brief, prediction) TRADE signal, or None after `timeout`."""
+        try:
+            handle, brief, prediction = self.exec_q.get(timeout=timeout)
+        except queue.Empty:
+            return None
+        target = self.bus.read(*handle)
+        if target is None:
+            logger.warning("Market row was recycled before execution; skipping stale signal.")
+            return None
+        return target, brief, prediction
+
+    def reset_budget(self):
+        with self.api_spend.get_lock():
+            self.api_spend.value = 0.0
+
+    def stop(self, grace=5.0):
+        self.halt.set()
+        for p in self.processes:
+            p.join(timeout=grace)
+            if p.is_alive():
+                p.terminate()
+        if self.bus:
+            self.bus.close(unlink=True)
+        logger.info("Stage pipeline stopped.")
@@ -0,0 +1,101 @@
+import os
+import sys
+import time
+import importlib
+from contextlib import contextmanager
+
+class StartupProfiler:
+    """
+    Records how long each component takes to import and to construct. Disabled
+    unless POLYMASTER_PROFILE_STARTUP=1, in which case sections cost one
+    perf_counter() pair each.
+    """
+    def __init__(self, enabled=False):
+        self.enabled = enabled
+        self.records = []
+
+    @contextmanager
+    def section(self, name, kind="init"):
+        if not self.enabled:
+            yield
+            return
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            self.records.append((kind, name, time.perf_counter() - start))
+
+    def report(self):
+        lines = [f"{'KIND':<8}{'COMPONENT':<52}{'MS':>10}"]
+        for kind, name, secs in self.records:
+            lines.append(f"{kind:<8}{name:<52}{secs * 1000:>10.1f}")
+        total = sum(r[2] for r in self.records)
+        lines.append(f"{'':<8}{'TOTAL':<52}{total * 1000:>10.1f}")
+        return "\n".join(lines)
+
+profiler = StartupProfiler(enabled=os.getenv("POLYMASTER_PROFILE_STARTUP") == "1")
+
+class lazy_component:
+    """
+    Property that builds a heavy client (Groq, RSA key) on first access and
+    caches it on the instance, so constructing the owning object stays cheap.
+    """
+    def __init__(self, factory):
+        self.factory = factory
+        self.name = factory.__name__
+
+    def __set_name__(self, owner, name):
+        self.name = name
+        self.qualname = f"{owner.__name__}.{name}"
+
+    def __get__(self, instance, owner):
+        if instance is None:
+            return self
+        with profiler.section(self.qualname, "lazy"):
+            value = self.factory(instance)
+        instance.__dict__[self.name] = value
+        return value
+
+# Import order matters for the report: each row only counts what earlier rows did not already load
+COMPONENTS = [
+    "src.utils",
+    "src.api.kalshi",
+    "src.api.polymarket",
+    "src.scanner",
+    "src.prioritizer",
+    "src.arbitrage",
+    "skills.research.scripts.research",
+    "skills.research.scripts.scrapers",
+    "skills.research.scripts.twitter",
+    "skills.predict.scripts.ensemble",
+    "skills.predict_market_bot.scripts.validate_risk",
+    "skills.compound.scripts.history",
+    "src.orchestrator",
+]
+
+def profile_startup(force_lazy=False):
+    """Imports every component, builds the orchestrator and optionally every lazy client, then prints the report."""
+    profiler.enabled = True
+    for module in COMPONENTS:
+        with profiler.section(module, "import"):
+            importlib.import_module(module)
+
+    from src.orchestrator import TradingBotOrchestrator
+    with profiler.section("TradingBotOrchestrator()", "init"):
+        bot = TradingBotOrchestrator()
+
+    if force_lazy:
+        for owner, attr in ((bot.scanner.aggregator.kalshi, "private_key"), (bot.researcher, "client"),
+                            (bot.predictor, "client")):
+            try:
+                getattr(owner, attr)
+            except Exception as e:
+                print(f"{type(owner).__name__}.{attr} failed to build: {e}")
+
+    print(profiler.report())
+
+if __name__ == "__main__":
+    # python -m src.startup [--force-lazy]
+    # Re-import so lazy_component and this entry point share one profiler instance
+    from src.startup import profile_startup
+    profile_startup(force_lazy="--force-lazy" in sys.argv)
@@ -0,0 +1,283 @@
+import math
+import numpy as np
+from src.utils import logger
+
+ABOVE_TYPES = ("greater", "greater_or_equal")
+
+def _above(strike, inclusive, s):
+    # Kalshi "greater" is strict (S > K); "greater_or_equal" includes the strike
+    return (s >= strike) if inclusive else (s > strike)
+
+def _between(lo, hi, s):
+    # "between" ranges include both bounds
+    return lo <= s <= hi
+
+class StrikeLadderScanner:
+    """
+    No-arbitrage checks across Kalshi strike ladders (all markets of one event,
+    i.e. one series on one expiry). Prices are YES cents.
+
+    Monotonicity: P(above K) can't rise with K, so a higher strike's YES bid above
+    a lower strike's YES ask is locked profit (buy YES low, buy NO high).
+
+    Butterfly: a range market [K1, K2] is roughly the spread above(K1) - above(K2).
+    When the range and the synthetic spread disagree by more than costs, buy the
+    cheap side and sell the rich one. The identity only holds exactly when the
+    boundaries line up: Kalshi ranges include both bounds while "greater" strikes
+    are strict, so at S == K1 the range pays and above(K1) doesn't. Each
+    butterfly's payout is therefore the minimum over every settlement region,
+    boundaries included, computed once per ladder load. A side whose worst case
+    falls short of the nominal 100 / 200 shows it in its edge; the rich side
+    against a strict K1 never trades.
+
+    Ladders live in padded (ladder x strike) arrays so every check is a single
+    vectorized pass; `on_orderbook` updates one cell and re-checks only that ladder.
+    """
+    def __init__(self, fee_rate=0.07, min_edge_cents=1.0, max_contracts=500, unconfirmed_size=1):
+        self.FEE_RATE = fee_rate                  # Kalshi taker fee: rate * P * (1 - P) per contract
+        self.MIN_EDGE_CENTS = min_edge_cents      # Profit per contract required after fees
+        self.MAX_CONTRACTS = max_contracts
+        # Snapshot quotes from GET /markets carry no size; size 1 until the orderbook confirms depth
+        self.UNCONFIRMED_SIZE = unconfirmed_size
+
+        self.events = []        # ladder row -> event_ticker
+        self.tickers = []       # ladder row -> [ticker per strike column]
+        self.cell = {}          # ticker -> (row, col) for above markets, ("range", idx) for ranges
+        self.strike = self.bid = self.ask = self.bid_size = self.ask_size = np.zeros((0, 0))
+        self.inclusive = np.zeros((0, 0), dtype=bool)
+        self.ranges = []        # (ticker, row, col_lo, col_hi)
+        self.r_row = self.r_lo = self.r_hi = np.zeros(0, dtype=int)
+        self.r_bid = self.r_ask = self.r_bid_size = self.r_ask_size = np.zeros(0)
+        self.r_cheap_payout = self.r_rich_payout = np.zeros(0)   # Worst-case cents per butterfly
+
+    def load_markets(self, markets):
+        """Builds the ladders from raw Kalshi markets (decoded structs or dicts)."""
+        above, between = {}, {}
+        for m in markets:
+            kind, event = m.get("strike_type"), m.get("event_ticker")
+            if not event:
+                continue
+            if kind in ABOVE_TYPES and m.get("floor_strike") is not None:
+                above.setdefault(event, []).append(m)
+            elif kind == "between" and m.get("floor_strike") is not None and m.get("cap_strike") is not None:
+                between.setdefault(event, []).append(m)
+
+        # At equal strikes the inclusive market pays in more states, so it sorts as the lower one
+        ladders = {e: sorted(ms, key=lambda m: (m.get("floor_strike"), m.get("strike_type") != "greater_or_equal"))
+                   for e, ms in above.items() if len(ms) >= 2}
+        width = max((len(ms) for ms in ladders.values()), default=0)
+        shape = (len(ladders), width)
+        self.strike = np.full(shape, np.nan)
+        self.bid = np.full(shape, -np.inf)        # Padding never wins a comparison
+        self.ask = np.full(shape, np.inf)
+        self.bid_size = np.full(shape, np.nan)
+        self.ask_size = np.full(shape, np.nan)
+        self.inclusive = np.zeros(shape, dtype=bool)
+        self.events, self.tickers, self.cell = [], [], {}
+
+        for row, (event, ms) in enumerate(ladders.items()):
+            self.events.append(event)
+            self.tickers.append([m.get("ticker") for m in ms])
+            for col, m in enumerate(ms):
+                self.strike[row, col] = m.get("floor_strike")
+                self.inclusive[row, col] = m.get("strike_type") == "greater_or_equal"
+                self._quote(row, col, m.get("yes_bid"), m.get("yes_ask"))
+                self.cell[m.get("ticker")] = (row, col)
+
+        self.ranges, r_quotes, r_payouts = [], [], []
+        for row, event in enumerate(self.events):
+            strikes = self.strike[row]
+            for m in between.get(event, []):
+                lo, hi = m.get("floor_strike"), m.get("cap_strike")
+                tol = 0.01 * (hi - lo)   # "between 74 and 75.99" pairs with "above 74" / "above 75.99"
+                i = np.flatnonzero(np.abs(strikes - lo) <= tol)
+                j = np.flatnonzero(np.abs(strikes - hi) <= tol)
+                if len(i) and len(j) and i[0] < j[0]:
+                    self.cell[m.get("ticker")] = ("range", len(self.ranges))
+                    self.ranges.append((m.get("ticker"), row, int(i[0]), int(j[0])))
+                    r_quotes.append((m.get("yes_bid"), m.get("yes_ask")))
+                    r_payouts.append(self._butterfly_payouts(lo, hi, row, int(i[0]), int(j[0])))
+        n = len(self.ranges)
+        self.r_row = np.array([r[1] for r in self.ranges], dtype=int)
+        self.r_lo = np.array([r[2] for r in self.ranges], dtype=int)
+        self.r_hi = np.array([r[3] for r in self.ranges], dtype=int)
+        self.r_bid, self.r_ask = np.full(n, -np.inf), np.full(n, np.inf)
+        self.r_bid_size, self.r_ask_size = np.full(n, np.nan), np.full(n, np.nan)
+        for k, (b, a) in enumerate(r_quotes):
+            self._quote_range(k, b, a)
+        self.r_cheap_payout = np.array([p[0] for p in r_payouts], dtype=float)
+        self.r_rich_payout = np.array([p[1] for p in r_payouts], dtype=float)
+        return len(self.events), len(self.ranges)
+
+    def _butterfly_payouts(self, lo, hi, row, i, j):
+        """Worst-case (cheap, rich) payout in cents over every settlement value, boundaries included."""
+        k1, inc1 = float(self.strike[row, i]), bool(self.inclusive[row, i])
+        k2, inc2 = float(self.strike[row, j]), bool(self.inclusive[row, j])
+        # Payouts are constant between breakpoints: probe each one and both of its sides
+        points = sorted({lo, hi, k1, k2})
+        eps = 1e-6 * max(1.0, abs(points[-1]))
+        probes = [points[0] - 1.0, points[-1] + 1.0] + [p + d for p in points for d in (-eps, 0.0, eps)]
+        cheap = rich = math.inf
+        for s in probes:
+            r, a1, a2 = _between(lo, hi, s), _above(k1, inc1, s), _above(k2, inc2, s)
+            cheap = min(cheap, r + a2 + (1 - a1))
+            rich = min(rich, (1 - r) + a1 + (1 - a2))
+        return 100 * cheap, 100 * rich
+
+    @staticmethod
+    def _sides(bid, ask):
+        # Kalshi reports a missing side as 0 (bid) / 100 (ask)
+        return (bid if bid else -np.inf), (ask if ask and ask < 100 else np.inf)
+
+    def _quote(self, row, col, bid, ask, bid_size=np.nan, ask_size=np.nan):
+        self.bid[row, col], self.ask[row, col] = self._sides(bid, ask)
+        self.bid_size[row, col], self.ask_size[row, col] = bid_size, ask_size
+
+    def _quote_range(self, k, bid, ask, bid_size=np.nan, ask_size=np.nan):
+        self.r_bid[k], self.r_ask[k] = self._sides(bid, ask)
+        self.r_bid_size[k], self.r_ask_size[k] = bid_size, ask_size
+
+    def _fee(self, cents):
+        p = np.clip(cents / 100.0, 0.0, 1.0)
+        return self.FEE_RATE * p * (1.0 - p) * 100   # In cents per contract
+
+    def _size(self, *sizes):
+        """(contracts, confirmed): the thinnest leg's depth, or the probe size while any leg is unconfirmed."""
+        if any(math.isnan(s) for s in sizes):
+            return self.UNCONFIRMED_SIZE, False
+        return int(min(min(sizes), self.MAX_CONTRACTS)), True
+
+    def _trade(self, kind, event, legs, edge_cents, payout_cents, sized):
+        size, confirmed = sized
+        cost = sum(l["price"] for l in legs)
+        return {
+            "type": kind,
+            "event_ticker": event,
+            "count": size,
+            "legs": [dict(l, count=size) for l in legs],
+            "cost_cents": cost,
+            "payout_cents": payout_cents,
+            "edge_cents": round(float(edge_cents), 2),
+            "profit_usd": round(float(edge_cents) * size / 100, 2),
+            "confirmed": confirmed,
+        }
+
+    def check(self, rows=None):
+        """Monotonicity + butterfly violations for the given ladder rows (all when None)."""
+        rows = np.arange(len(self.events)) if rows is None else np.asarray(rows, dtype=int)
+        trades = []
+        if not len(rows) or not self.bid.size:
+            return trades
+
+        bid, ask = self.bid[rows], self.ask[rows]
+        # Cheapest YES ask at any lower strike, and where it sits
+        prefix_ask = np.minimum.accumulate(ask, axis=1)
+        cols = np.arange(ask.shape[1])
+        prefix_at = np.maximum.accumulate(np.where(ask == prefix_ask, cols, 0), axis=1)
+        lower_ask = np.full_like(ask, np.inf)
+        lower_ask[:, 1:] = prefix_ask[:, :-1]
+        lower_at = np.zeros_like(prefix_at)
+        lower_at[:, 1:] = prefix_at[:, :-1]
+        # Buy YES at the lower strike's ask, buy NO at (100 - higher strike's bid): pays 100 or 200
+        edge = bid - lower_ask - self._fee(lower_ask) - self._fee(bid)
+        for r, j in zip(*np.nonzero(edge > self.MIN_EDGE_CENTS)):
+            row, i = rows[r], lower_at[r, j]
+            legs = [{"ticker": self.tickers[row][i], "side": "yes", "price": float(self.ask[row, i])},
+                    {"ticker": self.tickers[row][j], "side": "no", "price": 100 - float(self.bid[row, j])}]
+            size = self._size(self.ask_size[row, i], self.bid_size[row, j])
+            trades.append(self._trade("monotonic", self.events[row], legs, edge[r, j], 100, size))
+
+        sel = np.flatnonzero(np.isin(self.r_row, rows))
+        if len(sel):
+            r_row, lo, hi = self.r_row[sel], self.r_lo[sel], self.r_hi[sel]
+            a_lo, b_lo = self.ask[r_row, lo], self.bid[r_row, lo]
+            a_hi, b_hi = self.ask[r_row, hi], self.bid[r_row, hi]
+            r_a, r_b = self.r_ask[sel], self.r_bid[sel]
+            cheap_payout, rich_payout = self.r_cheap_payout[sel], self.r_rich_payout[sel]
+            # Range cheap: buy range YES + above(K2) YES, buy above(K1) NO -> nominally pays 100
+            cheap = (cheap_payout - 100 + b_lo - r_a - a_hi) - self._fee(r_a) - self._fee(a_hi) - self._fee(b_lo)
+            # Range rich: buy range NO + above(K1) YES + above(K2) NO -> nominally pays 200
+            rich = (rich_payout - 200 + r_b + b_hi - a_lo) - self._fee(r_b) - self._fee(a_lo) - self._fee(b_hi)
+            for n, k in enumerate(sel):
+                ticker, row, i, j = self.ranges[k]
+                t_lo, t_hi = self.tickers[row][i], self.tickers[row][j]
+                if cheap[n] > self.MIN_EDGE_CENTS:
+                    legs = [{"ticker": ticker, "side": "yes", "price": float(r_a[n])},
+                            {"ticker": t_hi, "side": "yes", "price": float(a_hi[n])},
+                            {"ticker": t_lo, "side": "no", "price": 100 - float(b_lo[n])}]
+                    size = self._size(self.r_ask_size[k], self.ask_size[row, j], self.bid_size[row, i])
+                    trades.append(self._trade("butterfly", self.events[row], legs, cheap[n], int(cheap_payout[n]), size))
+                if rich[n] > self.MIN_EDGE_CENTS:
+                    legs = [{"ticker": ticker, "side": "no", "price": 100 - float(r_b[n])},
+                            {"ticker": t_lo, "side": "yes", "price": float(a_lo[n])},
+                            {"ticker": t_hi, "side": "no", "price": 100 - float(b_hi[n])}]
+                    size = self._size(self.r_bid_size[k], self.ask_size[row, i], self.bid_size[row, j])
+                    trades.append(self._trade("butterfly", self.events[row], legs, rich[n], int(rich_payout[n]), size))
+
+        trades.sort(key=lambda t: t["profit_usd"], reverse=True)
+        return trades
+
+    def on_orderbook(self, ticker, orderbook):
+        """
+        Applies one Kalshi orderbook ({"yes": [[price, qty]], "no": [[price, qty]]}, bids
+        only) and re-checks just the ladder it belongs to.
+        """
+        where = self.cell.get(ticker)
+        if where is None or orderbook is None:
+            return []
+        yes = max(orderbook.get("yes") or [], key=lambda l: l[0], default=None)
+        no = max(orderbook.get("no") or [], key=lambda l: l[0], default=None)
+        bid, bid_size = (yes[0], float(yes[1])) if yes else (0, np.nan)
+        # A NO bid at p is a YES offer at 100 - p
+        ask, ask_size = (100 - no[0], float(no[1])) if no else (100, np.nan)
+        if where[0] == "range":
+            self._quote_range(where[1], bid, ask, bid_size, ask_size)
+            row = self.ranges[where[1]][1]
+        else:
+            row, col = where
+            self._quote(row, col, bid, ask, bid_size, ask_size)
+        return self.check([row])
+
+    def scan(self):
+        trades = self.check()
+        for t in trades:
+            logger.info(f"[ARBITRAGE] Kalshi {t['type']} violation on {t['event_ticker']}: "
+                        f"{t['count']} x {' + '.join(l['side'].upper() + ' ' + l['ticker'] for l in t['legs'])} "
+                        f"edge {t['edge_cents']:.1f}c")
+        return trades
+
+if __name__ == "__main__":
+    # Full-pass cost over a sweep's worth of ladders, then book-update-to-detection latency.
+    import time
+    import random
+
+    rnd = random.Random(11)
+    markets = []
+    for e in range(400):
+        strikes = [100 + 2 * s for s in range(40)]
+        fair = np.linspace(97, 3, len(strikes))
+        for s, k in enumerate(strikes):
+            markets.append({"ticker": f"EV{e}-T{k}", "event_ticker": f"EV{e}", "strike_type": "greater",
+                            "floor_strike": k, "yes_bid": int(fair[s]) - 1, "yes_ask": int(fair[s]) + 1})
+        for s in range(len(strikes) - 1):
+            mid = int(fair[s] - fair[s + 1])
+            markets.append({"ticker": f"EV{e}-B{strikes[s]}", "event_ticker": f"EV{e}", "strike_type": "between",
+                            "floor_strike": strikes[s], "cap_strike": strikes[s + 1] - 0.01,
+                            "yes_bid": max(mid - 1, 1), "yes_ask": mid + 2})
+
+    scanner = StrikeLadderScanner()
+    print("ladders, ranges:", scanner.load_markets(markets))
+    start = time.perf_counter()
+    found = scanner.check()
+    print(f"full pass over {len(markets)} markets: {(time.perf_counter() - start) * 1000:.1f} ms, {len(found)} violation(s)")
+
+    # A stale quote: the 120 strike bid jumps above the 110 ask
+    samples = []
+    for _ in range(200):
+        start = time.perf_counter()
+        found = scanner.on_orderbook("EV7-T120", {"yes": [[90, 250]], "no": [[5, 100]]})
+        samples.append(time.perf_counter() - start)
+        scanner.on_orderbook("EV7-T120", {"yes": [[75, 250]], "no": [[20, 100]]})
+    samples.sort()
+    print(f"book update -> detection: p50 {samples[100] * 1e3:.3f} ms, p99 {samples[198] * 1e3:.3f} ms; "
+          f"{len(found)} violation(s), best {found[0]['type']} {found[0]['edge_cents']}c x {found[0]['count']}")
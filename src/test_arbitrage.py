@@ -0,0 +1,66 @@
+import os
+import json
+import tempfile
+import unittest
+from src.arbitrage import ArbitrageScanner
+from src.compute import ComputeExecutor
+
+class StubMarketData:
+    def __init__(self, poly, kalshi, compute=None):
+        self.rows = {"polymarket": poly, "kalshi": kalshi}
+        self.compute = compute
+
+    async def anormalized(self, platform):
+        return self.rows[platform]
+
+def poly(pid, title, price, token="tok"):
+    return {"id": pid, "title": title, "price": price, "outcome_index": 0, "token_id": token}
+
+def kalshi(ticker, title, price):
+    return {"id": ticker, "title": title, "price": price}
+
+class TestCrossVenueScan(unittest.IsolatedAsyncioTestCase):
+    POLY = [poly("p1", "Will the Fed cut rates in March?", 60), poly("p2", "Unrelated market", 50)]
+    KALSHI = [kalshi("K1", "will the fed cut rates in march 2026", 30), kalshi("K2", "Something else", 10)]
+
+    async def test_matching_runs_in_the_compute_pool(self):
+        compute = ComputeExecutor(max_workers=1)
+        try:
+            scanner = ArbitrageScanner(StubMarketData(self.POLY, self.KALSHI, compute))
+            scanner.verified_pairs = {"p1|K1"}
+            arb = await scanner.scan_overlapping_strikes()
+        finally:
+            compute.shutdown()
+        self.assertEqual((arb["poly_leg"], arb["kalshi_leg"]), ("p1", "K1"))
+        self.assertEqual(compute.completed, 1)
+        self.assertEqual(list(scanner.pairs), ["p1|K1"])
+
+    async def test_inline_matching_without_a_pool(self):
+        scanner = ArbitrageScanner(StubMarketData(self.POLY, self.KALSHI))
+        scanner.verified_pairs = {"p1|K1"}
+        arb = await scanner.scan_overlapping_strikes()
+        # Kalshi YES at 0.30 + Polymarket DOWN at 0.40
+        self.assertAlmostEqual(sum(l["price"] for l in arb["legs"]), 0.70)
+
+    async def test_unverified_title_match_is_not_arbitrage(self):
+        scanner = ArbitrageScanner(StubMarketData(self.POLY, self.KALSHI))
+        self.assertIsNone(await scanner.scan_overlapping_strikes())
+        # Still remembered, for an operator to check and for the next sweep's fast path
+        self.assertEqual(list(scanner.pairs), ["p1|K1"])
+        self.assertIsNone(await scanner.scan_overlapping_strikes())
+
+    def test_load_verified(self):
+        scanner = ArbitrageScanner(StubMarketData([], []))
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "verified_pairs.json")
+            self.assertEqual(scanner.load_verified(path), 0)
+            with open(path, "w") as f:
+                json.dump(["p1|K1", "p3|K3"], f)
+            self.assertEqual(scanner.load_verified(path), 2)
+            self.assertIn("p3|K3", scanner.verified_pairs)
+            with open(path, "w") as f:
+                f.write("not json")
+            self.assertEqual(scanner.load_verified(path), 0)
+
+if __name__ == "__main__":
+    unittest.main()
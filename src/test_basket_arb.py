@@ -0,0 +1,95 @@
+import json
+import unittest
+from src.basket_arb import BasketArbEngine
+from src.outcomes import OutcomeTable
+
+def member(mid, yes, label="", tokens=None, **fields):
+    tokens = tokens if tokens is not None else [f"y{mid}", f"n{mid}"]
+    return {"id": mid, "question": f"Will {mid} win?", "groupItemTitle": label or mid,
+            "outcomes": '["Yes", "No"]', "outcomePrices": json.dumps([str(yes), str(round(1 - yes, 4))]),
+            "clobTokenIds": json.dumps(tokens), **fields}
+
+def event(eid, markets, **fields):
+    return {"id": eid, "title": f"Event {eid}", "negRisk": True, "markets": markets, **fields}
+
+def trio(**override):
+    markets = [member("a", 0.5), member("b", 0.3), member("c", 0.2)]
+    for k, fields in override.items():
+        markets = [dict(m, **fields) if m["id"] == k else m for m in markets]
+    return markets
+
+class TestLoadUniverse(unittest.TestCase):
+    def load(self, *events):
+        engine = BasketArbEngine()
+        engine.load_universe(OutcomeTable.from_events(events))
+        return engine
+
+    def test_complete_event_registers_both_baskets(self):
+        engine = self.load(event("E", trio()))
+        self.assertEqual(engine.events["E"], {"title": "Event E", "markets": ["a", "b", "c"],
+                                              "yes": ["ya", "yb", "yc"], "no": ["na", "nb", "nc"]})
+        self.assertEqual(engine.token_event["nb"], "E")
+        self.assertEqual(engine.dirty, {"E"})
+
+    def test_open_ended_events_are_rejected(self):
+        engine = self.load(
+            event("augmented", trio(), negRiskAugmented=True),
+            event("other", trio() + [member("d", 0.0, label="Other")]),
+            event("placeholder", trio() + [member("e", 0.0, label="Person C")]),
+            event("plain", trio(), negRisk=False),
+        )
+        self.assertEqual(engine.events, {})
+
+    def test_incomplete_or_decided_events_are_rejected(self):
+        engine = self.load(
+            event("decided", trio(a={"closed": True, "outcomePrices": '["1", "0"]'})),
+            event("inactive", trio(b={"active": False})),
+            event("no-token", trio(c={"clobTokenIds": '["yc"]'})),
+            event("missing", [member("a", 0.5), member("b", 0.3)]),   # YES prices sum to 0.8
+        )
+        self.assertEqual(engine.events, {})
+
+    def test_member_resolved_no_is_dropped(self):
+        engine = self.load(event("E", trio() + [member("d", 0.0, closed=True)]))
+        self.assertEqual(engine.events["E"]["markets"], ["a", "b", "c"])
+
+    def test_unchanged_reload_is_not_dirty(self):
+        engine = self.load(event("E", trio()))
+        engine.dirty.clear()
+        self.assertEqual(engine.load_universe(OutcomeTable.from_events([event("E", trio())])), 1)
+        self.assertEqual(engine.dirty, set())
+
+class TestWalk(unittest.TestCase):
+    def engine(self, max_basket_usd=500.0, fee_rate_bps=0.0, second_a=0.45):
+        engine = BasketArbEngine(fee_rate_bps=fee_rate_bps, max_basket_usd=max_basket_usd)
+        engine.events = {"E": {"title": "E", "markets": ["a", "b"], "yes": ["ya", "yb"], "no": ["na", "nb"]}}
+        engine.token_event = {t: "E" for t in ("ya", "yb", "na", "nb")}
+        engine.on_book("ya", [(0.40, 100), (second_a, 100)])
+        engine.on_book("yb", [{"price": "0.50", "size": "50"}, {"price": "0.52", "size": "200"}])
+        return engine
+
+    def test_walks_every_profitable_segment_down_to_the_shallowest_leg(self):
+        trade = self.engine()._walk("E", "YES", 1.0)
+        # 50 @ 0.90, 50 @ 0.92, 100 @ 0.97; leg a runs out at 200
+        self.assertEqual((trade["size"], trade["cost"], trade["profit"]), (200, 188.0, 12.0))
+        self.assertEqual([l["limit_price"] for l in trade["legs"]], [0.45, 0.52])
+
+    def test_stops_at_the_first_unprofitable_segment(self):
+        trade = self.engine(second_a=0.48)._walk("E", "YES", 1.0)
+        self.assertEqual((trade["size"], trade["cost"]), (100, 91.0))
+        self.assertEqual([l["limit_price"] for l in trade["legs"]], [0.40, 0.52])
+
+    def test_cost_cap_cuts_inside_a_segment_on_a_cent_grid(self):
+        trade = self.engine(max_basket_usd=60.0)._walk("E", "YES", 1.0)
+        self.assertEqual(trade["size"], 66.30)   # 45 for the first 50, then 15 / 0.92 more
+        self.assertLessEqual(trade["cost"], 60.0)
+        self.assertEqual([l["size"] for l in trade["legs"]], [66.30, 66.30])
+
+    def test_fees_count_against_the_edge(self):
+        # 2% of min(p, 1 - p) per leg lifts the first segment to 0.918
+        trade = self.engine(fee_rate_bps=200)._walk("E", "YES", 1.0)
+        self.assertEqual((trade["size"], trade["fees"]), (200, round(0.018 * 50 + 0.0176 * 50 + 0.0186 * 100, 4)))
+        self.assertIsNone(self.engine()._walk("E", "YES", 0.90))
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,59 @@
+import os
+import tempfile
+import unittest
+from unittest import mock
+from datetime import datetime, timezone
+from src.checkpoint import CheckpointStore
+
+class CheckpointStoreTest(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.path = os.path.join(self.tmp.name, "checkpoint.db")
+        self.store = CheckpointStore(self.path)
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def at(self, t):
+        return mock.patch("src.checkpoint.time.time", return_value=t)
+
+    def test_datetimes_round_trip_nested_and_across_reopen(self):
+        close = datetime(2026, 3, 1, 17, 30, tzinfo=timezone.utc)
+        sweep = {"candidates": [{"id": "A", "close_date": close, "price": 42.0}, {"id": "B", "close_date": None}],
+                 "next": 1}
+        self.store.put("pipeline", "sweep", sweep)
+        self.assertEqual(CheckpointStore(self.path).get("pipeline", "sweep"), sweep)
+        self.assertEqual(CheckpointStore(self.path).get("pipeline", "sweep")["candidates"][0]["close_date"].tzinfo,
+                         timezone.utc)
+        # A plain dict that happens to carry the marker key among others stays a dict
+        self.store.put("llm", "k", {"__dt__": "x", "other": 1})
+        self.assertEqual(self.store.get("llm", "k"), {"__dt__": "x", "other": 1})
+
+    def test_max_age_hides_stale_values_without_deleting_them(self):
+        with self.at(1000.0):
+            self.store.put("markets", "snapshot", [1, 2])
+            self.store.put_many("llm", {"a": 1, "b": 2})
+        with self.at(1000.0 + 900):
+            self.assertEqual(self.store.get("markets", "snapshot", max_age=900), [1, 2])
+            self.store.put("llm", "b", 3)
+        with self.at(1000.0 + 901):
+            self.assertIsNone(self.store.get("markets", "snapshot", max_age=900))
+            self.assertEqual(self.store.get("markets", "snapshot", max_age=900, default=[]), [])
+            self.assertEqual(self.store.get("markets", "snapshot"), [1, 2])
+            self.assertEqual(self.store.items("llm", max_age=60), {"b": 3})
+            self.assertEqual(self.store.items("llm"), {"a": 1, "b": 3})
+
+    def test_prune_and_delete_stay_in_their_namespace(self):
+        with self.at(1000.0):
+            self.store.put("llm", "old", 1)
+            self.store.put("portfolio", "state", {"bankroll": 1.0})
+        with self.at(5000.0):
+            self.store.put("llm", "new", 2)
+            self.store.prune("llm", 3600)
+        self.assertEqual(self.store.items("llm"), {"new": 2})
+        self.assertEqual(self.store.get("portfolio", "state"), {"bankroll": 1.0})
+        self.store.delete("llm", "new")
+        self.assertEqual(self.store.items("llm"), {})
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,124 @@
+import os
+import time
+import signal
+import socket
+import asyncio
+import tempfile
+import unittest
+import urllib.request
+from src.kill_switch import KillSwitch
+
+# Upper bound on trigger -> flag -> in-flight task cancelled, for every source
+MAX_TIME_TO_HALT = 0.5
+
+class TestKillSwitch(unittest.IsolatedAsyncioTestCase):
+    async def asyncSetUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.stop_path = os.path.join(self.tmp.name, "STOP")
+        self.switch = KillSwitch(self.stop_path, http_port=0)
+        self.switch.start()
+
+    async def asyncTearDown(self):
+        self.switch.stop()
+        self.tmp.cleanup()
+
+    async def _time_to_halt(self, fire):
+        """Fires a trigger while a long 'LLM call' is in flight; returns seconds until it is cancelled."""
+        inflight = self.switch.track(asyncio.sleep(60))
+        await asyncio.sleep(0)
+        start = time.perf_counter()
+        await asyncio.to_thread(fire)
+        with self.assertRaises(asyncio.CancelledError):
+            await asyncio.wait_for(inflight, timeout=5.0)
+        elapsed = time.perf_counter() - start
+        self.assertTrue(self.switch.engaged)
+        return elapsed
+
+    async def test_stop_file(self):
+        elapsed = await self._time_to_halt(lambda: open(self.stop_path, "w").close())
+        self.assertLess(elapsed, MAX_TIME_TO_HALT)
+        self.assertIn("STOP file", self.switch.reason)
+
+    async def test_signal(self):
+        elapsed = await self._time_to_halt(lambda: os.kill(os.getpid(), signal.SIGUSR1))
+        self.assertLess(elapsed, MAX_TIME_TO_HALT)
+        self.assertIn("SIGUSR1", self.switch.reason)
+
+    async def test_http(self):
+        url = f"http://127.0.0.1:{self.switch.http_port}/halt"
+        elapsed = await self._time_to_halt(lambda: urllib.request.urlopen(urllib.request.Request(url, method="POST")).read())
+        self.assertLess(elapsed, MAX_TIME_TO_HALT)
+
+    async def test_sleep_interrupted_and_callbacks_run(self):
+        cancelled = []
+
+        async def mass_cancel():
+            cancelled.append(True)
+
+        self.switch.on_halt(mass_cancel)
+        asyncio.get_running_loop().call_later(0.05, self.switch.trigger, "test")
+        start = time.perf_counter()
+        halted = await self.switch.sleep(900)
+        self.assertTrue(halted)
+        self.assertLess(time.perf_counter() - start, MAX_TIME_TO_HALT)
+        await asyncio.sleep(0)
+        self.assertEqual(cancelled, [True])
+
+    async def test_drain_waits_for_mass_cancel(self):
+        cancelled = []
+
+        async def mass_cancel():
+            await asyncio.sleep(0.05)
+            cancelled.append(True)
+
+        self.switch.on_halt(mass_cancel)
+        self.switch.trigger("test")
+        await asyncio.sleep(0)
+        self.assertTrue(await self.switch.drain(timeout=1.0))
+        self.assertEqual(cancelled, [True])
+
+    async def test_port_in_use_falls_back_to_file_and_signal(self):
+        taken = socket.socket()
+        taken.bind(("127.0.0.1", 0))
+        taken.listen()
+        other = KillSwitch(os.path.join(self.tmp.name, "STOP2"), http_port=taken.getsockname()[1])
+        try:
+            other.start()
+            self.assertIsNone(other.http_port)
+            elapsed = time.perf_counter()
+            open(other.stop_path, "w").close()
+            while not other.engaged and time.perf_counter() - elapsed < MAX_TIME_TO_HALT:
+                await asyncio.sleep(0.01)
+            self.assertTrue(other.engaged)
+        finally:
+            other.stop()
+            taken.close()
+
+    async def test_tripped_before_start_still_runs_the_halt_path(self):
+        cancelled = []
+
+        async def mass_cancel():
+            cancelled.append(True)
+
+        # STOP file left over from before boot, and a switch thrown before it had a loop
+        open(os.path.join(self.tmp.name, "STOP3"), "w").close()
+        at_boot = KillSwitch(os.path.join(self.tmp.name, "STOP3"))
+        early = KillSwitch(os.path.join(self.tmp.name, "STOP4"))
+        early.trigger("test")
+        for switch in (at_boot, early):
+            switch.on_halt(mass_cancel)
+            switch.start()
+            await asyncio.sleep(0)
+            self.assertTrue(await switch.drain(timeout=1.0))
+            self.assertTrue(await switch.sleep(0))
+            switch.stop()
+        self.assertEqual(cancelled, [True, True])
+
+    async def test_track_after_halt_cancels_immediately(self):
+        self.switch.trigger("test")
+        task = self.switch.track(asyncio.sleep(60))
+        with self.assertRaises(asyncio.CancelledError):
+            await task
+
+if __name__ == '__main__':
+    unittest.main()
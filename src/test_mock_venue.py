@@ -0,0 +1,130 @@
+import os
+import asyncio
+import threading
+import unittest
+from unittest import mock
+from src.mock_venue import MockConfig, MockVenueServer, generate_kalshi_key, ws_connect, ws_send, ws_read, _loads
+from src.api.filters import MarketFilter
+
+class MockVenueTest(unittest.TestCase):
+    """Real clients against the mock served from a background event loop."""
+    @classmethod
+    def setUpClass(cls):
+        key, pem = generate_kalshi_key()
+        cls.loop = asyncio.new_event_loop()
+        threading.Thread(target=cls.loop.run_forever, daemon=True).start()
+        config = MockConfig(kalshi_markets=250, poly_events=40, updates_per_sec=2000)
+        cls.server = asyncio.run_coroutine_threadsafe(
+            MockVenueServer(config, public_key=key.public_key()).start(), cls.loop).result()
+        cls.env = {**cls.server.client_env(), "KALSHI_API_KEY_ID": "mock", "KALSHI_PRIVATE_KEY_RAW": pem.decode()}
+
+    @classmethod
+    def tearDownClass(cls):
+        asyncio.run_coroutine_threadsafe(cls.server.stop(), cls.loop).result()
+        cls.loop.call_soon_threadsafe(cls.loop.stop)
+
+    def clients(self):
+        with mock.patch.dict(os.environ, self.env):
+            from src.api.kalshi import KalshiClient
+            from src.api.polymarket import PolymarketClient
+            return KalshiClient(), PolymarketClient()
+
+    def test_listings_page_and_filter(self):
+        kalshi, poly = self.clients()
+        markets = kalshi.get_markets(market_filter=MarketFilter(page_size=100, max_pages=10))
+        self.assertEqual(len(markets), 250)
+        ladder = kalshi.get_markets(market_filter=MarketFilter(event_ticker="KXMOCK-00003", max_pages=1))
+        self.assertEqual(len(ladder), 8)
+        events = poly.get_markets(market_filter=MarketFilter(page_size=25, max_pages=5))
+        self.assertEqual(len(events), 40)
+        token = _loads(events[0].markets[0].clobTokenIds)[0]
+        self.assertTrue(poly.get_book(token)["bids"])
+
+    def test_signed_order_lifecycle(self):
+        kalshi, _ = self.clients()
+        ticker = "KXMOCK-00001-T1000"
+        book = kalshi.get_orderbook(ticker)
+        best_no_bid = book["no"][-1][0]
+        # Lift the best YES offer, then rest a bid far below the market and cancel it
+        order = kalshi.place_order(ticker, "yes", "buy", 1, 100 - best_no_bid)
+        self.assertEqual(order["status"], "executed")
+        resting = kalshi.place_orders([{"ticker": ticker, "side": "yes", "action": "buy", "count": 5, "price_cents": 1}])
+        self.assertEqual(resting[0][0]["status"], "resting")
+        self.assertEqual(kalshi.cancel_all_orders(ticker=ticker), 1)
+        self.assertEqual(kalshi.get_order(resting[0][0]["order_id"])["status"], "canceled")
+
+    def test_timed_out_orders_are_reconciled(self):
+        import requests
+        kalshi, _ = self.clients()
+        ticker = "KXMOCK-00002-T1000"
+        send = requests.request
+
+        def lost_ack(method, url, **kwargs):
+            # The venue takes the order, but the response never makes it back
+            resp = send(method, url, **kwargs)
+            if method == "POST":
+                raise requests.exceptions.ReadTimeout("read timed out")
+            return resp
+
+        with mock.patch.object(requests, "request", lost_ack):
+            single = kalshi.place_order(ticker, "yes", "buy", 2, 1, client_order_id="lost-single")
+            batch = kalshi.place_orders([
+                {"ticker": ticker, "side": "yes", "action": "buy", "count": 3, "price_cents": 1, "client_order_id": "lost-a"},
+                {"ticker": ticker, "side": "yes", "action": "buy", "count": 4, "price_cents": 1},
+            ])
+        self.assertEqual((single["client_order_id"], single["status"]), ("lost-single", "resting"))
+        self.assertEqual((batch[0][0]["client_order_id"], batch[0][1]), ("lost-a", None))
+        # Without a client_order_id there is nothing to look up: it stays an error
+        self.assertEqual(batch[1][0], {})
+        self.assertIn("timed out", batch[1][1])
+        kalshi.cancel_all_orders(ticker=ticker)
+
+    def test_market_maker_quotes_both_sides(self):
+        from src.execution import ExecutionEngine, KalshiVenue, MarketMaker, CANCELLED
+        from skills.predict_market_bot.scripts.validate_risk import RiskValidator
+        kalshi, _ = self.clients()
+        ticker = "KXMOCK-00002-T1000"
+
+        async def run():
+            engine = ExecutionEngine([KalshiVenue(kalshi)])
+            mm = MarketMaker(engine, RiskValidator(), 1000.0, half_spread=0.03, quote_size=2)
+            state = await mm.quote("kalshi", ticker)
+            await asyncio.sleep(0.5)
+            orders = [p.order for p in state["pegs"].values()]
+            bid, offer = mm.quotes(state)[:2]
+            await mm.stop()
+            return orders, bid, offer, state
+
+        orders, bid, offer, state = asyncio.run(run())
+        self.assertLess(bid, state["fair"])
+        self.assertGreater(offer, state["fair"])
+        # Both sides rested (or already traded) on the exchange, and stop pulled what was left
+        self.assertEqual(len(orders) + (state["yes"] > 0) + (state["no"] > 0), 2)
+        for order in orders:
+            self.assertEqual(kalshi.get_order(order.venue_order_id)["status"], "canceled")
+
+    def test_bad_signature_rejected(self):
+        kalshi, _ = self.clients()
+        other, _ = generate_kalshi_key()
+        kalshi.private_key = other
+        with self.assertRaises(Exception) as ctx:
+            kalshi.get_orders()
+        self.assertIn("401", str(ctx.exception))
+
+    def test_websocket_book_and_updates(self):
+        token = self.server.universe.token_list[0]
+
+        async def listen():
+            reader, writer = await ws_connect(self.server.host, self.server.port)
+            ws_send(writer, {"type": "market", "assets_ids": [token]})
+            kinds = set()
+            while not {"book", "price_change"} <= kinds:
+                _, payload = await asyncio.wait_for(ws_read(reader), 5)
+                kinds.update(e["event_type"] for e in _loads(payload))
+            writer.close()
+            return kinds
+
+        self.assertLessEqual({"book", "price_change"}, asyncio.run(listen()))
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,77 @@
+import asyncio
+import unittest
+from datetime import date
+from src.orchestrator import TradingBotOrchestrator
+from src.execution import ExecutionEngine, LocalVenue, MarketMaker
+from src.sim import SimVenue, MatchingEngine
+from skills.predict_market_bot.scripts.validate_risk import RiskValidator
+
+class TradeLog:
+    def __init__(self):
+        self.trades = []
+
+    def log_trade(self, **trade):
+        self.trades.append(trade)
+
+def bare_orchestrator(bankroll=1000.0):
+    """The portfolio bookkeeping only: no scanners, clients, checkpoint or kill switch."""
+    bot = TradingBotOrchestrator.__new__(TradingBotOrchestrator)
+    bot.bankroll = bot.peak_bankroll = bankroll
+    bot.daily_pnl = bot.mm_pnl = bot.daily_loss = bot.current_drawdown = 0.0
+    bot.open_positions, bot.concurrent_positions = [], 0
+    bot.pnl_day = date.today().isoformat()
+    bot.risk_service, bot.recorder, bot.market_maker = None, None, None
+    bot.risk_manager = RiskValidator()
+    bot.trade_logger = TradeLog()
+    return bot
+
+class TestLocalLimits(unittest.TestCase):
+    def test_update_limits_survives_an_empty_bankroll(self):
+        bot = bare_orchestrator(bankroll=0.0)
+        bot.daily_pnl = -10.0
+        bot._update_limits()
+        self.assertEqual((bot.daily_loss, bot.current_drawdown), (1.0, 0.0))
+        bot.daily_pnl = 0.0
+        bot._update_limits()
+        self.assertEqual(bot.daily_loss, 0.0)
+
+class TestMarketMakingSettlement(unittest.IsolatedAsyncioTestCase):
+    async def asyncSetUp(self):
+        self.matcher = MatchingEngine("kalshi")
+        self.matcher.on_book("M", [(0.40, 100)], [(0.50, 100)], 0.0)
+        self.matcher.on_book("N", [(0.40, 100)], [(0.50, 100)], 0.0)
+        self.bot = bare_orchestrator()
+        self.bot.market_maker = MarketMaker(ExecutionEngine([SimVenue("kalshi", matcher=self.matcher)]), RiskValidator(),
+                                            1000.0, half_spread=0.02, quote_size=12, refresh=0.02)
+        # Resolutions come from the orchestrator's own venues
+        self.results = LocalVenue(name="kalshi")
+        self.bot.execution = ExecutionEngine([self.results])
+
+    async def asyncTearDown(self):
+        await self.bot.market_maker.stop()
+
+    async def test_resolved_inventory_is_realized_and_dropped(self):
+        mm = self.bot.market_maker
+        await mm.quote("kalshi", "M", fair=0.45)
+        await mm.quote("kalshi", "N", fair=0.45)
+        await asyncio.sleep(0.05)
+        # The NO bid at 0.51 fills: long 12 NO for $6.12, marked at 0.55
+        self.matcher.on_event({"type": "trade", "market": "M", "price": 0.49, "size": 12, "aggressor": "buy", "ts": 1.0})
+        await asyncio.sleep(0.1)
+        await self.bot.mark_market_making()
+        self.assertAlmostEqual(self.bot.mm_pnl, 12 * 0.55 - 6.12)
+
+        self.results.settle("M", "no")
+        await self.bot.settle_positions()
+        self.assertEqual(list(mm.markets), [("kalshi", "N")])
+        self.assertEqual(mm.positions(), [])
+        self.assertAlmostEqual(self.bot.bankroll, 1000.0 + 12 - 6.12)
+        self.assertAlmostEqual(self.bot.mm_pnl, 0.0)
+        # Today's P&L went from the mark to the payout, not mark + payout
+        self.assertAlmostEqual(self.bot.daily_pnl, 12 - 6.12)
+        [trade] = self.bot.trade_logger.trades
+        self.assertEqual((trade["action"], trade["market_id"]), ("SETTLE", "M"))
+        self.assertAlmostEqual(trade["size"], 12.0)
+
+if __name__ == "__main__":
+    unittest.main()
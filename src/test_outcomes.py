@@ -0,0 +1,43 @@
+import json
+import unittest
+from datetime import datetime, timezone
+from src.api.filters import MarketFilter
+from src.outcomes import OutcomeTable
+
+def market(mid, prices, outcomes=None, **fields):
+    outcomes = outcomes or (["Yes", "No"] if len(prices) == 2 else [f"O{k}" for k in range(len(prices))])
+    return {"id": mid, "question": f"Market {mid}?", "outcomes": json.dumps(outcomes),
+            "outcomePrices": json.dumps([str(p) for p in prices]),
+            "clobTokenIds": json.dumps([f"{mid}-{k}" for k in range(len(prices))]),
+            "bestBid": prices[0] - 0.01, "bestAsk": prices[0] + 0.01, "volume": 1000,
+            "endDate": "2026-03-15T00:00:00Z", **fields}
+
+class OutcomeTableTest(unittest.TestCase):
+    def setUp(self):
+        self.table = OutcomeTable.from_events([{"id": "E", "title": "Event", "markets": [
+            market("open", [0.4, 0.6]),
+            market("closed", [0.0, 1.0], closed=True),
+            market("inactive", [0.5, 0.5], active=False),
+            market("multi", [0.2, 0.3, 0.5]),
+        ]}])
+        self.filter = MarketFilter(min_close=datetime(2026, 3, 1, tzinfo=timezone.utc), min_volume=100)
+
+    def test_candidates_skip_closed_inactive_and_binary_complements(self):
+        rows = self.table.rows(self.table.mask(self.filter))
+        self.assertEqual([r["id"] for r in rows], ["open:0", "multi:0", "multi:1", "multi:2"])
+        self.assertEqual((rows[0]["title"], rows[0]["token_id"], rows[0]["price"]), ("Market open?", "open-0", 40.0))
+
+    def test_full_table_keeps_every_outcome_for_baskets(self):
+        self.assertEqual(len(self.table), 9)
+        self.assertEqual(self.table.outcome_count.tolist(), [2, 2, 2, 2, 2, 2, 3, 3, 3])
+        # The complement row still carries the mirrored quote
+        self.assertAlmostEqual(self.table.best_bid[1], 1 - 0.41)
+
+    def test_filter_still_applies(self):
+        self.filter.min_volume = 5000
+        self.assertFalse(self.table.mask(self.filter).any())
+        empty = OutcomeTable.from_events([])
+        self.assertEqual(empty.rows(empty.mask(self.filter)), [])
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,41 @@
+import unittest
+from datetime import datetime, timedelta, timezone
+from src.prioritizer import CandidatePrioritizer
+
+NOW = datetime(2026, 1, 1, tzinfo=timezone.utc)
+
+def market(name, price=50, spread=2, volume=5000, days=7, flag=None):
+    return {"id": name, "price": price, "spread": spread, "volume": volume,
+            "close_date": NOW + timedelta(days=days), "anomaly_flag": flag}
+
+class CandidatePrioritizerTest(unittest.TestCase):
+    def setUp(self):
+        self.prioritizer = CandidatePrioritizer(top_k=3)
+
+    def test_score_follows_edge_liquidity_and_expiry(self):
+        score = lambda m: self.prioritizer.score(m, NOW)
+        base = market("base")
+        self.assertGreater(score(market("wide", spread=10)), score(base))
+        self.assertGreater(score(market("flagged", flag="wide_spread")), score(base))
+        self.assertGreater(score(market("liquid", volume=50000)), score(base))
+        self.assertGreater(score(market("soon", days=1)), score(base))
+        self.assertEqual(score(market("dead", volume=0)), 0.0)
+        # Half-volume, half-time market: edge / p * cap * 0.5 * 0.5 per dollar of LLM spend
+        self.assertAlmostEqual(score(base), (0.02 + 0.5 * 0.02) / 0.5 * 500.0 * 0.25 / 0.05)
+        # At 97c the edge is capped by the 3c the market can still move
+        self.assertAlmostEqual(score(market("sure", price=97, spread=20)), 0.03 / 0.97 * 500.0 * 0.25 / 0.05)
+
+    def test_top_k_cuts_off_at_the_budget_best_first(self):
+        candidates = [market(f"m{i}", spread=i) for i in range(10)]
+        ranked = self.prioritizer.top_k(candidates)
+        self.assertEqual([c["id"] for c in ranked], ["m9", "m8", "m7"])
+        self.assertEqual(ranked, sorted(ranked, key=lambda c: c["priority_score"], reverse=True))
+        self.assertEqual(len(self.prioritizer.top_k(candidates, k=5)), 5)
+        self.assertEqual(len(self.prioritizer.top_k(candidates[:2])), 2)
+
+    def test_ties_keep_scan_order(self):
+        candidates = [market(name, days=10_000) for name in ("a", "b", "c", "d")]
+        self.assertEqual([c["id"] for c in self.prioritizer.top_k(candidates)], ["a", "b", "c"])
+
+if __name__ == "__main__":
+    unittest.main()
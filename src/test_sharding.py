@@ -0,0 +1,142 @@
+import os
+import time
+import tempfile
+import threading
+import unittest
+from src.sharding import ConsistentHashRing, SQLiteCoordinator, ShardWorker, RiskService
+
+KEYS = [f"kalshi:MKT-{i}" for i in range(4000)]
+
+class TestConsistentHashRing(unittest.TestCase):
+    def test_empty_ring_has_no_owner(self):
+        self.assertIsNone(ConsistentHashRing().owner("kalshi:A"))
+
+    def test_join_moves_only_the_new_workers_share(self):
+        before = ConsistentHashRing(["w1", "w2", "w3"])
+        after = ConsistentHashRing(["w1", "w2", "w3", "w4"])
+        moved = [k for k in KEYS if before.owner(k) != after.owner(k)]
+        # Every moved key went to the newcomer; nothing shuffles between the old workers
+        self.assertTrue(all(after.owner(k) == "w4" for k in moved))
+        self.assertAlmostEqual(len(moved) / len(KEYS), 0.25, delta=0.05)
+
+    def test_leave_hands_only_the_leavers_keys_to_survivors(self):
+        before = ConsistentHashRing(["w1", "w2", "w3"])
+        after = ConsistentHashRing(["w1", "w3"])
+        for k in KEYS:
+            if before.owner(k) != "w2":
+                self.assertEqual(after.owner(k), before.owner(k))
+            else:
+                self.assertIn(after.owner(k), ("w1", "w3"))
+
+class TestCoordinator(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.db = os.path.join(self.tmp.name, "coord.db")
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def test_lease_claim_renew_and_expiry(self):
+        coordinator = SQLiteCoordinator(self.db, lease_ttl=0.2)
+        coordinator.heartbeat("w1")
+        coordinator.heartbeat("w2")
+        self.assertEqual(coordinator.live_workers(), ("w1", "w2"))
+        time.sleep(0.12)
+        coordinator.heartbeat("w1")
+        time.sleep(0.12)
+        # w2 never renewed: it drops out on its own
+        self.assertEqual(coordinator.live_workers(), ("w1",))
+        coordinator.release("w1")
+        self.assertEqual(coordinator.live_workers(), ())
+
+    def test_workers_rebalance_on_join_and_leave(self):
+        coordinator = SQLiteCoordinator(self.db, lease_ttl=30.0)
+        w1, w2 = ShardWorker("w1", coordinator), ShardWorker("w2", coordinator)
+        self.assertEqual(w1.refresh(), ("w1",))
+        self.assertTrue(all(w1.owns_key(k) for k in KEYS[:100]))
+        w2.refresh()
+        self.assertEqual(w1.refresh(), ("w1", "w2"))
+        # Every key has exactly one owner, and both workers agree on it
+        self.assertTrue(all(w1.owns_key(k) != w2.owns_key(k) for k in KEYS))
+        owned = sum(w1.owns_key(k) for k in KEYS)
+        self.assertAlmostEqual(owned / len(KEYS), 0.5, delta=0.1)
+        w2.leave()
+        self.assertEqual(w1.refresh(), ("w1",))
+        self.assertTrue(all(w1.owns_key(k) for k in KEYS[:100]))
+
+class TestRiskService(unittest.TestCase):
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.db = os.path.join(self.tmp.name, "coord.db")
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def test_reservation_race_takes_the_last_slot_once(self):
+        RiskService(self.db, worker_id="w0").sync_positions(14)
+        services = [RiskService(self.db, worker_id=f"w{i}") for i in range(1, 9)]
+        barrier, results = threading.Barrier(len(services)), []
+
+        def reserve(service):
+            barrier.wait()
+            results.append(service.reserve(0.70, 0.50)[0])
+
+        threads = [threading.Thread(target=reserve, args=(s,)) for s in services]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(sorted(results), [False] * 7 + [True])
+        self.assertEqual(services[0].snapshot()["concurrent_positions"], 15)
+
+    def test_workers_share_one_bankroll_and_one_set_of_limits(self):
+        w1 = RiskService(self.db, worker_id="w1", bankroll=1000.0)
+        w2 = RiskService(self.db, worker_id="w2", bankroll=5000.0)   # Seeds nothing: the portfolio exists
+        self.assertEqual(w2.snapshot()["bankroll"], 1000.0)
+        self.assertEqual(w2.reserve(0.70, 0.50), (True, "APPROVED", 50.0))
+        loss, drawdown, bankroll = w2.close_position(-30.0)
+        self.assertEqual((round(loss, 6), round(drawdown, 6), bankroll), (0.03, 0.03, 970.0))
+        # w1's market making marks down $20: both read 5% of the same book
+        self.assertEqual(tuple(round(v, 6) for v in w1.mark_unrealized(-20.0)), (0.05, 0.05, 970.0))
+        snapshot = w2.snapshot()
+        self.assertEqual((round(snapshot["daily_loss_pct"], 6), snapshot["concurrent_positions"]), (0.05, 0))
+
+    def test_restart_takes_the_lost_mark_out_of_todays_pnl(self):
+        w1 = RiskService(self.db, worker_id="w1", bankroll=1000.0)
+        w1.mark_unrealized(-20.0)
+        self.assertAlmostEqual(w1.snapshot()["daily_loss_pct"], 0.02)
+        w1.sync_positions(0)
+        self.assertEqual(w1.snapshot()["daily_loss_pct"], 0.0)
+        # The next mark starts from nothing, not from the cleared -20
+        self.assertAlmostEqual(w1.mark_unrealized(-10.0)[0], 0.01)
+
+    def test_realized_inventory_moves_the_bankroll_not_the_day_twice(self):
+        w1 = RiskService(self.db, worker_id="w1", bankroll=1000.0)
+        w1.mark_unrealized(-20.0)
+        loss, drawdown, bankroll = w1.realize_unrealized(-25.0, 0.0)
+        self.assertEqual(bankroll, 975.0)
+        self.assertAlmostEqual(loss, 0.025)
+        self.assertAlmostEqual(drawdown, 0.025)
+
+    def test_limits_block_reservations_for_every_worker(self):
+        w1 = RiskService(self.db, worker_id="w1", bankroll=1000.0)
+        w2 = RiskService(self.db, worker_id="w2")
+        w1.reserve(0.70, 0.50)
+        w1.close_position(-90.0)
+        allowed, msg, _ = w2.reserve(0.70, 0.50)
+        self.assertFalse(allowed)
+        self.assertIn("drawdown", msg)
+        allowed, msg, _ = w2.reserve(None, None, locked=True)
+        self.assertFalse(allowed)
+
+    def test_restart_resets_only_its_own_slots(self):
+        w1, w2 = RiskService(self.db, worker_id="w1"), RiskService(self.db, worker_id="w2")
+        for service in (w1, w1, w2):
+            service.reserve(0.70, 0.50)
+        w1.release_position()
+        self.assertEqual(w1.snapshot()["concurrent_positions"], 2)
+        w2.sync_positions(0)
+        self.assertEqual(w1.snapshot()["concurrent_positions"], 1)
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,60 @@
+import queue
+import unittest
+from datetime import datetime, timezone
+from src.stages import MarketBus, StagePipeline
+
+class MarketBusTest(unittest.TestCase):
+    def setUp(self):
+        self.bus = MarketBus.create(capacity=4, partitions=2)
+
+    def tearDown(self):
+        self.bus.close(unlink=True)
+
+    def test_polymarket_row_round_trips_with_its_order_fields(self):
+        token = "71321045679252212594626385532706912750332728571942532289631379312455583992563"
+        market = {"id": "512345:1", "platform": "polymarket", "title": "Will it rain? (No)", "price": 38.0,
+                  "spread": 2.0, "volume": 1234.5, "close_date": datetime(2026, 3, 1, tzinfo=timezone.utc),
+                  "anomaly_flag": "wide_spread", "priority_score": 7.5,
+                  "token_id": token, "market_id": "512345", "outcome": "No"}
+        row = self.bus.read(*self.bus.write(1, market))
+        self.assertEqual(row, market)
+
+    def test_kalshi_row_has_no_polymarket_fields(self):
+        market = {"id": "KXRAIN-26MAR01", "platform": "kalshi", "title": "Rain", "price": 40.0, "spread": 1.0,
+                  "volume": 10.0, "close_date": None, "anomaly_flag": None, "priority_score": 1.0}
+        row = self.bus.read(*self.bus.write(0, market))
+        self.assertEqual(row, market)
+        self.assertIsNone(row.get("token_id"))
+
+    def test_recycled_slot_reads_as_stale(self):
+        market = {"id": "A", "platform": "kalshi", "title": "A"}
+        handle = self.bus.write(0, market)
+        self.bus.write(0, dict(market, id="B"))
+        self.bus.write(0, dict(market, id="C"))
+        self.assertIsNone(self.bus.read(*handle))
+        self.assertEqual(self.bus.read(handle[0])["id"], "C")
+
+class NextSignalTest(unittest.TestCase):
+    def setUp(self):
+        self.pipeline = StagePipeline()
+        self.pipeline.bus = MarketBus.create(capacity=2, partitions=1)
+        self.pipeline.exec_q = queue.Queue()
+
+    def tearDown(self):
+        self.pipeline.bus.close(unlink=True)
+
+    def test_signals_resolve_to_bus_rows_and_skip_recycled_ones(self):
+        bus, q = self.pipeline.bus, self.pipeline.exec_q
+        market = {"id": "512345:0", "platform": "polymarket", "title": "Rain", "token_id": "123", "market_id": "512345"}
+        stale = bus.write(0, market)
+        bus.write(0, market)
+        fresh = bus.write(0, dict(market, token_id="456"))
+        q.put((stale, "brief", {"signal": "TRADE"}))
+        q.put((fresh, "brief", {"signal": "TRADE"}))
+        self.assertIsNone(self.pipeline.next_signal(timeout=0.01))
+        target, brief, prediction = self.pipeline.next_signal(timeout=0.01)
+        self.assertEqual((target["token_id"], brief, prediction), ("456", "brief", {"signal": "TRADE"}))
+        self.assertIsNone(self.pipeline.next_signal(timeout=0.01))
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,86 @@
+import unittest
+from src.strike_ladder import StrikeLadderScanner
+
+def above(ticker, strike, bid, ask, kind="greater"):
+    return {"ticker": ticker, "event_ticker": "EV", "strike_type": kind, "floor_strike": strike,
+            "yes_bid": bid, "yes_ask": ask}
+
+def between(ticker, lo, hi, bid, ask):
+    return {"ticker": ticker, "event_ticker": "EV", "strike_type": "between", "floor_strike": lo, "cap_strike": hi,
+            "yes_bid": bid, "yes_ask": ask}
+
+def settle(markets, trade, s):
+    """Cents paid by one set of the trade's legs if the underlying settles at s."""
+    by_ticker = {m["ticker"]: m for m in markets}
+    paid = 0
+    for leg in trade["legs"]:
+        m = by_ticker[leg["ticker"]]
+        if m["strike_type"] == "between":
+            yes = m["floor_strike"] <= s <= m["cap_strike"]
+        elif m["strike_type"] == "greater_or_equal":
+            yes = s >= m["floor_strike"]
+        else:
+            yes = s > m["floor_strike"]
+        paid += 100 * (yes if leg["side"] == "yes" else not yes)
+    return paid
+
+class StrikeLadderTest(unittest.TestCase):
+    """Every trade the scanner emits must pay at least its stated payout wherever the underlying settles."""
+    SETTLE = [70, 73.99, 74, 74.005, 75, 75.99, 75.995, 76, 76.01, 80]
+
+    def scan(self, markets):
+        scanner = StrikeLadderScanner(fee_rate=0.0, min_edge_cents=0.5)
+        scanner.load_markets(markets)
+        return scanner.check()
+
+    def assert_locked(self, markets, trade):
+        for s in self.SETTLE:
+            self.assertGreaterEqual(settle(markets, trade, s), trade["payout_cents"], f"settles at {s}")
+        self.assertGreater(trade["payout_cents"], trade["cost_cents"])
+
+    def test_monotonic(self):
+        # The 76 strike bids 60 while the 74 strike is offered at 50
+        markets = [above("T74", 74, 48, 50), above("T76", 76, 60, 62)]
+        trades = self.scan(markets)
+        self.assertEqual([t["type"] for t in trades], ["monotonic"])
+        self.assertEqual([(l["ticker"], l["side"]) for l in trades[0]["legs"]], [("T74", "yes"), ("T76", "no")])
+        self.assert_locked(markets, trades[0])
+
+    def test_monotonic_equal_strikes_orders_inclusive_first(self):
+        # ">= 74" pays in every state "> 74" does; a "> 74" bid above the ">= 74" ask is the violation
+        markets = [above("G74", 74, 60, 62), above("E74", 74, 48, 50, kind="greater_or_equal")]
+        trades = self.scan(markets)
+        self.assertEqual([(l["ticker"], l["side"]) for l in trades[0]["legs"]], [("E74", "yes"), ("G74", "no")])
+        self.assert_locked(markets, trades[0])
+
+    def test_cheap_butterfly_with_strict_lower_strike(self):
+        # Range offered at 10 while above(74) - above(75.99) is 30: buying it is safe even at S == 74
+        markets = [above("T74", 74, 60, 61), above("T7599", 75.99, 30, 31), between("B74", 74, 75.99, 9, 10)]
+        trades = [t for t in self.scan(markets) if t["type"] == "butterfly"]
+        self.assertEqual(len(trades), 1)
+        self.assertEqual(trades[0]["payout_cents"], 100)
+        self.assertEqual(settle(markets, trades[0], 74), 200)
+        self.assert_locked(markets, trades[0])
+
+    def test_rich_butterfly_needs_inclusive_lower_strike(self):
+        # Range bid at 50 against a 30c synthetic spread. With a strict "greater 74" the short range
+        # loses at S == 74 (range pays, above(74) doesn't), so no trade
+        strict = [above("T74", 74, 59, 60), above("T7599", 75.99, 30, 31), between("B74", 74, 75.99, 50, 51)]
+        self.assertEqual([t for t in self.scan(strict) if t["type"] == "butterfly"], [])
+
+        inclusive = [above("T74", 74, 59, 60, kind="greater_or_equal"), above("T7599", 75.99, 30, 31),
+                     between("B74", 74, 75.99, 50, 51)]
+        trades = [t for t in self.scan(inclusive) if t["type"] == "butterfly"]
+        self.assertEqual(len(trades), 1)
+        self.assertEqual(trades[0]["payout_cents"], 200)
+        self.assertEqual(settle(inclusive, trades[0], 74), 200)
+        self.assert_locked(inclusive, trades[0])
+
+    def test_misaligned_upper_strike_is_not_traded(self):
+        # "greater 76" leaves (75.99, 76] covered by neither the range nor above(K2): the cheap side pays 0 there
+        markets = [above("T74", 74, 60, 61, kind="greater_or_equal"), above("T76", 76, 30, 31),
+                   between("B74", 74, 75.99, 9, 10)]
+        self.assertEqual([t for t in self.scan(markets) if t["type"] == "butterfly"], [])
+
+if __name__ == "__main__":
+    unittest.main()
@@ -2,15 +2,21 @@ import os
 import logging
 from dotenv import load_dotenv
 
+class LazyFileHandler(logging.FileHandler):
+    """File handler that creates logs/ and opens the file on the first record instead of at import."""
+    def __init__(self, filename):
+        super().__init__(filename, delay=True)
+
+    def _open(self):
+        os.makedirs(os.path.dirname(self.baseFilename), exist_ok=True)
+        return super()._open()
+
 def setup_env_and_logging(logger_name="predict_bot"):
     """
     Loads environment variables from .env and configures the centralized logger.
     """
     load_dotenv()
     
-    # Ensure logs dir exists
-    os.makedirs("logs", exist_ok=True)
-    
     logger = logging.getLogger(logger_name)
     logger.setLevel(logging.INFO)
     
@@ -24,7 +30,7 @@ def setup_env_and_logging(logger_name="predict_bot"):
         logger.addHandler(ch)
         
         # File handler
-        fh = logging.FileHandler("logs/bot.log")
+        fh = LazyFileHandler("logs/bot.log")
         fh.setFormatter(formatter)
         logger.addHandler(fh)
         